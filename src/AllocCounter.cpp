@@ -0,0 +1,65 @@
+#include "AllocCounter.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static volatile TaskHandle_t countingTask = nullptr;
+static volatile uint32_t allocationCount = 0;
+
+#ifdef ALLOC_COUNTER
+// Linked with -Wl,--wrap=malloc etc., so every allocation in the firmware passes here
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *pointer, size_t size);
+
+    static inline void countAllocation()
+    {
+        if (countingTask && countingTask == xTaskGetCurrentTaskHandle())
+            allocationCount++;
+    }
+
+    void *__wrap_malloc(size_t size)
+    {
+        countAllocation();
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t count, size_t size)
+    {
+        countAllocation();
+        return __real_calloc(count, size);
+    }
+
+    void *__wrap_realloc(void *pointer, size_t size)
+    {
+        countAllocation();
+        return __real_realloc(pointer, size);
+    }
+}
+#endif
+
+AllocCounter::AllocCounter()
+{
+    allocationCount = 0;
+    countingTask = xTaskGetCurrentTaskHandle();
+}
+
+AllocCounter::~AllocCounter()
+{
+    countingTask = nullptr;
+}
+
+uint32_t AllocCounter::count()
+{
+    return allocationCount;
+}
+
+boolean AllocCounter::enabled()
+{
+#ifdef ALLOC_COUNTER
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,22 @@
+#ifndef ALLOCCOUNTER_H_INCLUDE
+#define ALLOCCOUNTER_H_INCLUDE
+
+#include <Arduino.h>
+
+/*
+AllocCounter counts heap allocations made by the calling task while it
+is alive. It works in the alloc-count build environment, which links
+with malloc, calloc and realloc wrapped; otherwise count() stays 0.
+Only one counter can be active at a time.
+*/
+
+class AllocCounter
+{
+public:
+  AllocCounter();
+  ~AllocCounter();
+  uint32_t count();
+  static boolean enabled();
+};
+
+#endif
@@ -0,0 +1,983 @@
+#include "BenchData.h"
+
+const char benchPlayerJson[] = R"json({
+  "device": {
+    "id": "4bench0000000000000000000000000000000dev",
+    "is_active": true,
+    "is_private_session": false,
+    "is_restricted": false,
+    "name": "Living Room",
+    "type": "Speaker",
+    "volume_percent": 42,
+    "supports_volume": true
+  },
+  "shuffle_state": false,
+  "smart_shuffle": false,
+  "repeat_state": "off",
+  "timestamp": 1700000000000,
+  "context": {
+    "external_urls": {
+      "spotify": "https://open.spotify.com/playlist/37i9bench0000000000000"
+    },
+    "href": "https://api.spotify.com/v1/playlists/37i9bench0000000000000",
+    "type": "playlist",
+    "uri": "spotify:playlist:37i9bench0000000000000"
+  },
+  "progress_ms": 83125,
+  "item": {
+    "album": {
+      "album_type": "album",
+      "artists": [
+        {
+          "external_urls": {
+            "spotify": "https://open.spotify.com/artist/0bench000000000000000000artist"
+          },
+          "href": "https://api.spotify.com/v1/artists/0bench000000000000000000artist",
+          "id": "0bench000000000000000000artist",
+          "name": "Benchmark Ensemble",
+          "type": "artist",
+          "uri": "spotify:artist:0bench000000000000000000artist"
+        }
+      ],
+      "available_markets": [
+        "JP",
+        "US",
+        "GB",
+        "DE",
+        "FR"
+      ],
+      "external_urls": {
+        "spotify": "https://open.spotify.com/album/2bench00000000000album"
+      },
+      "href": "https://api.spotify.com/v1/albums/2bench00000000000album",
+      "id": "2bench00000000000album",
+      "images": [
+        {
+          "height": 640,
+          "url": "https://i.scdn.co/image/ab67616d00000280000000000000000000000640",
+          "width": 640
+        },
+        {
+          "height": 300,
+          "url": "https://i.scdn.co/image/ab67616d0000012c000000000000000000000300",
+          "width": 300
+        },
+        {
+          "height": 64,
+          "url": "https://i.scdn.co/image/ab67616d00000040000000000000000000000064",
+          "width": 64
+        }
+      ],
+      "name": "Reference Workloads",
+      "release_date": "2023-04-01",
+      "release_date_precision": "day",
+      "total_tracks": 12,
+      "type": "album",
+      "uri": "spotify:album:2bench00000000000album"
+    },
+    "artists": [
+      {
+        "external_urls": {
+          "spotify": "https://open.spotify.com/artist/0bench000000000000000000artist"
+        },
+        "href": "https://api.spotify.com/v1/artists/0bench000000000000000000artist",
+        "id": "0bench000000000000000000artist",
+        "name": "Benchmark Ensemble",
+        "type": "artist",
+        "uri": "spotify:artist:0bench000000000000000000artist"
+      },
+      {
+        "external_urls": {
+          "spotify": "https://open.spotify.com/artist/0bench000000000000000001artist"
+        },
+        "href": "https://api.spotify.com/v1/artists/0bench000000000000000001artist",
+        "id": "0bench000000000000000001artist",
+        "name": "The Test Patterns",
+        "type": "artist",
+        "uri": "spotify:artist:0bench000000000000000001artist"
+      }
+    ],
+    "available_markets": [
+      "JP",
+      "US",
+      "GB",
+      "DE",
+      "FR"
+    ],
+    "disc_number": 1,
+    "duration_ms": 215000,
+    "explicit": false,
+    "external_ids": {
+      "isrc": "JPBENCH00001"
+    },
+    "external_urls": {
+      "spotify": "https://open.spotify.com/track/6bench00000000000track"
+    },
+    "href": "https://api.spotify.com/v1/tracks/6bench00000000000track",
+    "id": "6bench00000000000track",
+    "is_local": false,
+    "name": "Steady State (Long Mix) – テスト",
+    "popularity": 57,
+    "preview_url": null,
+    "track_number": 3,
+    "type": "track",
+    "uri": "spotify:track:6bench00000000000track"
+  },
+  "currently_playing_type": "track",
+  "actions": {
+    "disallows": {
+      "resuming": true
+    }
+  },
+  "is_playing": true
+})json";
+
+const char benchPlaylistsJson[] = R"json({
+  "href": "https://api.spotify.com/v1/users/benchuser/playlists?offset=0&limit=50",
+  "limit": 50,
+  "next": null,
+  "offset": 0,
+  "previous": null,
+  "total": 20,
+  "items": [
+    {
+      "collaborative": false,
+      "description": "Playlist number 0 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000000"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000000",
+      "id": "3bench0000000000000000",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000000",
+          "width": null
+        }
+      ],
+      "name": "Morning Focus 0",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0000",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000000/tracks",
+        "total": 10
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000000"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 1 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000001"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000001",
+      "id": "3bench0000000000000001",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000001",
+          "width": null
+        }
+      ],
+      "name": "深夜のドライブ 1",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0001",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000001/tracks",
+        "total": 17
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000001"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 2 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000002"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000002",
+      "id": "3bench0000000000000002",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000002",
+          "width": null
+        }
+      ],
+      "name": "Workout Mix 2",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0002",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000002/tracks",
+        "total": 24
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000002"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 3 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000003"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000003",
+      "id": "3bench0000000000000003",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000003",
+          "width": null
+        }
+      ],
+      "name": "Chill Beats 3",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0003",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000003/tracks",
+        "total": 31
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000003"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 4 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000004"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000004",
+      "id": "3bench0000000000000004",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000004",
+          "width": null
+        }
+      ],
+      "name": "Jazz Standards 4",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0004",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000004/tracks",
+        "total": 38
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000004"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 5 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000005"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000005",
+      "id": "3bench0000000000000005",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000005",
+          "width": null
+        }
+      ],
+      "name": "Morning Focus 5",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0005",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000005/tracks",
+        "total": 45
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000005"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 6 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000006"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000006",
+      "id": "3bench0000000000000006",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000006",
+          "width": null
+        }
+      ],
+      "name": "深夜のドライブ 6",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0006",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000006/tracks",
+        "total": 52
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000006"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 7 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000007"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000007",
+      "id": "3bench0000000000000007",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000007",
+          "width": null
+        }
+      ],
+      "name": "Workout Mix 7",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0007",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000007/tracks",
+        "total": 59
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000007"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 8 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000008"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000008",
+      "id": "3bench0000000000000008",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000008",
+          "width": null
+        }
+      ],
+      "name": "Chill Beats 8",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0008",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000008/tracks",
+        "total": 66
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000008"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 9 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000009"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000009",
+      "id": "3bench0000000000000009",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000009",
+          "width": null
+        }
+      ],
+      "name": "Jazz Standards 9",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0009",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000009/tracks",
+        "total": 73
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000009"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 10 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000010"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000010",
+      "id": "3bench0000000000000010",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000010",
+          "width": null
+        }
+      ],
+      "name": "Morning Focus 10",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0010",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000010/tracks",
+        "total": 80
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000010"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 11 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000011"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000011",
+      "id": "3bench0000000000000011",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000011",
+          "width": null
+        }
+      ],
+      "name": "深夜のドライブ 11",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0011",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000011/tracks",
+        "total": 87
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000011"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 12 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000012"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000012",
+      "id": "3bench0000000000000012",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000012",
+          "width": null
+        }
+      ],
+      "name": "Workout Mix 12",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0012",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000012/tracks",
+        "total": 94
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000012"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 13 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000013"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000013",
+      "id": "3bench0000000000000013",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000013",
+          "width": null
+        }
+      ],
+      "name": "Chill Beats 13",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0013",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000013/tracks",
+        "total": 101
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000013"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 14 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000014"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000014",
+      "id": "3bench0000000000000014",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000014",
+          "width": null
+        }
+      ],
+      "name": "Jazz Standards 14",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0014",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000014/tracks",
+        "total": 108
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000014"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 15 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000015"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000015",
+      "id": "3bench0000000000000015",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000015",
+          "width": null
+        }
+      ],
+      "name": "Morning Focus 15",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0015",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000015/tracks",
+        "total": 115
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000015"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 16 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000016"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000016",
+      "id": "3bench0000000000000016",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000016",
+          "width": null
+        }
+      ],
+      "name": "深夜のドライブ 16",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0016",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000016/tracks",
+        "total": 122
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000016"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 17 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000017"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000017",
+      "id": "3bench0000000000000017",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000017",
+          "width": null
+        }
+      ],
+      "name": "Workout Mix 17",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0017",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000017/tracks",
+        "total": 129
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000017"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 18 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000018"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000018",
+      "id": "3bench0000000000000018",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000018",
+          "width": null
+        }
+      ],
+      "name": "Chill Beats 18",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0018",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000018/tracks",
+        "total": 136
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000018"
+    },
+    {
+      "collaborative": false,
+      "description": "Playlist number 19 for the benchmark",
+      "external_urls": {
+        "spotify": "https://open.spotify.com/playlist/3bench0000000000000019"
+      },
+      "href": "https://api.spotify.com/v1/playlists/3bench0000000000000019",
+      "id": "3bench0000000000000019",
+      "images": [
+        {
+          "height": null,
+          "url": "https://image-cdn-ak.spotifycdn.com/image/ab67706c0000da84bench00000019",
+          "width": null
+        }
+      ],
+      "name": "Jazz Standards 19",
+      "owner": {
+        "display_name": "bench user",
+        "external_urls": {
+          "spotify": "https://open.spotify.com/user/benchuser"
+        },
+        "href": "https://api.spotify.com/v1/users/benchuser",
+        "id": "benchuser",
+        "type": "user",
+        "uri": "spotify:user:benchuser"
+      },
+      "primary_color": null,
+      "public": true,
+      "snapshot_id": "MTIzNDU2Nzg5MGJlbmNo0019",
+      "tracks": {
+        "href": "https://api.spotify.com/v1/playlists/3bench0000000000000019/tracks",
+        "total": 143
+      },
+      "type": "playlist",
+      "uri": "spotify:playlist:3bench0000000000000019"
+    }
+  ]
+})json";
+
+const uint8_t benchJpeg[] = {
+    0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 0x4A, 0x46, 0x49, 0x46, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x01, 0x00, 0x00, 0xFF, 0xDB, 0x00, 0x43, 0x00, 0x06, 0x04, 0x05, 0x06, 0x05, 0x04, 0x06,
+    0x06, 0x05, 0x06, 0x07, 0x07, 0x06, 0x08, 0x0A, 0x10, 0x0A, 0x0A, 0x09, 0x09, 0x0A, 0x14, 0x0E,
+    0x0F, 0x0C, 0x10, 0x17, 0x14, 0x18, 0x18, 0x17, 0x14, 0x16, 0x16, 0x1A, 0x1D, 0x25, 0x1F, 0x1A,
+    0x1B, 0x23, 0x1C, 0x16, 0x16, 0x20, 0x2C, 0x20, 0x23, 0x26, 0x27, 0x29, 0x2A, 0x29, 0x19, 0x1F,
+    0x2D, 0x30, 0x2D, 0x28, 0x30, 0x25, 0x28, 0x29, 0x28, 0xFF, 0xDB, 0x00, 0x43, 0x01, 0x07, 0x07,
+    0x07, 0x0A, 0x08, 0x0A, 0x13, 0x0A, 0x0A, 0x13, 0x28, 0x1A, 0x16, 0x1A, 0x28, 0x28, 0x28, 0x28,
+    0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28,
+    0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28,
+    0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0xFF, 0xC0,
+    0x00, 0x11, 0x08, 0x00, 0x40, 0x00, 0x40, 0x03, 0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11,
+    0x01, 0xFF, 0xC4, 0x00, 0x1F, 0x00, 0x00, 0x01, 0x05, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+    0x0A, 0x0B, 0xFF, 0xC4, 0x00, 0xB5, 0x10, 0x00, 0x02, 0x01, 0x03, 0x03, 0x02, 0x04, 0x03, 0x05,
+    0x05, 0x04, 0x04, 0x00, 0x00, 0x01, 0x7D, 0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21,
+    0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23,
+    0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17,
+    0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A,
+    0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A,
+    0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A,
+    0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99,
+    0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+    0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5,
+    0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1,
+    0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFF, 0xC4, 0x00, 0x1F, 0x01, 0x00, 0x03,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0xFF, 0xC4, 0x00, 0xB5, 0x11, 0x00,
+    0x02, 0x01, 0x02, 0x04, 0x04, 0x03, 0x04, 0x07, 0x05, 0x04, 0x04, 0x00, 0x01, 0x02, 0x77, 0x00,
+    0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13,
+    0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0, 0x15,
+    0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26, 0x27,
+    0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88,
+    0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6,
+    0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4,
+    0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE2,
+    0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9,
+    0xFA, 0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3F, 0x00, 0xF9,
+    0xF2, 0xC7, 0x4F, 0x11, 0x8F, 0x3E, 0xE3, 0xAF, 0x5E, 0x7B, 0x7B, 0xFD, 0x6A, 0xD4, 0x71, 0x4D,
+    0x76, 0xC5, 0x63, 0x05, 0x63, 0xFF, 0x00, 0x3D, 0x6A, 0xE0, 0x81, 0xAE, 0xEE, 0x44, 0x6B, 0xFE,
+    0xAD, 0x4F, 0xF9, 0x35, 0x7D, 0xD4, 0x46, 0x04, 0x36, 0xE3, 0x9E, 0x9C, 0x76, 0xF6, 0xFA, 0xD7,
+    0xDF, 0xD5, 0xC4, 0x51, 0x85, 0x19, 0x42, 0x12, 0x71, 0xA1, 0x17, 0x66, 0xD7, 0xC5, 0x52, 0x5D,
+    0x75, 0xED, 0xFD, 0x7A, 0x72, 0xE1, 0x31, 0x0E, 0xEB, 0xBF, 0xE4, 0x53, 0x8A, 0xCA, 0xDA, 0xDC,
+    0xFE, 0xF0, 0xEF, 0x7C, 0x74, 0x3C, 0xFE, 0x9F, 0xE3, 0x57, 0x22, 0x95, 0x17, 0x02, 0x38, 0xBE,
+    0x5F, 0xCA, 0xAE, 0x5B, 0xE9, 0xC9, 0x1A, 0x79, 0x97, 0x47, 0x24, 0xF6, 0xF7, 0xFE, 0xB5, 0x7A,
+    0x29, 0x23, 0x40, 0x04, 0x50, 0xF1, 0xDF, 0xA0, 0xAE, 0x79, 0xE3, 0x27, 0x84, 0x5A, 0xCE, 0x18,
+    0x64, 0xF6, 0x4A, 0x3C, 0xD3, 0xB7, 0x9F, 0xF5, 0xF9, 0x1F, 0x49, 0x85, 0xC4, 0x29, 0x79, 0x94,
+    0xA1, 0x95, 0x1B, 0x89, 0x22, 0xF9, 0x7F, 0x3A, 0xBB, 0x15, 0x95, 0xB5, 0xC1, 0xFD, 0xD9, 0xD8,
+    0xF8, 0xE8, 0x38, 0xFD, 0x3F, 0xC2, 0xAE, 0x43, 0x24, 0x6E, 0x31, 0x2C, 0x3C, 0x76, 0xE8, 0x6A,
+    0xEA, 0x69, 0xA9, 0x22, 0x09, 0x2D, 0x4E, 0x08, 0xED, 0xEF, 0xFD, 0x2B, 0x8A, 0xA6, 0x32, 0x78,
+    0xB5, 0xA4, 0xE1, 0x89, 0x4B, 0x74, 0xE3, 0xCB, 0x3B, 0x79, 0x7F, 0x5F, 0x99, 0xF4, 0x98, 0x4C,
+    0x42, 0x8F, 0x91, 0x42, 0x08, 0xA6, 0xB4, 0x60, 0xB2, 0x02, 0xD1, 0xFE, 0x63, 0xF0, 0x35, 0xA0,
+    0xFA, 0x78, 0x90, 0x09, 0xED, 0xFA, 0xF5, 0xE3, 0xBF, 0xB8, 0xF7, 0xAB, 0x96, 0x20, 0x48, 0x3C,
+    0x9B, 0x81, 0xCF, 0x4E, 0x7B, 0xFB, 0x1F, 0x7A, 0xB5, 0x6B, 0x03, 0x5A, 0x5C, 0xF9, 0x6D, 0xFE,
+    0xAD, 0x8F, 0xF9, 0x35, 0xE7, 0xCB, 0x11, 0x46, 0x74, 0x63, 0x09, 0xC9, 0xCA, 0x84, 0x9D, 0x93,
+    0x7F, 0x15, 0x39, 0x74, 0xD7, 0xB7, 0xF5, 0xEB, 0xF4, 0xB8, 0x5C, 0x43, 0xBF, 0x9F, 0xE6, 0x70,
+    0x56, 0x96, 0xC6, 0xDE, 0xC4, 0xBE, 0x06, 0xF6, 0xE4, 0x7F, 0x4F, 0xF1, 0xAB, 0x9A, 0x75, 0xA2,
+    0xC7, 0x13, 0x5C, 0x4B, 0xC9, 0x3D, 0x3B, 0x9A, 0xB9, 0x79, 0x6F, 0xB6, 0x38, 0xA3, 0x51, 0xF2,
+    0xFF, 0x00, 0x85, 0x5D, 0xBB, 0xB7, 0x09, 0x0C, 0x51, 0x81, 0xC7, 0xAF, 0xD0, 0x7F, 0xF5, 0xEB,
+    0xD1, 0xC4, 0xD6, 0x58, 0x49, 0xCD, 0xEE, 0xB0, 0xD0, 0x8A, 0x4B, 0xA7, 0x3C, 0xBA, 0xFF, 0x00,
+    0x5F, 0x81, 0xFC, 0xE7, 0x84, 0xC4, 0xF3, 0x25, 0xE6, 0x50, 0xB3, 0xB1, 0x7B, 0xA9, 0x3C, 0xD9,
+    0xBE, 0xE7, 0xF3, 0xF6, 0x1E, 0xD5, 0xB1, 0x65, 0x6A, 0x5F, 0x22, 0xCE, 0xD8, 0xB8, 0x1C, 0x16,
+    0x18, 0x55, 0x3F, 0x89, 0xEA, 0x6A, 0xD4, 0x76, 0x59, 0xFB, 0x3D, 0xB0, 0x3B, 0x43, 0x1C, 0x31,
+    0x1C, 0x64, 0x01, 0xCD, 0x74, 0x6A, 0xA1, 0x54, 0x2A, 0x80, 0x14, 0x0C, 0x00, 0x3B, 0x57, 0xC9,
+    0xE7, 0xDC, 0x43, 0x3C, 0x8A, 0x6B, 0x0D, 0x86, 0x49, 0xD7, 0x6A, 0xF3, 0x9B, 0xD5, 0xDD, 0xF4,
+    0x5F, 0xD7, 0xFC, 0x1F, 0xD0, 0xB8, 0x77, 0x2E, 0xFE, 0xD2, 0x83, 0xAD, 0x39, 0x5A, 0x09, 0xD9,
+    0x5B, 0xA9, 0xCE, 0x9B, 0x7D, 0xA5, 0x56, 0xF2, 0xDC, 0xA6, 0x78, 0x0C, 0x70, 0x40, 0xFC, 0x7B,
+    0x53, 0xCD, 0x8B, 0xDA, 0xC8, 0x25, 0x87, 0xEE, 0x7F, 0x2F, 0x63, 0x5B, 0xE4, 0x02, 0x08, 0x20,
+    0x10, 0x7A, 0x83, 0x45, 0x95, 0xB7, 0x99, 0x14, 0xB0, 0x9E, 0x40, 0xE0, 0x13, 0xCE, 0x01, 0xE9,
+    0x5C, 0xB9, 0x56, 0x7F, 0x3C, 0xF6, 0x4F, 0x0F, 0x89, 0x49, 0x57, 0x4A, 0xF0, 0x9A, 0xD1, 0xDD,
+    0x74, 0x7F, 0xD7, 0xFC, 0x0F, 0x7B, 0x15, 0x84, 0xFE, 0xCF, 0xB4, 0xE0, 0xEF, 0x17, 0xA6, 0xA6,
+    0x7C, 0xD6, 0x8B, 0x24, 0x4B, 0x71, 0x17, 0x04, 0x75, 0xEC, 0x6A, 0xF7, 0xD9, 0xBE, 0xD1, 0x62,
+    0xAF, 0x81, 0xBD, 0x79, 0x3F, 0xD7, 0xFC, 0x6A, 0xE6, 0x93, 0x6E, 0x1E, 0x19, 0x23, 0x23, 0x8F,
+    0x5F, 0xA8, 0xAB, 0xBA, 0x45, 0xBE, 0xE8, 0xA4, 0x46, 0x1F, 0x2F, 0xF8, 0xFF, 0x00, 0xFA, 0xAB,
+    0xD1, 0x8D, 0x65, 0x8B, 0x9C, 0x5E, 0xCB, 0x13, 0x09, 0x26, 0xBA, 0x73, 0xC7, 0xAF, 0xF5, 0xF8,
+    0x9D, 0xB8, 0x5C, 0x4F, 0x2A, 0xF4, 0x3C, 0xFA, 0xF2, 0xDB, 0x74, 0x71, 0x48, 0xBF, 0x77, 0xFC,
+    0x6A, 0xED, 0xDD, 0xB0, 0x78, 0x62, 0x90, 0x74, 0xF4, 0xFA, 0x8F, 0xFE, 0xB5, 0x5D, 0xB4, 0xB6,
+    0x37, 0x16, 0x45, 0x30, 0x37, 0xAF, 0x03, 0xFA, 0x7F, 0x85, 0x5C, 0xD3, 0xA0, 0x59, 0x22, 0x36,
+    0xF2, 0x8C, 0x11, 0xD3, 0xB1, 0xAE, 0xCC, 0x4D, 0x75, 0x8B, 0x9C, 0xD5, 0xEC, 0xB1, 0x30, 0x8B,
+    0x4F, 0xA7, 0x3C, 0x7A, 0x7F, 0x5F, 0x89, 0xFC, 0xE7, 0x84, 0xC4, 0xF2, 0xA5, 0xE4, 0x40, 0x22,
+    0x25, 0x21, 0xB8, 0x45, 0xCE, 0xDE, 0x48, 0x1C, 0xE0, 0x11, 0xCD, 0x5B, 0xA9, 0xAC, 0xD1, 0xED,
+    0x64, 0xF2, 0xA6, 0x1F, 0x27, 0xF2, 0xF7, 0x1E, 0xD5, 0xA3, 0x1E, 0x9B, 0x0C, 0xD9, 0x30, 0xBE,
+    0x33, 0xC9, 0x03, 0x90, 0x3F, 0x0A, 0xF9, 0x8C, 0xEB, 0x2E, 0x79, 0xE4, 0xD6, 0x22, 0x83, 0x4A,
+    0xB2, 0x56, 0x9C, 0x1D, 0x93, 0xBA, 0xEA, 0xBF, 0xAF, 0xF8, 0x1F, 0xA3, 0xF0, 0xCF, 0x12, 0xC7,
+    0x2C, 0x8C, 0xA8, 0xD6, 0x8B, 0x70, 0x6E, 0xE9, 0xAE, 0x9F, 0xD6, 0x9D, 0x4C, 0x9A, 0xD7, 0xD3,
+    0xAD, 0x8C, 0x56, 0xEF, 0x33, 0x8C, 0x13, 0xCF, 0x3D, 0xC7, 0x6A, 0xB7, 0x6F, 0xA5, 0xC1, 0x01,
+    0x0D, 0x2B, 0x64, 0xF5, 0xE7, 0x8C, 0xD5, 0xA2, 0x8F, 0x75, 0x20, 0x8A, 0x11, 0xF2, 0x7F, 0x3F,
+    0x73, 0xED, 0x5C, 0x99, 0x6E, 0x01, 0xE4, 0x92, 0x75, 0xEB, 0xB4, 0xEB, 0x35, 0x68, 0x41, 0x59,
+    0xBB, 0xB5, 0xBB, 0xF2, 0xFE, 0xBD, 0x7D, 0xFC, 0x7E, 0x7F, 0x1C, 0xC5, 0xC6, 0x14, 0x93, 0x50,
+    0x5A, 0xEB, 0xD4, 0xAB, 0xA4, 0xDB, 0x04, 0x86, 0x49, 0x0F, 0x4F, 0x4F, 0xA0, 0xFF, 0x00, 0xEB,
+    0xD5, 0xDD, 0x22, 0xDB, 0x6C, 0x72, 0x48, 0xDF, 0x77, 0xFC, 0x2A, 0xE4, 0xD0, 0x2C, 0x71, 0x2D,
+    0xBC, 0x43, 0x24, 0xF5, 0xEE, 0x6A, 0xEF, 0xD9, 0x8D, 0xBD, 0x8A, 0xA6, 0x06, 0xF6, 0xE0, 0xFF,
+    0x00, 0x5F, 0xF0, 0xAE, 0xD8, 0xD7, 0x58, 0x49, 0xC5, 0x5E, 0xEB, 0x0D, 0x09, 0x36, 0xFA, 0x73,
+    0xCB, 0xA7, 0xF5, 0xF8, 0x1D, 0x18, 0x5C, 0x4F, 0x32, 0xF5, 0x3C, 0xF0, 0x5A, 0xB5, 0xA5, 0xC8,
+    0x91, 0x57, 0xF7, 0x6C, 0x7D, 0x3F, 0x31, 0x5A, 0x0F, 0xA7, 0x89, 0x00, 0x9E, 0xDF, 0xAF, 0x5E,
+    0x3B, 0xFB, 0xFD, 0x6A, 0xE5, 0x8A, 0x89, 0x07, 0x91, 0x70, 0x39, 0xE9, 0xCF, 0x7F, 0x6F, 0xAD,
+    0x5A, 0x8E, 0xCE, 0x6B, 0x47, 0x2D, 0x18, 0x2D, 0x1F, 0xE7, 0xF9, 0xD7, 0x55, 0x5A, 0xD4, 0x67,
+    0x46, 0x53, 0x82, 0x72, 0xA1, 0x27, 0x76, 0x97, 0xC5, 0x4E, 0x5D, 0x74, 0xED, 0xFD, 0x7A, 0xFF,
+    0x00, 0x39, 0xE1, 0x31, 0x2E, 0xEB, 0x5D, 0x7F, 0x32, 0xAD, 0xBE, 0xC9, 0x13, 0xCB, 0xBA, 0x4C,
+    0x11, 0xDF, 0x1D, 0xFF, 0x00, 0xA5, 0x5D, 0x8B, 0x49, 0x8D, 0xC0, 0x31, 0x49, 0xC7, 0x7E, 0x86,
+    0xAE, 0xC5, 0x1D, 0xB5, 0xC1, 0xFD, 0xE2, 0xEC, 0x7C, 0x75, 0x3C, 0x7E, 0xBF, 0xE3, 0x57, 0x22,
+    0xD2, 0x51, 0xB0, 0x63, 0x93, 0xE5, 0xFA, 0x66, 0xB9, 0xA7, 0x29, 0xE2, 0xD6, 0xB1, 0x86, 0x25,
+    0x2D, 0x9A, 0x97, 0x2C, 0xED, 0xE7, 0xFD, 0x7E, 0x67, 0xD2, 0x61, 0x71, 0x4A, 0x3D, 0x6C, 0x53,
+    0x87, 0x49, 0x8D, 0x06, 0x65, 0x93, 0x8E, 0xDD, 0x05, 0x5C, 0x4D, 0x91, 0xA0, 0x8E, 0xD5, 0x32,
+    0x4F, 0x7C, 0x77, 0xFE, 0xB5, 0x76, 0x1D, 0x25, 0x17, 0x99, 0x24, 0xF9, 0x7E, 0x98, 0xAB, 0xB0,
+    0xC7, 0x6D, 0x6E, 0x7F, 0x76, 0xBB, 0xDF, 0x1D, 0x47, 0x3F, 0xAF, 0xF8, 0x57, 0x15, 0x49, 0x4F,
+    0x08, 0xB4, 0x8C, 0x30, 0xC9, 0xEE, 0xDC, 0xB9, 0xA7, 0x6F, 0x2F, 0xEB, 0xF2, 0x3E, 0x93, 0x09,
+    0x8A, 0xE6, 0xEB, 0x72, 0x95, 0x8E, 0x9E, 0x23, 0x1E, 0x75, 0xC7, 0x5E, 0xBC, 0xF6, 0xF7, 0x3E,
+    0xF5, 0x6A, 0xD6, 0xD5, 0xAE, 0xEE, 0x7C, 0xC6, 0x5F, 0xDD, 0xA9, 0xF4, 0xFD, 0x2A, 0xEC, 0x16,
+    0x73, 0x5D, 0xB8, 0x69, 0x01, 0x58, 0xFF, 0x00, 0x2F, 0xC8, 0x55, 0xF7, 0x51, 0x18, 0x10, 0x5B,
+    0x8E, 0x7A, 0x71, 0xDB, 0xDB, 0xEB, 0x5C, 0x12, 0xAD, 0x46, 0x14, 0x63, 0x39, 0xA7, 0x1A, 0x11,
+    0x77, 0x49, 0xFC, 0x55, 0x25, 0xD3, 0x4E, 0xDF, 0xD7, 0xA7, 0xD3, 0x61, 0x71, 0x2E, 0xFB, 0xEB,
+    0xF9, 0x1F, 0xFF, 0xD9,
+};
+
+const size_t benchJpegBytes = sizeof(benchJpeg);
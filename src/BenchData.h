@@ -0,0 +1,19 @@
+#ifndef BENCHDATA_H_INCLUDE
+#define BENCHDATA_H_INCLUDE
+
+#include <Arduino.h>
+
+/*
+Fixed workloads for Benchmark, kept in flash. The JSON documents have the
+shape and formatting of Spotify API responses (/me/player and
+/me/playlists with 20 items) with made-up ids and names. The JPEG is a
+64x64 baseline test pattern at quality 80, about the size of the small
+album art image.
+*/
+
+extern const char benchPlayerJson[];
+extern const char benchPlaylistsJson[];
+extern const uint8_t benchJpeg[];
+extern const size_t benchJpegBytes;
+
+#endif
@@ -0,0 +1,272 @@
+#include <Preferences.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <mbedtls/md.h>
+#include "Benchmark.h"
+#include "BenchData.h"
+#include "MemoryStream.h"
+#include "JsonStreamScanner.h"
+#include "Power.h"
+
+#define benchJpegSize 64
+#define benchBandRows 40
+#define benchHashBytes 4096
+#define benchNvsSpace "bench"
+#define benchNvsBytes 64
+
+Benchmark::Benchmark(Print &out, const char *name) : _out(out)
+{
+    _name = name;
+}
+
+void Benchmark::start()
+{
+    _start = micros();
+}
+
+// End one iteration that processed bytes
+void Benchmark::stop(uint32_t bytes)
+{
+    uint32_t elapsed = micros() - _start;
+    _min = min(_min, elapsed);
+    _max = max(_max, elapsed);
+    _sum += elapsed;
+    _bytes += bytes;
+    _count++;
+}
+
+void Benchmark::print()
+{
+    if (!_count)
+    {
+        _out.printf("bench %s: no samples\n", _name);
+        return;
+    }
+    _out.printf("bench %s: n=%u min=%u avg=%u max=%u us", _name, _count, _min, averageMicros(), _max);
+    if (_bytes && _sum)
+        _out.printf(", %.1f KB/s", _bytes * 1000000.0 / 1024.0 / _sum);
+    _out.println();
+}
+
+// Scan every key of the bundled responses, reading the values SPClient reads
+void Benchmark::jsonScan(Print &out, int iterations)
+{
+    PowerBoost boost;
+    const char *documents[] = {benchPlayerJson, benchPlaylistsJson};
+    const char *names[] = {"json player", "json playlists"};
+    char value[128];
+    for (int document = 0; document < 2; document++)
+    {
+        Benchmark bench(out, names[document]);
+        MemoryStream stream(documents[document]);
+        uint32_t keys = 0;
+        for (int i = 0; i < iterations; i++)
+        {
+            stream.rewind();
+            keys = 0;
+            bench.start();
+            JsonStreamScanner scanner(&stream, false);
+            while (scanner.available())
+            {
+                String path = scanner.scanNextKey();
+                keys++;
+                if (path == "/item/name" || path == "/items/name" || path == "/items/id" || path == "/device/id")
+                    scanner.scanString(value, sizeof(value));
+                else if (path == "/device/volume_percent" || path == "/progress_ms" || path == "/items/tracks/total")
+                    scanner.scanInt();
+            }
+            bench.stop(strlen(documents[document]));
+        }
+        bench.print();
+        out.printf("  %u keys per document\n", keys);
+    }
+}
+
+// Decode the bundled JPEG at full size and scaled to the album art tile, as the play screen does
+void Benchmark::jpegDecode(Print &out, int iterations)
+{
+    PowerBoost boost;
+    LGFX_Sprite sprite;
+    sprite.setColorDepth(16);
+    if (!sprite.createSprite(benchJpegSize, benchJpegSize))
+    {
+        out.println("bench jpeg: no memory for the sprite");
+        return;
+    }
+
+    Benchmark full(out, "jpeg 64x64");
+    Benchmark scaled(out, "jpeg 64x64 to 50x50");
+    for (int i = 0; i < iterations; i++)
+    {
+        full.start();
+        boolean success = sprite.drawJpg(benchJpeg, benchJpegBytes);
+        full.stop(benchJpegBytes);
+        scaled.start();
+        success = sprite.drawJpg(benchJpeg, benchJpegBytes, 0, 0, 50, 50, 0, 0, 0.0f, 0.0f) && success;
+        scaled.stop(benchJpegBytes);
+        if (!success)
+        {
+            out.println("bench jpeg: decode failed");
+            break;
+        }
+    }
+    full.print();
+    scaled.print();
+    sprite.deleteSprite();
+}
+
+// Push whole screens in bands over DMA, like Compositor. The panel must not be in use
+void Benchmark::panelPush(Print &out, LovyanGFX *panel, int iterations)
+{
+    int32_t width = panel->width();
+    int32_t height = panel->height();
+    size_t pixels = width * benchBandRows;
+    uint16_t *band = (uint16_t *)heap_caps_malloc(pixels * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+    if (!band)
+    {
+        out.println("bench push: no memory for the band");
+        return;
+    }
+    for (size_t i = 0; i < pixels; i++)
+        band[i] = (i / width) & 1 ? 0x40FB : 0x0000; // byte-swapped RGB565
+
+    Benchmark bench(out, "push");
+    for (int i = 0; i < iterations; i++)
+    {
+        bench.start();
+        panel->startWrite();
+        for (int32_t y = 0; y < height; y += benchBandRows)
+        {
+            int32_t rows = min((int32_t)benchBandRows, height - y);
+            panel->pushImageDMA(0, y, width, rows, (const lgfx::swap565_t *)band);
+        }
+        panel->waitDMA();
+        panel->endWrite();
+        bench.stop(width * height * sizeof(uint16_t));
+    }
+    bench.print();
+    if (bench.averageMicros())
+        out.printf("  %.1f screens/s\n", 1000000.0f / bench.averageMicros());
+    heap_caps_free(band);
+}
+
+void Benchmark::sha256(Print &out, int iterations)
+{
+    PowerBoost boost;
+    uint8_t *data = (uint8_t *)malloc(benchHashBytes);
+    if (!data)
+    {
+        out.println("bench sha256: no memory for the data");
+        return;
+    }
+    for (int i = 0; i < benchHashBytes; i++)
+        data[i] = i * 31;
+
+    Benchmark bench(out, "sha256");
+    uint8_t hash[32];
+    for (int i = 0; i < iterations; i++)
+    {
+        bench.start();
+        mbedtls_md_context_t ctx;
+        mbedtls_md_init(&ctx);
+        mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+        mbedtls_md_starts(&ctx);
+        mbedtls_md_update(&ctx, data, benchHashBytes);
+        mbedtls_md_finish(&ctx, hash);
+        mbedtls_md_free(&ctx);
+        bench.stop(benchHashBytes);
+    }
+    bench.print();
+    free(data);
+}
+
+// Full TCP connect and TLS handshake to host:443, including the DNS lookup
+void Benchmark::tlsHandshake(Print &out, const char *host, const char *rootCA, int iterations)
+{
+    if (WiFi.status() != WL_CONNECTED)
+    {
+        out.println("bench tls: WiFi is not connected");
+        return;
+    }
+
+    PowerBoost boost;
+    Benchmark bench(out, "tls");
+    WiFiClientSecure client;
+    client.setCACert(rootCA);
+    for (int i = 0; i < iterations; i++)
+    {
+        bench.start();
+        boolean connected = client.connect(host, 443);
+        if (connected)
+            bench.stop();
+        client.stop();
+        if (!connected)
+        {
+            out.printf("bench tls: connecting to %s failed\n", host);
+            break;
+        }
+    }
+    bench.print();
+}
+
+// Commit a small blob to NVS, changing it every time so each write reaches flash
+void Benchmark::nvsWrite(Print &out, int iterations)
+{
+    Preferences preferences;
+    if (!preferences.begin(benchNvsSpace))
+    {
+        out.println("bench nvs: cannot open the namespace");
+        return;
+    }
+
+    uint8_t data[benchNvsBytes];
+    memset(data, 0xA5, sizeof(data));
+    Benchmark bench(out, "nvs");
+    for (int i = 0; i < iterations; i++)
+    {
+        memcpy(data, &i, sizeof(i));
+        bench.start();
+        size_t written = preferences.putBytes("blob", data, sizeof(data));
+        bench.stop(written);
+    }
+    preferences.clear();
+    preferences.end();
+    bench.print();
+}
+
+// Playback state, device list and playlists through SPClient, parse included.
+// Against the replay server the timings depend only on its emulated link
+void Benchmark::spotify(Print &out, SPClient &client, int iterations)
+{
+    if (WiFi.status() != WL_CONNECTED)
+    {
+        out.println("bench spotify: WiFi is not connected");
+        return;
+    }
+
+    PowerBoost boost;
+    out.printf("bench spotify: %s\n", client.apiBase().c_str());
+    Benchmark player(out, "player");
+    Benchmark devices(out, "devices");
+    Benchmark playlists(out, "playlists");
+    for (int i = 0; i < iterations; i++)
+    {
+        player.start();
+        int status = client.getPlaybackState();
+        player.stop();
+        devices.start();
+        int devicesStatus = client.getDeviceList();
+        devices.stop();
+        playlists.start();
+        int playlistsStatus = client.getUserPlaylists();
+        playlists.stop();
+        if (status < 200 || devicesStatus != 200 || playlistsStatus != 200)
+        {
+            out.printf("bench spotify: HTTP %d/%d/%d\n", status, devicesStatus, playlistsStatus);
+            break;
+        }
+    }
+    player.print();
+    devices.print();
+    playlists.print();
+}
@@ -0,0 +1,48 @@
+#ifndef BENCHMARK_H_INCLUDE
+#define BENCHMARK_H_INCLUDE
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include "SPClient.h"
+
+/*
+Benchmark runs fixed workloads on the device, so boards and firmware
+builds can be compared on identical work: JSON scanning of the bundled
+API responses, JPEG decode of the bundled image, band pushes to the
+panel, SHA-256, TLS handshakes and NVS writes. spotify() times the real
+client requests, against recorded responses when the API base points at
+tools/replay.py. Each run prints
+min/avg/max per iteration and a throughput where one applies.
+The CPU runs at the high clock for the whole run.
+*/
+
+class Benchmark
+{
+public:
+  Benchmark(Print &out, const char *name);
+
+  void start();
+  void stop(uint32_t bytes = 0);
+  void print();
+  uint32_t averageMicros() { return _count ? _sum / _count : 0; }
+
+  static void jsonScan(Print &out, int iterations);
+  static void jpegDecode(Print &out, int iterations);
+  static void panelPush(Print &out, LovyanGFX *panel, int iterations);
+  static void sha256(Print &out, int iterations);
+  static void tlsHandshake(Print &out, const char *host, const char *rootCA, int iterations);
+  static void nvsWrite(Print &out, int iterations);
+  static void spotify(Print &out, SPClient &client, int iterations);
+
+private:
+  Print &_out;
+  const char *_name;
+  uint32_t _start = 0;
+  uint32_t _count = 0;
+  uint32_t _min = UINT32_MAX;
+  uint32_t _max = 0;
+  uint64_t _sum = 0;
+  uint64_t _bytes = 0;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "ChunkedStream.h"
+#include "Trace.h"
+
+// Reads wait as long as on stream itself (HTTPClient's TCP timeout), not Stream's default
+void ChunkedStream::begin(Stream *stream)
+{
+    _stream = stream;
+    setTimeout(stream->getTimeout());
+    _state = ChunkSize;
+    _remaining = 0;
+    _sizeDigits = true;
+    _lineEmpty = true;
+}
+
+int ChunkedStream::available()
+{
+    if (!skipFraming())
+        return 0;
+    return min((uint32_t)_stream->available(), _remaining);
+}
+
+int ChunkedStream::read()
+{
+    if (!skipFraming())
+        return -1;
+    int data = _stream->read();
+    if (data >= 0 && --_remaining == 0)
+        _state = ChunkDataEnd;
+    return data;
+}
+
+int ChunkedStream::peek()
+{
+    if (!skipFraming())
+        return -1;
+    return _stream->peek();
+}
+
+size_t ChunkedStream::write(uint8_t data)
+{
+    return 0;
+}
+
+// Consume framing up to the next data byte, as far as it has arrived.
+// Returns true when positioned in chunk data
+boolean ChunkedStream::skipFraming()
+{
+    while (_state != ChunkData)
+    {
+        if (_state == ChunkDone || _stream->available() <= 0)
+            return false;
+        int c = _stream->read();
+        if (c < 0)
+            return false;
+
+        switch (_state)
+        {
+        case ChunkSize:
+            if (c == '\n')
+            {
+                trace_v(traceJson, "chunk %u bytes", _remaining);
+                _state = _remaining ? ChunkData : ChunkTrailer;
+                _sizeDigits = true;
+                _lineEmpty = true;
+            }
+            else if (_sizeDigits && isHexadecimalDigit(c))
+            {
+                _remaining = _remaining * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+            }
+            else
+            {
+                _sizeDigits = false;  // ";extension" or CR
+            }
+            break;
+
+        case ChunkDataEnd:
+            if (c == '\n')
+                _state = ChunkSize;
+            break;
+
+        case ChunkTrailer:
+            if (c == '\n')
+            {
+                if (_lineEmpty)
+                    _state = ChunkDone;
+                _lineEmpty = true;
+            }
+            else if (c != '\r')
+            {
+                _lineEmpty = false;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef CHUNKEDSTREAM_H_INCLUDE
+#define CHUNKEDSTREAM_H_INCLUDE
+
+#include <Arduino.h>
+
+/*
+ChunkedStream reads the body of a response sent with
+Transfer-Encoding: chunked and drops the chunk framing, so readers see
+the payload only, whatever the chunk sizes are and wherever the chunk
+boundaries fall. Framing is consumed only as far as it has arrived;
+available() is 0 after the last chunk.
+*/
+
+class ChunkedStream : public Stream
+{
+public:
+  void begin(Stream *stream);
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t data) override;
+
+private:
+  typedef enum
+  {
+    ChunkSize = 0,   // hex digits, then extensions up to the line end
+    ChunkData,
+    ChunkDataEnd,    // CRLF after the data
+    ChunkTrailer,    // header lines after the last chunk, up to an empty line
+    ChunkDone
+  } ChunkState;
+
+  boolean skipFraming();
+
+  Stream *_stream = nullptr;
+  ChunkState _state = ChunkSize;
+  uint32_t _remaining = 0;
+  boolean _sizeDigits = true;
+  boolean _lineEmpty = true;
+};
+
+#endif
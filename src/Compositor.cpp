@@ -0,0 +1,251 @@
+#include "Compositor.h"
+#include "RenderProfiler.h"
+
+boolean Rect::intersects(const Rect &other) const
+{
+    return !intersected(other).isEmpty();
+}
+
+Rect Rect::intersected(const Rect &other) const
+{
+    int32_t left = max(x, other.x);
+    int32_t top = max(y, other.y);
+    int32_t right = min(x + w, other.x + other.w);
+    int32_t bottom = min(y + h, other.y + other.h);
+    if (right <= left || bottom <= top)
+        return Rect();
+    return Rect(left, top, right - left, bottom - top);
+}
+
+Rect Rect::united(const Rect &other) const
+{
+    if (isEmpty())
+        return other;
+    if (other.isEmpty())
+        return *this;
+    int32_t left = min(x, other.x);
+    int32_t top = min(y, other.y);
+    int32_t right = max(x + w, other.x + other.w);
+    int32_t bottom = max(y + h, other.y + other.h);
+    return Rect(left, top, right - left, bottom - top);
+}
+
+Widget::Widget(const Rect &bounds)
+{
+    _bounds = bounds;
+    _dirty = bounds;
+}
+
+// Mark the whole widget for redraw
+void Widget::invalidate()
+{
+    _dirty = _bounds;
+}
+
+// Mark part of the widget for redraw
+void Widget::invalidate(const Rect &rect)
+{
+    _dirty = _dirty.united(rect.intersected(_bounds));
+}
+
+Compositor::Compositor()
+{
+}
+
+// Allocate the band buffers. bandPixels bounds the off-screen memory used per push
+boolean Compositor::begin(LovyanGFX *panel, int32_t width, int32_t height, size_t bandPixels)
+{
+    _panel = panel;
+    _screen = Rect(0, 0, width, height);
+    _bandPixels = max(bandPixels, (size_t)width);
+    for (int i = 0; i < 2; i++)
+    {
+        // DMA cannot read PSRAM on this panel bus, so bands live in internal SRAM
+        _buffers[i] = (uint16_t *)heap_caps_malloc(_bandPixels * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+        if (!_buffers[i])
+        {
+            log_e("Compositor: failed to allocate band buffer");
+            return false;
+        }
+    }
+    invalidateAll();
+    return true;
+}
+
+// Widgets are drawn in the order they were added. name labels the widget in profiles
+void Compositor::add(Widget *widget, const char *name)
+{
+    _widgets.push_back(widget);
+    _names.push_back(name);
+}
+
+void Compositor::invalidate(const Rect &rect)
+{
+    addDirty(rect.intersected(_screen));
+}
+
+void Compositor::invalidateAll()
+{
+    _dirtyCount = 0;
+    addDirty(_screen);
+}
+
+boolean Compositor::isDirty()
+{
+    if (_dirtyCount > 0)
+        return true;
+    for (Widget *widget : _widgets)
+    {
+        if (!widget->dirty().isEmpty())
+            return true;
+    }
+    return false;
+}
+
+// Let widgets advance their animations
+void Compositor::tick(uint32_t now)
+{
+    for (Widget *widget : _widgets)
+    {
+        widget->tick(now);
+    }
+}
+
+boolean Compositor::animating()
+{
+    for (Widget *widget : _widgets)
+    {
+        if (widget->animating())
+            return true;
+    }
+    return false;
+}
+
+// Compose and push the dirty area. Returns the number of pixels pushed
+uint32_t Compositor::render()
+{
+    for (Widget *widget : _widgets)
+    {
+        if (!widget->dirty().isEmpty())
+        {
+            addDirty(widget->dirty().intersected(_screen));
+            widget->clearDirty();
+        }
+    }
+
+    uint32_t pixels = 0;
+    _panel->startWrite();
+    for (int i = 0; i < _dirtyCount; i++)
+    {
+        pixels += renderRect(_dirty[i]);
+    }
+    if (_profiler)
+    {
+        uint32_t waitStart = micros();
+        _panel->waitDMA();
+        _profiler->transferWaited(micros() - waitStart, true);
+    }
+    else
+    {
+        _panel->waitDMA();
+    }
+    _panel->endWrite();
+    _dirtyCount = 0;
+    _lastPixels = pixels;
+    return pixels;
+}
+
+// Merge overlapping rectangles; when the list is full, merge where the union grows least
+void Compositor::addDirty(const Rect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    Rect merged = rect;
+    for (int i = 0; i < _dirtyCount;)
+    {
+        if (_dirty[i].intersects(merged))
+        {
+            merged = merged.united(_dirty[i]);
+            _dirty[i] = _dirty[--_dirtyCount];
+            i = 0;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if (_dirtyCount < compositorMaxDirtyRects)
+    {
+        _dirty[_dirtyCount++] = merged;
+        return;
+    }
+
+    int best = 0;
+    int32_t bestGrowth = INT32_MAX;
+    for (int i = 0; i < _dirtyCount; i++)
+    {
+        int32_t growth = _dirty[i].united(merged).area() - _dirty[i].area();
+        if (growth < bestGrowth)
+        {
+            best = i;
+            bestGrowth = growth;
+        }
+    }
+    _dirty[best] = _dirty[best].united(merged);
+}
+
+// Compose rect in horizontal bands that fit in a buffer. While one band is
+// transferred over DMA the next one is composed into the other buffer
+uint32_t Compositor::renderRect(const Rect &rect)
+{
+    int32_t rows = max((int32_t)1, (int32_t)(_bandPixels / rect.w));
+    uint32_t pixels = 0;
+
+    for (int32_t y = rect.y; y < rect.y + rect.h; y += rows)
+    {
+        Rect band(rect.x, y, rect.w, min(rows, rect.y + rect.h - y));
+        uint16_t *buffer = _buffers[_nextBuffer];
+        _nextBuffer ^= 1;
+
+        _scratch.setBuffer(buffer, band.w, band.h);
+        _scratch.fillScreen(_background);
+        if (_profiler)
+        {
+            renderProfiledBand(band, buffer);
+            pixels += band.area();
+            continue;
+        }
+        for (Widget *widget : _widgets)
+        {
+            if (widget->bounds().intersects(band))
+            {
+                widget->draw(&_scratch, band.x, band.y);
+            }
+        }
+        // Sprite buffers hold byte-swapped RGB565, which is the panel's wire format.
+        // pushImageDMA waits for the previous band, which frees the other buffer
+        _panel->pushImageDMA(band.x, band.y, band.w, band.h, (const lgfx::swap565_t *)buffer);
+        pixels += band.area();
+    }
+    return pixels;
+}
+
+// renderRect's band step with each draw and the wait in pushImageDMA timed
+void Compositor::renderProfiledBand(const Rect &band, uint16_t *buffer)
+{
+    _profiler->bandStarted();
+    for (size_t i = 0; i < _widgets.size(); i++)
+    {
+        Rect covered = _widgets[i]->bounds().intersected(band);
+        if (covered.isEmpty())
+            continue;
+        uint32_t drawStart = micros();
+        _widgets[i]->draw(&_scratch, band.x, band.y);
+        _profiler->widgetDrawn(i, micros() - drawStart, covered.area());
+    }
+    uint32_t pushStart = micros();
+    _panel->pushImageDMA(band.x, band.y, band.w, band.h, (const lgfx::swap565_t *)buffer);
+    _profiler->transferWaited(micros() - pushStart, false);
+}
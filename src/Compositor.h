@@ -0,0 +1,102 @@
+#ifndef COMPOSITOR_H_INCLUDE
+#define COMPOSITOR_H_INCLUDE
+
+#include <Arduino.h>
+#include <M5GFX.h>
+
+/*
+Compositor is a retained-mode renderer for a fixed set of widgets.
+Each widget tracks its own dirty rectangle. render() composes only the
+dirty area into small off-screen band buffers and pushes them to the
+panel, so unchanged pixels are never sent again. Two band buffers are
+used so one band is composed while the previous one is sent over DMA.
+*/
+
+struct Rect
+{
+  int32_t x = 0;
+  int32_t y = 0;
+  int32_t w = 0;
+  int32_t h = 0;
+
+  Rect() {}
+  Rect(int32_t x, int32_t y, int32_t w, int32_t h) : x(x), y(y), w(w), h(h) {}
+
+  boolean isEmpty() const { return w <= 0 || h <= 0; }
+  int32_t area() const { return isEmpty() ? 0 : w * h; }
+  boolean intersects(const Rect &other) const;
+  Rect intersected(const Rect &other) const;
+  Rect united(const Rect &other) const;
+};
+
+class Widget
+{
+public:
+  Widget(const Rect &bounds);
+  virtual ~Widget() {}
+
+  // Draw into dst whose top-left corner is at (ox, oy) on the panel
+  virtual void draw(LovyanGFX *dst, int32_t ox, int32_t oy) = 0;
+  // Advance animations to now (ms). Called once per frame before render()
+  virtual void tick(uint32_t now) {}
+  // True while tick() still has work to do. The render task sleeps when no widget animates
+  virtual boolean animating() { return false; }
+
+  void invalidate();
+  void invalidate(const Rect &rect);
+  const Rect &bounds() const { return _bounds; }
+  const Rect &dirty() const { return _dirty; }
+  void clearDirty() { _dirty = Rect(); }
+
+protected:
+  Rect _bounds;
+  Rect _dirty;
+};
+
+#define compositorMaxDirtyRects 8
+
+class RenderProfiler;
+
+class Compositor
+{
+public:
+  Compositor();
+  boolean begin(LovyanGFX *panel, int32_t width, int32_t height, size_t bandPixels);
+  void setBackground(uint16_t color) { _background = color; }
+
+  void add(Widget *widget, const char *name = "widget");
+  int widgetCount() { return _widgets.size(); }
+  const char *widgetName(int index) { return _names[index]; }
+  void invalidate(const Rect &rect);
+  void invalidateAll();
+  boolean isDirty();
+
+  void tick(uint32_t now);
+  boolean animating();
+  uint32_t render();
+  uint32_t lastPixels() { return _lastPixels; }
+  // Time draws and transfers into profiler, nullptr to stop
+  void setProfiler(RenderProfiler *profiler) { _profiler = profiler; }
+
+private:
+  void addDirty(const Rect &rect);
+  uint32_t renderRect(const Rect &rect);
+  void renderProfiledBand(const Rect &band, uint16_t *buffer);
+
+  LovyanGFX *_panel = nullptr;
+  Rect _screen;
+  LGFX_Sprite _scratch;
+  uint16_t *_buffers[2] = {nullptr, nullptr};
+  int _nextBuffer = 0;
+  size_t _bandPixels = 0;
+  uint16_t _background = 0;
+  uint32_t _lastPixels = 0;
+  RenderProfiler *_profiler = nullptr;
+
+  std::vector<Widget *> _widgets;
+  std::vector<const char *> _names;
+  Rect _dirty[compositorMaxDirtyRects];
+  int _dirtyCount = 0;
+};
+
+#endif
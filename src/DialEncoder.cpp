@@ -0,0 +1,140 @@
+#include "DialEncoder.h"
+
+#define dialIdleMicros 200000   // a pause this long starts a new gesture
+#define dialRateSmoothing 0.4f  // weight of the newest interval
+
+// Position change by (previous state << 2 | current state), A in bit 0, B in bit 1.
+// A skipped state counts as two steps, as in the Encoder library M5Dial uses
+static const int8_t dialEncoderSteps[16] = {0, -1, 1, 2, 1, 0, -2, -1, -1, -2, 0, 1, 2, 1, -1, 0};
+
+DialEncoder::DialEncoder(uint8_t pinA, uint8_t pinB) : _head(0), _tail(0)
+{
+    _pinA = pinA;
+    _pinB = pinB;
+}
+
+void DialEncoder::begin(DialEncoderWake wake)
+{
+    _wake = wake;
+    pinMode(_pinA, INPUT_PULLUP);
+    pinMode(_pinB, INPUT_PULLUP);
+    delayMicroseconds(2000);
+    _state = (digitalRead(_pinA) ? 1 : 0) | (digitalRead(_pinB) ? 2 : 0);
+    attachInterruptArg(_pinA, isr, this, CHANGE);
+    attachInterruptArg(_pinB, isr, this, CHANGE);
+}
+
+// Consumer side of the ring. Returns false if it is empty
+boolean DialEncoder::pop(DialEvent &event)
+{
+    uint8_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire))
+        return false;
+    event = _events[tail];
+    _tail.store((tail + 1) & (dialEncoderEvents - 1), std::memory_order_release);
+    return true;
+}
+
+void IRAM_ATTR DialEncoder::isr(void *param)
+{
+    DialEncoder *encoder = (DialEncoder *)param;
+    uint8_t state = (digitalRead(encoder->_pinA) ? 1 : 0) | (digitalRead(encoder->_pinB) ? 2 : 0);
+    int8_t counts = dialEncoderSteps[(encoder->_state << 2) | state];
+    encoder->_state = state;
+    if (counts)
+    {
+        encoder->_position += counts;
+
+        uint8_t head = encoder->_head.load(std::memory_order_relaxed);
+        uint8_t next = (head + 1) & (dialEncoderEvents - 1);
+        if (next == encoder->_tail.load(std::memory_order_acquire))
+        {
+            encoder->_overflowCounts += counts;
+        }
+        else
+        {
+            encoder->_events[head].counts = counts;
+            encoder->_events[head].micros = micros();
+            encoder->_head.store(next, std::memory_order_release);
+        }
+    }
+    if (encoder->_wake)
+        encoder->_wake();
+}
+
+DialMotion::DialMotion(DialEncoder *encoder)
+{
+    _encoder = encoder;
+}
+
+// Use curve from now on. Rotation not taken yet is dropped
+void DialMotion::setCurve(const DialCurve &curve)
+{
+    _curve = curve;
+    DialEvent event;
+    while (_encoder->pop(event))
+        ;
+    _overflowTaken = _encoder->overflowCounts();
+    _rate = 0.0f;
+    _pending = 0.0f;
+    _counts = 0;
+    _lastDirection = 0;
+}
+
+// Steps since the last call, negative for counterclockwise. Never drops a count
+int DialMotion::take()
+{
+    DialEvent event;
+    while (_encoder->pop(event))
+        apply(event.counts, event.micros);
+
+    // Counts that did not fit in the ring, without their timing
+    uint32_t overflow = _encoder->overflowCounts();
+    if (overflow != _overflowTaken)
+    {
+        apply((int32_t)(overflow - _overflowTaken), micros());
+        _overflowTaken = overflow;
+    }
+
+    int steps = (int)_pending;
+    _pending -= steps;
+    return steps;
+}
+
+void DialMotion::apply(int counts, uint32_t micros)
+{
+    int direction = counts > 0 ? 1 : -1;
+    uint32_t interval = micros - _lastMicros;
+    if (direction != _lastDirection || interval > dialIdleMicros)
+    {
+        _rate = 0.0f;
+        // Only the fraction added by the gain is dropped. Whole steps in the
+        // old direction are still owed and net against the new ones
+        if (direction != _lastDirection)
+            _pending = truncf(_pending);
+    }
+    else if (interval > 0)
+    {
+        float rate = (float)abs(counts) / dialCountsPerDetent * 1000000.0f / interval;
+        _rate += (rate - _rate) * dialRateSmoothing;
+    }
+    _lastDirection = direction;
+    _lastMicros = micros;
+
+    // Whole steps follow the encoder position exactly; the gain multiplies them
+    _counts += counts;
+    int steps = _counts / _curve.countsPerStep;
+    _counts -= steps * _curve.countsPerStep;
+    _pending += steps * gain();
+}
+
+// 1 below the slow speed, maxGain above the fast one, quadratic in between
+float DialMotion::gain()
+{
+    if (_curve.maxGain <= 1.0f || _rate <= _curve.slowDetentsPerSecond)
+        return 1.0f;
+    if (_rate >= _curve.fastDetentsPerSecond)
+        return _curve.maxGain;
+    float t = (_rate - _curve.slowDetentsPerSecond) / (_curve.fastDetentsPerSecond - _curve.slowDetentsPerSecond);
+    return 1.0f + (_curve.maxGain - 1.0f) * t * t;
+}
@@ -0,0 +1,89 @@
+#ifndef DIALENCODER_H_INCLUDE
+#define DIALENCODER_H_INCLUDE
+
+#include <Arduino.h>
+#include <atomic>
+
+/*
+DialEncoder counts the rotary encoder in a pin change interrupt, with
+the same quadrature decoding and direction as M5Dial.Encoder. It exists
+so the interrupt can also wake loop() from its idle wait; M5Dial.begin()
+must be called with the encoder disabled so the pins are not shared.
+Every count is also queued as a timestamped event in a lock-free ring
+(the interrupt is the only producer, loop() the only consumer), so
+rotation during a blocking HTTP call is replayed with its real timing.
+If the ring is full, the counts are kept in an overflow total instead.
+
+DialMotion turns those events into steps for one screen: countsPerStep
+counts make one step at slow speed, and faster rotation multiplies the
+steps by up to maxGain, so a flick crosses the whole range.
+*/
+
+#define dialEncoderEvents 64   // power of two
+#define dialCountsPerDetent 4
+
+typedef void (*DialEncoderWake)();
+
+struct DialEvent
+{
+  int8_t counts;
+  uint32_t micros;
+};
+
+class DialEncoder
+{
+public:
+  DialEncoder(uint8_t pinA, uint8_t pinB);
+  void begin(DialEncoderWake wake);
+  long read() { return _position; }
+  void write(long position) { _position = position; }
+
+  boolean pop(DialEvent &event);
+  uint32_t overflowCounts() { return _overflowCounts; }
+
+private:
+  static void isr(void *param);
+
+  uint8_t _pinA;
+  uint8_t _pinB;
+  DialEncoderWake _wake = nullptr;
+  volatile uint8_t _state = 0;
+  volatile long _position = 0;
+
+  DialEvent _events[dialEncoderEvents];
+  std::atomic<uint8_t> _head;
+  std::atomic<uint8_t> _tail;
+  volatile uint32_t _overflowCounts = 0;
+};
+
+struct DialCurve
+{
+  uint8_t countsPerStep;
+  float slowDetentsPerSecond;  // gain 1 at or below
+  float fastDetentsPerSecond;  // maxGain at or above
+  float maxGain;
+};
+
+class DialMotion
+{
+public:
+  DialMotion(DialEncoder *encoder);
+  void setCurve(const DialCurve &curve);
+  int take();
+  float detentsPerSecond() { return _rate; }
+
+private:
+  void apply(int counts, uint32_t micros);
+  float gain();
+
+  DialEncoder *_encoder;
+  DialCurve _curve = {dialCountsPerDetent, 0.0f, 0.0f, 1.0f};
+  uint32_t _overflowTaken = 0;
+  uint32_t _lastMicros = 0;
+  int _lastDirection = 0;
+  float _rate = 0.0f;
+  int _counts = 0;
+  float _pending = 0.0f;
+};
+
+#endif
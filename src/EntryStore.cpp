@@ -0,0 +1,113 @@
+#include "EntryStore.h"
+
+EntryStore::EntryStore(uint8_t idLength, uint8_t textFields)
+{
+    _idLength = idLength;
+    _textFields = textFields;
+}
+
+// Allocate all columns. arenaBytes is the total size of the text fields including terminators
+boolean EntryStore::begin(uint16_t capacity, uint16_t arenaBytes)
+{
+    _ids = (char *)malloc((size_t)capacity * _idLength + 1);
+    _offsets = (uint16_t *)malloc(sizeof(uint16_t) * capacity * _textFields);
+    _values = (int32_t *)malloc(sizeof(int32_t) * capacity);
+    _arena = (char *)malloc(arenaBytes);
+    if (!_ids || !_offsets || !_values || !_arena)
+    {
+        log_e("EntryStore: failed to allocate %d entries", capacity);
+        _capacity = 0;
+        return false;
+    }
+    _capacity = capacity;
+    _arenaBytes = min(arenaBytes, (uint16_t)(entryStoreNoText - 1));
+    reset();
+    return true;
+}
+
+// Append an entry with empty fields
+int EntryStore::add()
+{
+    if (_count >= _capacity)
+    {
+        log_e("EntryStore: full (%d entries)", _capacity);
+        return -1;
+    }
+
+    int index = _count++;
+    for (int field = 0; field < _textFields; field++)
+    {
+        _offsets[index * _textFields + field] = entryStoreNoText;
+    }
+    _values[index] = 0;
+    return index;
+}
+
+// Append an entry. The ID must be exactly idLength alphanumeric characters
+int EntryStore::add(const String &id)
+{
+    if (id.length() != _idLength || _idLength == 0)
+    {
+        log_e("EntryStore: unexpected ID %s", id.c_str());
+        return -1;
+    }
+    for (int i = 0; i < _idLength; i++)
+    {
+        if (!isAlphaNumeric(id[i]))
+        {
+            log_e("EntryStore: unexpected ID %s", id.c_str());
+            return -1;
+        }
+    }
+
+    int index = add();
+    if (index >= 0)
+        memcpy(_ids + index * _idLength, id.c_str(), _idLength);
+    return index;
+}
+
+// Copy text into the arena. Setting a field again leaves the old copy until reset()
+boolean EntryStore::setText(int index, uint8_t field, const String &text)
+{
+    size_t length = text.length() + 1;
+    if (_arenaUsed + length > _arenaBytes)
+    {
+        log_e("EntryStore: arena full (%d bytes)", _arenaBytes);
+        return false;
+    }
+    memcpy(_arena + _arenaUsed, text.c_str(), length);
+    _offsets[index * _textFields + field] = _arenaUsed;
+    _arenaUsed += length;
+    return true;
+}
+
+String EntryStore::id(int index) const
+{
+    char buffer[256];
+    memcpy(buffer, _ids + index * _idLength, _idLength);
+    buffer[_idLength] = 0;
+    return String(buffer);
+}
+
+boolean EntryStore::idEquals(int index, const String &id) const
+{
+    return id.length() == _idLength && memcmp(_ids + index * _idLength, id.c_str(), _idLength) == 0;
+}
+
+// Linear search, -1 if the ID is not in the list
+int EntryStore::find(const String &id) const
+{
+    for (int i = 0; i < _count; i++)
+    {
+        if (idEquals(i, id))
+            return i;
+    }
+    return -1;
+}
+
+// Text of a field, "" if it was not set
+const char *EntryStore::text(int index, uint8_t field) const
+{
+    uint16_t offset = _offsets[index * _textFields + field];
+    return offset == entryStoreNoText ? "" : _arena + offset;
+}
@@ -0,0 +1,53 @@
+#ifndef ENTRYSTORE_H_INCLUDE
+#define ENTRYSTORE_H_INCLUDE
+
+#include <Arduino.h>
+
+/*
+EntryStore keeps a list of API entries as struct of arrays.
+IDs are packed as fixed width blocks, text fields live in one bump
+arena addressed by uint16_t offsets, and each entry has one int value.
+All memory is allocated once in begin(); reset() is O(1), so refreshing
+a list never touches the heap.
+With idLength 0 no IDs are packed; keep variable length IDs in a text field.
+*/
+
+#define entryStoreNoText 0xFFFF
+
+class EntryStore
+{
+public:
+  EntryStore(uint8_t idLength, uint8_t textFields);
+  boolean begin(uint16_t capacity, uint16_t arenaBytes);
+  void reset() { _count = 0; _arenaUsed = 0; }
+
+  int add();
+  int add(const String &id);
+  boolean setText(int index, uint8_t field, const String &text);
+  void setValue(int index, int32_t value) { _values[index] = value; }
+
+  int size() const { return _count; }
+  boolean full() const { return _count >= _capacity; }
+  String id(int index) const;
+  boolean idEquals(int index, const String &id) const;
+  int find(const String &id) const;
+  const char *text(int index, uint8_t field) const;
+  int32_t value(int index) const { return _values[index]; }
+
+  uint16_t arenaUsed() const { return _arenaUsed; }
+
+private:
+  uint8_t _idLength;
+  uint8_t _textFields;
+  uint16_t _capacity = 0;
+  uint16_t _count = 0;
+
+  char *_ids = nullptr;
+  uint16_t *_offsets = nullptr;
+  int32_t *_values = nullptr;
+  char *_arena = nullptr;
+  uint16_t _arenaBytes = 0;
+  uint16_t _arenaUsed = 0;
+};
+
+#endif
@@ -0,0 +1,284 @@
+#include "GlyphCache.h"
+
+#define glyphNone 0xFFFF
+
+GlyphCache::GlyphCache()
+{
+}
+
+// Allocate maxGlyphs slots of maxGlyphBytes each. Glyphs larger than a slot are drawn uncached
+boolean GlyphCache::begin(const lgfx::IFont *font, uint16_t maxGlyphs, uint16_t maxGlyphBytes)
+{
+    _font = font;
+    _lock = xSemaphoreCreateRecursiveMutex();
+    _capacity = constrain(maxGlyphs, (uint16_t)2, (uint16_t)(glyphNone - 1));
+    _slotBytes = maxGlyphBytes;
+
+    _bucketBits = 1;
+    while ((1u << _bucketBits) < (uint32_t)_capacity * 2)
+        _bucketBits++;
+
+    _entries = (Entry *)malloc(sizeof(Entry) * _capacity);
+    _buckets = (uint16_t *)malloc(sizeof(uint16_t) << _bucketBits);
+    _pool = (uint8_t *)heap_caps_malloc((size_t)_capacity * _slotBytes, MALLOC_CAP_SPIRAM);
+    if (!_pool)
+        _pool = (uint8_t *)heap_caps_malloc((size_t)_capacity * _slotBytes, MALLOC_CAP_8BIT);
+    if (!_entries || !_buckets || !_pool)
+    {
+        log_e("GlyphCache: failed to allocate %d glyphs", _capacity);
+        return false;
+    }
+    for (uint32_t i = 0; i < (1u << _bucketBits); i++)
+        _buckets[i] = glyphNone;
+
+    _scratch.setColorDepth(1);
+    _scratch.setFont(font);
+    return true;
+}
+
+// Draw UTF-8 text like LovyanGFX drawString with a transparent background
+int32_t GlyphCache::drawString(LovyanGFX *dst, const String &text, int32_t x, int32_t y, textdatum_t datum, uint16_t color, uint8_t size)
+{
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    int32_t width = textWidth(text, size);
+    int32_t height = fontHeight(size);
+
+    uint8_t horizontal = datum & 3;
+    uint8_t vertical = datum & 12;
+    if (horizontal == 1)
+        x -= width / 2;
+    else if (horizontal == 2)
+        x -= width;
+    if (vertical == 4)
+        y -= height / 2;
+    else if (vertical == 8)
+        y -= height;
+
+    const char *cursor = text.c_str();
+    while (*cursor)
+    {
+        uint16_t codePoint = nextCodePoint(cursor);
+        if (!codePoint)
+            continue;
+
+        int index = lookup(codePoint, size, false);
+        if (index < 0)
+        {
+            // Too large for a slot: let the font renderer draw it
+            dst->setFont(_font);
+            dst->setTextSize(size);
+            dst->setTextColor(color);
+            x += dst->drawChar(codePoint, x, y);
+            continue;
+        }
+
+        Entry &entry = _entries[index];
+        dst->drawBitmap(x, y, bitmap(index), entry.advance, entry.height, color);
+        x += entry.advance;
+    }
+    xSemaphoreGiveRecursive(_lock);
+    return width;
+}
+
+// Width of UTF-8 text in pixels. Rasterizes missing glyphs
+int32_t GlyphCache::textWidth(const String &text, uint8_t size)
+{
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    int32_t width = 0;
+    const char *cursor = text.c_str();
+    while (*cursor)
+    {
+        uint16_t codePoint = nextCodePoint(cursor);
+        if (!codePoint)
+            continue;
+
+        int index = lookup(codePoint, size, true);
+        if (index >= 0)
+        {
+            width += _entries[index].advance;
+        }
+        else
+        {
+            _scratch.setTextSize(size);
+            _scratch.fillScreen(0);
+            width += _scratch.drawChar(codePoint, 0, 0);
+        }
+    }
+    xSemaphoreGiveRecursive(_lock);
+    return width;
+}
+
+int32_t GlyphCache::fontHeight(uint8_t size)
+{
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    _scratch.setTextSize(size);
+    int32_t height = _scratch.fontHeight();
+    xSemaphoreGiveRecursive(_lock);
+    return height;
+}
+
+float GlyphCache::hitRate()
+{
+    uint32_t total = _hits + _misses;
+    return total ? (float)_hits / total : 0.0f;
+}
+
+void GlyphCache::resetStats()
+{
+    _hits = 0;
+    _misses = 0;
+    _evictions = 0;
+}
+
+// Decode one UTF-8 character. Returns 0 for invalid bytes and characters outside the BMP
+uint16_t GlyphCache::nextCodePoint(const char *&text)
+{
+    uint8_t first = (uint8_t)*text++;
+    if (first < 0x80)
+        return first;
+
+    int length;
+    uint32_t codePoint;
+    if ((first & 0xE0) == 0xC0)
+    {
+        length = 1;
+        codePoint = first & 0x1F;
+    }
+    else if ((first & 0xF0) == 0xE0)
+    {
+        length = 2;
+        codePoint = first & 0x0F;
+    }
+    else if ((first & 0xF8) == 0xF0)
+    {
+        length = 3;
+        codePoint = first & 0x07;
+    }
+    else
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < length; i++)
+    {
+        uint8_t next = (uint8_t)*text;
+        if ((next & 0xC0) != 0x80)
+            return 0;
+        codePoint = (codePoint << 6) | (next & 0x3F);
+        text++;
+    }
+    return codePoint <= 0xFFFF ? codePoint : 0;
+}
+
+// Find a glyph, rasterizing it on a miss. Returns -1 if it does not fit in a slot
+int GlyphCache::lookup(uint16_t codePoint, uint8_t size, boolean count)
+{
+    uint32_t key = makeKey(codePoint, size);
+    for (uint16_t index = _buckets[bucketOf(key)]; index != glyphNone; index = _entries[index].bucketNext)
+    {
+        if (_entries[index].key == key)
+        {
+            if (count)
+                _hits++;
+            touch(index);
+            return index;
+        }
+    }
+    if (count)
+        _misses++;
+    return rasterize(codePoint, size);
+}
+
+// Render one glyph into the scratch sprite and copy its 1-bit rows into a slot
+int GlyphCache::rasterize(uint16_t codePoint, uint8_t size)
+{
+    _scratch.setTextSize(size);
+    int32_t height = _scratch.fontHeight();
+    int32_t width = (height * 2 + 7) & ~7;
+    if (_scratch.width() != width || _scratch.height() != height)
+    {
+        _scratch.deleteSprite();
+        if (!_scratch.createSprite(width, height))
+            return -1;
+    }
+
+    _scratch.fillScreen(0);
+    _scratch.setTextColor(1);
+    int32_t advance = _scratch.drawChar(codePoint, 0, 0);
+    int32_t stride = (advance + 7) / 8;
+    if (advance <= 0 || stride * height > _slotBytes)
+        return -1;
+
+    int index;
+    if (_used < _capacity)
+    {
+        index = _used++;
+    }
+    else
+    {
+        // Evict the least recently used glyph
+        index = _lruTail;
+        unlinkBucket(index);
+        _lruTail = _entries[index].lruPrev;
+        _entries[_lruTail].lruNext = glyphNone;
+        _evictions++;
+    }
+
+    // 1-bit sprite rows are MSB first and byte aligned, the layout drawBitmap expects
+    const uint8_t *source = (const uint8_t *)_scratch.getBuffer();
+    uint8_t *target = bitmap(index);
+    for (int32_t row = 0; row < height; row++)
+    {
+        memcpy(target + row * stride, source + row * (width / 8), stride);
+    }
+
+    Entry &entry = _entries[index];
+    entry.key = makeKey(codePoint, size);
+    entry.advance = advance;
+    entry.height = height;
+
+    uint16_t bucket = bucketOf(entry.key);
+    entry.bucketNext = _buckets[bucket];
+    _buckets[bucket] = index;
+
+    entry.lruPrev = glyphNone;
+    entry.lruNext = _lruHead;
+    if (_lruHead != glyphNone)
+        _entries[_lruHead].lruPrev = index;
+    _lruHead = index;
+    if (_lruTail == glyphNone)
+        _lruTail = index;
+    return index;
+}
+
+void GlyphCache::unlinkBucket(int index)
+{
+    uint16_t *link = &_buckets[bucketOf(_entries[index].key)];
+    while (*link != glyphNone)
+    {
+        if (*link == index)
+        {
+            *link = _entries[index].bucketNext;
+            return;
+        }
+        link = &_entries[*link].bucketNext;
+    }
+}
+
+// Move an entry to the front of the LRU list
+void GlyphCache::touch(int index)
+{
+    if (index == _lruHead)
+        return;
+    Entry &entry = _entries[index];
+    _entries[entry.lruPrev].lruNext = entry.lruNext;
+    if (entry.lruNext != glyphNone)
+        _entries[entry.lruNext].lruPrev = entry.lruPrev;
+    else
+        _lruTail = entry.lruPrev;
+
+    entry.lruPrev = glyphNone;
+    entry.lruNext = _lruHead;
+    _entries[_lruHead].lruPrev = index;
+    _lruHead = index;
+}
@@ -0,0 +1,74 @@
+#ifndef GLYPHCACHE_H_INCLUDE
+#define GLYPHCACHE_H_INCLUDE
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/*
+GlyphCache keeps rasterized glyphs of one bitmap font in an LRU pool
+(PSRAM when available), keyed by code point and text size. Glyphs are
+stored as 1-bit masks and blitted in the requested color, so CJK glyphs
+are decoded once instead of on every redraw.
+Calls are serialized with a mutex, so the render task and loop() can share it.
+*/
+
+class GlyphCache
+{
+public:
+  GlyphCache();
+  boolean begin(const lgfx::IFont *font, uint16_t maxGlyphs, uint16_t maxGlyphBytes);
+
+  int32_t drawString(LovyanGFX *dst, const String &text, int32_t x, int32_t y, textdatum_t datum, uint16_t color, uint8_t size = 1);
+  int32_t textWidth(const String &text, uint8_t size = 1);
+  int32_t fontHeight(uint8_t size = 1);
+
+  uint32_t hits() { return _hits; }
+  uint32_t misses() { return _misses; }
+  uint32_t evictions() { return _evictions; }
+  float hitRate();
+  void resetStats();
+
+private:
+  struct Entry
+  {
+    uint32_t key;
+    uint16_t advance;
+    uint16_t height;
+    uint16_t lruPrev;
+    uint16_t lruNext;
+    uint16_t bucketNext;
+  };
+
+  static uint16_t nextCodePoint(const char *&text);
+  static uint32_t makeKey(uint16_t codePoint, uint8_t size) { return ((uint32_t)size << 16) | codePoint; }
+
+  int lookup(uint16_t codePoint, uint8_t size, boolean count);
+  int rasterize(uint16_t codePoint, uint8_t size);
+  void unlinkBucket(int index);
+  void touch(int index);
+  uint8_t *bitmap(int index) { return _pool + (size_t)index * _slotBytes; }
+  uint16_t bucketOf(uint32_t key) { return (key * 2654435761u) >> (32 - _bucketBits); }
+
+  const lgfx::IFont *_font = nullptr;
+  SemaphoreHandle_t _lock = nullptr;
+  LGFX_Sprite _scratch;
+  int32_t _scratchWidth = 0;
+
+  Entry *_entries = nullptr;
+  uint8_t *_pool = nullptr;
+  uint16_t *_buckets = nullptr;
+  uint8_t _bucketBits = 0;
+  uint16_t _capacity = 0;
+  uint16_t _used = 0;
+  uint16_t _slotBytes = 0;
+  uint16_t _lruHead = 0xFFFF;
+  uint16_t _lruTail = 0xFFFF;
+
+  uint32_t _hits = 0;
+  uint32_t _misses = 0;
+  uint32_t _evictions = 0;
+};
+
+#endif
@@ -18,16 +18,15 @@ int numberOfCharInString(String source, char search)
     }
     return count;
 }
-long intFrom16BaseString(String sourceString)
-{
-    return strtol(sourceString.c_str(), NULL, 16);
-}
 
 JsonStreamScanner::JsonStreamScanner(Stream *stream, boolean chunked)
 {
     _stream = stream;
-    _chunked = chunked;
-    _chunkSize = -1;
+    if (chunked)
+    {
+        _chunks.begin(stream);
+        _stream = &_chunks;
+    }
 }
 
 // Scan stream until ", and return path if it is key
@@ -35,31 +34,33 @@ String JsonStreamScanner::scanNextKey()
 {
     while (_stream->available())
     {
-        if (_chunked && _chunkSize < 0)
-        {
-            _chunkSize = intFrom16BaseString(_stream->readStringUntil('\n'));
-                log_e("Chunk: %d", _chunkSize);
-        }
+        String word = readWord();
+        boolean inString = _inString;
+        _inString = !_inString;
 
-        String word = _stream->readStringUntil('\"');
-
-        if (_chunked)
+        if (inString)
         {
-            _chunkSize -= (word.length() + 1);
-            if (_chunkSize <= 0) {
-                long startLocation =  (0 - _chunkSize) + 2;
-                long endLocation = word.indexOf("\r\n", startLocation);
-                String part1 = word.substring(0, startLocation - 1);
-                String chunkSizeString = word.substring(startLocation, endLocation);
-                String part2 = word.substring(endLocation + 2);
-                _chunkSize = intFrom16BaseString(chunkSizeString);
-                log_e("Chunk: %s = %d", chunkSizeString.c_str(), _chunkSize);
-                if (_chunkSize == 0) break;
-                _chunkSize -= (part2.length() + 1);
-                word = part1 + part2;
+            // A key, or a string value nobody scanned
+            if (!_isValue)
+            {
+                if (_push)
+                {
+                    _path += "/" + word;
+                }
+                else
+                {
+                    int lastIndex = _path.lastIndexOf("/");
+                    _path = _path.substring(0, lastIndex);
+                    _path += "/" + word;
+                }
+                _push = false;
+                return _path;
             }
+            _isValue = false;
+            continue;
         }
 
+        // Structure between two strings
         int numberOfClose = numberOfCharInString(word, '}');
         int numberOfOpen = numberOfCharInString(word, '{');
         word.trim();
@@ -82,50 +83,16 @@ String JsonStreamScanner::scanNextKey()
             _push = false;
             _isValue = false;
         }
-
         else if (numberOfClose == -1)
         {
             _push = true;
             _isValue = false;
         }
-
         else if (numberOfClose == 0 && numberOfOpen == 0)
         {
-            if (word.indexOf(":") >= 0)
-            {
-                _push = false;
-                _isValue = (word == ":");
-                continue;
-            }
-            else if (word.indexOf(",") >= 0 || word.indexOf("[") >= 0 || word.indexOf("]") >= 0)
-            {
-                _push = false;
-                _isValue = false;
-                continue;
-            }
-            else
-            {
-                if (!_isValue)
-                {
-                    if (_push)
-                    {
-                        _path += "/" + word;
-                    }
-                    else
-                    {
-                        int lastIndex = _path.lastIndexOf("/");
-                        _path = _path.substring(0, lastIndex);
-                        _path += "/" + word;
-                    }
-                    _push = false;
-                    _isValue = false;
-                    return _path;
-                }
-            }
             _push = false;
-            _isValue = false;
+            _isValue = (word == ":");
         }
-        continue;
     }
     return "";
 }
@@ -133,11 +100,192 @@ String JsonStreamScanner::scanNextKey()
 // Scan string value
 String JsonStreamScanner::scanString()
 {
-    _stream->readStringUntil('\"');
+    String word;
+    if (openValue())
+        readValue(nullptr, 0, &word);
+    return word;
+}
+
+// Scan string value into buffer without allocating. Longer values are
+// truncated at a character boundary
+size_t JsonStreamScanner::scanString(char *buffer, size_t size)
+{
+    buffer[0] = 0;
+    if (!openValue())
+        return 0;
+    return readValue(buffer, size, nullptr);
+}
+
+// Read up to the next quote that is not escaped
+String JsonStreamScanner::readWord()
+{
     String word = _stream->readStringUntil('\"');
+    while (_inString)
+    {
+        int backslashes = 0;
+        while (backslashes < (int)word.length() && word[word.length() - 1 - backslashes] == '\\')
+            backslashes++;
+        if (backslashes % 2 == 0)
+            break;
+        word += '\"';
+        word += _stream->readStringUntil('\"');
+    }
     return word;
 }
 
+// Move past the opening quote of the value after the key. Returns false,
+// leaving the value unread, if it is not a string (null, a number...)
+boolean JsonStreamScanner::openValue()
+{
+    _stream->readStringUntil(':');
+    int c = _stream->peek();
+    while (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+    {
+        _stream->read();
+        c = _stream->peek();
+    }
+    // -1: not arrived yet, expect a string as before
+    if (c >= 0 && c != '\"')
+        return false;
+    _stream->readStringUntil('\"');
+    return true;
+}
+
+// Read a string up to its closing quote, decoding escapes, into text or,
+// without text, into buffer. Returns the length kept
+size_t JsonStreamScanner::readValue(char *buffer, size_t size, String *text)
+{
+    size_t length = 0;
+    boolean full = false;
+    int c;
+    while ((c = next()) >= 0 && c != '\"')
+    {
+        char utf8[4];
+        int count = 1;
+        utf8[0] = c;
+        if (c == '\\')
+        {
+            c = next();
+            if (c < 0)
+                break;
+            switch (c)
+            {
+            case 'b':
+                utf8[0] = '\b';
+                break;
+            case 'f':
+                utf8[0] = '\f';
+                break;
+            case 'n':
+                utf8[0] = '\n';
+                break;
+            case 'r':
+                utf8[0] = '\r';
+                break;
+            case 't':
+                utf8[0] = '\t';
+                break;
+            case 'u':
+            {
+                uint32_t code = readHex4();
+                if (code >= 0xD800 && code < 0xDC00)
+                {
+                    // Surrogate pair
+                    uint32_t low = (next() == '\\' && next() == 'u') ? readHex4() : 0;
+                    code = (low >= 0xDC00 && low < 0xE000) ? 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00) : 0xFFFD;
+                }
+                if (code < 0x80)
+                {
+                    utf8[0] = code;
+                }
+                else if (code < 0x800)
+                {
+                    utf8[0] = 0xC0 | (code >> 6);
+                    utf8[1] = 0x80 | (code & 0x3F);
+                    count = 2;
+                }
+                else if (code < 0x10000)
+                {
+                    utf8[0] = 0xE0 | (code >> 12);
+                    utf8[1] = 0x80 | ((code >> 6) & 0x3F);
+                    utf8[2] = 0x80 | (code & 0x3F);
+                    count = 3;
+                }
+                else
+                {
+                    utf8[0] = 0xF0 | (code >> 18);
+                    utf8[1] = 0x80 | ((code >> 12) & 0x3F);
+                    utf8[2] = 0x80 | ((code >> 6) & 0x3F);
+                    utf8[3] = 0x80 | (code & 0x3F);
+                    count = 4;
+                }
+                break;
+            }
+            default:
+                // \" \\ \/
+                utf8[0] = c;
+                break;
+            }
+        }
+
+        if (text)
+        {
+            for (int i = 0; i < count; i++)
+                *text += utf8[i];
+            length += count;
+        }
+        else if (!full && length + count < size)
+        {
+            memcpy(buffer + length, utf8, count);
+            length += count;
+        }
+        else
+        {
+            full = true;
+        }
+    }
+
+    if (buffer)
+    {
+        // Do not keep the first bytes of a character that did not fit
+        if (full)
+        {
+            size_t end = length;
+            while (end > 0 && (buffer[end - 1] & 0xC0) == 0x80)
+                end--;
+            if (end > 0 && (buffer[end - 1] & 0x80))
+            {
+                uint8_t lead = buffer[end - 1];
+                size_t expected = (lead >= 0xF0) ? 4 : (lead >= 0xE0) ? 3 : 2;
+                if (length - (end - 1) < expected)
+                    length = end - 1;
+            }
+        }
+        buffer[length] = 0;
+    }
+    return length;
+}
+
+// Next byte of the stream, waiting like readStringUntil(). -1 at the end
+int JsonStreamScanner::next()
+{
+    char c;
+    return _stream->readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+}
+
+uint16_t JsonStreamScanner::readHex4()
+{
+    uint16_t value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        int c = next();
+        if (!isHexadecimalDigit(c))
+            return 0xFFFD;
+        value = value * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+    }
+    return value;
+}
+
 // Scan boolean value
 boolean JsonStreamScanner::scanBoolean()
 {
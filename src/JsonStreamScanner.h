@@ -2,17 +2,26 @@
 #define JSONSTREAMSCANNER_H_INCLUDE
 
 #include <Arduino.h>
+#include "ChunkedStream.h"
 
 /*
 JsonStreamScanner is a class to scan JSON data from desinated Stream.
+Chunked bodies are read through a ChunkedStream. Quotes, braces and
+colons inside strings do not count as structure, and scanned strings
+have their escapes (\", \\, \uXXXX...) decoded to UTF-8.
+The scanner keeps a pointer to its own ChunkedStream, so it cannot be
+copied: declare it as JsonStreamScanner scanner(stream, chunked).
 */
 
 class JsonStreamScanner
 {
 public:
   JsonStreamScanner(Stream *stream, boolean chunked);
+  JsonStreamScanner(const JsonStreamScanner &) = delete;
+  JsonStreamScanner &operator=(const JsonStreamScanner &) = delete;
   String scanNextKey();
   String scanString();
+  size_t scanString(char *buffer, size_t size);
   boolean scanBoolean();
   long scanInt();
   float scanFloat();
@@ -21,10 +30,16 @@ public:
   int available();
 
 private:
+  String readWord();
+  boolean openValue();
+  size_t readValue(char *buffer, size_t size, String *text);
+  int next();
+  uint16_t readHex4();
+
   Stream *_stream;
-  boolean _chunked;
-  long _chunkSize;
+  ChunkedStream _chunks;
   String _path = "";
+  boolean _inString = false;
   boolean _push = false;
   boolean _isValue = false;
 };
@@ -0,0 +1,74 @@
+#include <Preferences.h>
+#include "LastScreen.h"
+
+LastScreen::LastScreen(const char *space, const char *key)
+{
+    _space = space;
+    _key = key;
+    memset(&_record, 0, sizeof(_record));
+}
+
+// Read the record. Returns false if there is none or it has another format
+boolean LastScreen::load()
+{
+    Preferences preferences;
+    preferences.begin(_space, true);
+    size_t length = preferences.getBytes(_key, &_record, sizeof(_record));
+    preferences.end();
+    if (length != sizeof(_record) || _record.format != lastScreenFormat)
+    {
+        memset(&_record, 0, sizeof(_record));
+        return false;
+    }
+    _changed = false;
+    return true;
+}
+
+boolean LastScreen::save()
+{
+    if (!_changed)
+        return true;
+    Preferences preferences;
+    preferences.begin(_space);
+    size_t length = preferences.putBytes(_key, &_record, sizeof(_record));
+    preferences.end();
+    _changed = false;
+    return length == sizeof(_record);
+}
+
+// Copy the shown state. The art sprite must be lastScreenArtSize square with 16-bit pixels
+void LastScreen::capture(const PlaybackSnapshot &snapshot, LGFX_Sprite *art)
+{
+    size_t artBytes = min(sizeof(_record.art), (size_t)art->bufferLength());
+    // Texts are compared up to the stored length, so truncated ones still match
+    boolean same = _record.format == lastScreenFormat &&
+                   _record.volume == snapshot.volume &&
+                   _record.supportsVolume == snapshot.supportsVolume &&
+                   _record.isPlaying == snapshot.isPlaying &&
+                   strncmp(_record.trackName, snapshot.trackName, lastScreenTextBytes - 1) == 0 &&
+                   strncmp(_record.artistName, snapshot.artistName, lastScreenTextBytes - 1) == 0 &&
+                   strcmp(_record.imageURL, snapshot.imageURL) == 0 &&
+                   memcmp(_record.art, art->getBuffer(), artBytes) == 0;
+    if (same)
+        return;
+
+    _record.format = lastScreenFormat;
+    _record.volume = snapshot.volume;
+    _record.supportsVolume = snapshot.supportsVolume;
+    _record.isPlaying = snapshot.isPlaying;
+    PlaybackSnapshot::copyText(_record.trackName, sizeof(_record.trackName), snapshot.trackName);
+    PlaybackSnapshot::copyText(_record.artistName, sizeof(_record.artistName), snapshot.artistName);
+    PlaybackSnapshot::copyText(_record.imageURL, sizeof(_record.imageURL), snapshot.imageURL);
+    memcpy(_record.art, art->getBuffer(), artBytes);
+    _changed = true;
+}
+
+void LastScreen::remove()
+{
+    Preferences preferences;
+    preferences.begin(_space);
+    preferences.remove(_key);
+    preferences.end();
+    memset(&_record, 0, sizeof(_record));
+    _changed = false;
+}
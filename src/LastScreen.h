@@ -0,0 +1,48 @@
+#ifndef LASTSCREEN_H_INCLUDE
+#define LASTSCREEN_H_INCLUDE
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include "PlaybackSnapshot.h"
+
+/*
+LastScreen is a compact copy of what the play screen showed, kept in
+NVS so the next boot can draw it before WiFi is up. The art tile is
+stored as raw sprite pixels, so drawing it needs no decode.
+save() only writes when the record changed since the last load or save.
+*/
+
+#define lastScreenFormat 1
+#define lastScreenTextBytes 96
+#define lastScreenArtSize 50
+
+class LastScreen
+{
+public:
+  struct Record
+  {
+    uint8_t format;
+    uint8_t volume;
+    boolean supportsVolume;
+    boolean isPlaying;
+    char trackName[lastScreenTextBytes];
+    char artistName[lastScreenTextBytes];
+    char imageURL[snapshotURLBytes];
+    uint16_t art[lastScreenArtSize * lastScreenArtSize];
+  };
+
+  LastScreen(const char *space, const char *key);
+  boolean load();
+  boolean save();
+  void capture(const PlaybackSnapshot &snapshot, LGFX_Sprite *art);
+  void remove();
+  const Record &record() { return _record; }
+
+private:
+  const char *_space;
+  const char *_key;
+  Record _record;
+  boolean _changed = false;
+};
+
+#endif
@@ -0,0 +1,204 @@
+#include "ListView.h"
+
+#define listHeaderHeight 42
+#define listHighlightHeight 24
+#define listEaseMillis 60.0f  // time constant of the scroll easing
+
+ListView::ListView(const Rect &bounds, GlyphCache *glyphs, uint16_t color, int32_t rowHeight) : Widget(bounds)
+{
+    _glyphs = glyphs;
+    _color = color;
+    _rowHeight = rowHeight;
+}
+
+// Show another source. The list jumps to selectedRow without animation
+void ListView::setSource(ListSource *source, int selectedRow)
+{
+    _source = source;
+    _selected = selectedRow;
+    _position = selectedRow;
+    reload();
+}
+
+// Only the header follows the selection at once; tick() moves the rows
+void ListView::setSelected(int row)
+{
+    if (row == _selected)
+        return;
+    _selected = row;
+    layout();
+}
+
+void ListView::reload()
+{
+    _layoutValid = false;
+    layout();
+}
+
+// Exponential easing toward the selected row. Frame rate independent
+void ListView::tick(uint32_t now)
+{
+    uint32_t elapsed = now - _lastTick;
+    _lastTick = now;
+
+    float distance = _selected - _position;
+    if (distance == 0.0f)
+        return;
+
+    if (fabsf(distance) < 0.01f)
+    {
+        _position = _selected;
+    }
+    else
+    {
+        _position += distance * (1.0f - expf(-(float)elapsed / listEaseMillis));
+    }
+    layout();
+}
+
+// Lay out the rows visible at the current position. Rows still visible keep
+// their labels; only rows that moved, changed highlight, came in or left
+// are invalidated, and the header band when its text changes
+void ListView::layout()
+{
+    boolean full = !_layoutValid;
+    RowLayout *previous = _layouts[_current];
+    int previousCount = full ? 0 : _layoutCounts[_current];
+    int previousFirst = previousCount > 0 ? previous[0].row : 0;
+    _current ^= 1;
+    RowLayout *rows = _layouts[_current];
+    int count = 0;
+
+    if (full)
+        _placeholder = _source ? _source->placeholderText() : String("");
+
+    if (_source && _placeholder.isEmpty())
+    {
+        int32_t centerY = _bounds.y + _bounds.h / 2;
+        int32_t halfRows = _bounds.h / 2 / _rowHeight + 1;
+        int first = max(0, (int)floorf(_position) - halfRows);
+        int last = min(_source->rowCount() - 1, (int)ceilf(_position) + halfRows);
+        for (int row = first; row <= last && count < listMaxRows; row++)
+        {
+            RowLayout &entry = rows[count++];
+            entry.row = row;
+            entry.y = centerY + (int32_t)lroundf((row - _position) * _rowHeight);
+            entry.highlighted = abs(entry.y - centerY) < listHighlightHeight / 2;
+
+            int index = row - previousFirst;
+            if (index >= 0 && index < previousCount)
+            {
+                RowLayout &old = previous[index];
+                entry.label = std::move(old.label);
+                if (old.y != entry.y || old.highlighted != entry.highlighted)
+                {
+                    invalidate(rowRect(old.y));
+                    invalidate(rowRect(entry.y));
+                }
+                old.row = -1;  // still visible
+            }
+            else
+            {
+                entry.label = _source->rowLabel(row);
+                invalidate(rowRect(entry.y));
+            }
+        }
+    }
+    for (int i = 0; i < previousCount; i++)
+    {
+        if (previous[i].row >= 0)
+            invalidate(rowRect(previous[i].y));
+    }
+    _layoutCounts[_current] = count;
+
+    String header = _source && _placeholder.isEmpty() ? _source->headerText(_selected) : String("");
+    if (header != _header)
+    {
+        _header = header;
+        invalidate(Rect(_bounds.x, _bounds.y, _bounds.w, listHeaderHeight));
+    }
+
+    _layoutValid = true;
+    if (full)
+        invalidate();
+}
+
+// Area of a row centred at y, icon included
+Rect ListView::rowRect(int32_t y)
+{
+    int32_t h = max(_rowHeight, _iconSize);
+    return Rect(_bounds.x, y - h / 2, _bounds.w, h);
+}
+
+// Called per band: only draws the layout of this frame
+void ListView::draw(LovyanGFX *dst, int32_t ox, int32_t oy)
+{
+    if (!_source)
+        return;
+
+    int32_t centerX = _bounds.x + _bounds.w / 2;
+    int32_t centerY = _bounds.y + _bounds.h / 2;
+    if (!_placeholder.isEmpty())
+    {
+        _glyphs->drawString(dst, _placeholder, centerX - ox, centerY - oy, middle_center, _color);
+        return;
+    }
+
+    dst->fillRect(_bounds.x - ox, centerY - listHighlightHeight / 2 - oy, _bounds.w, listHighlightHeight, _color);
+
+    const RowLayout *rows = _layouts[_current];
+    for (int i = 0; i < _layoutCounts[_current]; i++)
+    {
+        Rect rect = rowRect(rows[i].y);
+        if (rect.y - oy < dst->height() && rect.y + rect.h > oy)
+            drawRow(dst, rows[i], ox, oy);
+    }
+
+    if (!_header.isEmpty())
+    {
+        dst->fillRect(_bounds.x - ox, _bounds.y - oy, _bounds.w, listHeaderHeight, BLACK);
+        _glyphs->drawString(dst, _header, centerX - ox, centerY - 94 - oy, middle_center, _color);
+    }
+}
+
+void ListView::drawLabelPart(LovyanGFX *dst, const RowLayout &row, int32_t top, int32_t bottom, uint16_t color, int32_t ox, int32_t oy)
+{
+    int32_t centerX = _bounds.x + _bounds.w / 2;
+    dst->setClipRect(_bounds.x - ox, top - oy, _bounds.w, bottom - top);
+    _glyphs->drawString(dst, row.label, centerX - ox, row.y - oy, middle_center, color);
+    dst->clearClipRect();
+}
+
+void ListView::drawRow(LovyanGFX *dst, const RowLayout &row, int32_t ox, int32_t oy)
+{
+    int32_t centerX = _bounds.x + _bounds.w / 2;
+    int32_t centerY = _bounds.y + _bounds.h / 2;
+    int32_t bandTop = centerY - listHighlightHeight / 2;
+    int32_t bandBottom = bandTop + listHighlightHeight;
+    int32_t textTop = row.y - _glyphs->fontHeight() / 2;
+    int32_t textBottom = textTop + _glyphs->fontHeight();
+    if (textBottom <= bandTop || textTop >= bandBottom)
+    {
+        _glyphs->drawString(dst, row.label, centerX - ox, row.y - oy, middle_center, _color);
+    }
+    else if (textTop >= bandTop && textBottom <= bandBottom)
+    {
+        _glyphs->drawString(dst, row.label, centerX - ox, row.y - oy, middle_center, BLACK);
+    }
+    else
+    {
+        // Crossing a band edge while scrolling: the part on the band in black, the rest in _color
+        drawLabelPart(dst, row, _bounds.y, bandTop, _color, ox, oy);
+        drawLabelPart(dst, row, bandTop, bandBottom, BLACK, ox, oy);
+        drawLabelPart(dst, row, bandBottom, _bounds.y + _bounds.h, _color, ox, oy);
+    }
+
+    if (_iconSize > 0)
+    {
+        // Align the icon with the left edge of the round panel
+        int32_t radius = _bounds.w / 2;
+        int32_t dy = min(abs(row.y - centerY), radius);
+        int32_t halfChord = sqrtf(radius * radius - dy * dy);
+        _source->drawRowIcon(dst, row.row, centerX - halfChord + 8 - ox, row.y - _iconSize / 2 - oy);
+    }
+}
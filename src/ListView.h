@@ -0,0 +1,81 @@
+#ifndef LISTVIEW_H_INCLUDE
+#define LISTVIEW_H_INCLUDE
+
+#include "Compositor.h"
+#include "GlyphCache.h"
+
+/*
+ListView is a virtualized list widget: each frame it only visits the rows
+that intersect the panel, so redraw cost is O(visible rows) regardless
+of list length. The selected row sits in a highlight band in the middle
+and the scroll position eases toward it with time-based smoothing.
+Rows come from a ListSource. The visible rows, their labels and the
+header are laid out once per frame in tick(), not per band, and only
+rows that moved or changed highlight are redrawn.
+*/
+
+#define listMaxRows 16  // visible rows laid out per frame
+
+class ListSource
+{
+public:
+  virtual ~ListSource() {}
+  virtual int rowCount() = 0;
+  virtual String rowLabel(int row) = 0;
+  // Optional icon at the left edge of a row. Return false if there is none
+  virtual boolean drawRowIcon(LovyanGFX *dst, int row, int32_t x, int32_t y) { return false; }
+  // Optional text in the header band at the top
+  virtual String headerText(int selectedRow) { return ""; }
+  // Optional text shown alone in the middle instead of the rows, e.g. for an empty list
+  virtual String placeholderText() { return ""; }
+};
+
+class ListView : public Widget
+{
+public:
+  ListView(const Rect &bounds, GlyphCache *glyphs, uint16_t color, int32_t rowHeight);
+  void draw(LovyanGFX *dst, int32_t ox, int32_t oy) override;
+  void tick(uint32_t now) override;
+  boolean animating() override { return _position != _selected; }
+
+  void setSource(ListSource *source, int selectedRow);
+  void setSelected(int row);
+  int selected() { return _selected; }
+  void setIconSize(int32_t iconSize) { _iconSize = iconSize; }
+  // The rows of the source or their icons changed
+  void reload();
+
+private:
+  struct RowLayout
+  {
+    int row;
+    int32_t y;
+    boolean highlighted;
+    String label;
+  };
+
+  void layout();
+  Rect rowRect(int32_t y);
+  void drawRow(LovyanGFX *dst, const RowLayout &row, int32_t ox, int32_t oy);
+  void drawLabelPart(LovyanGFX *dst, const RowLayout &row, int32_t top, int32_t bottom, uint16_t color, int32_t ox, int32_t oy);
+
+  GlyphCache *_glyphs;
+  ListSource *_source = nullptr;
+  uint16_t _color;
+  int32_t _rowHeight;
+  int32_t _iconSize = 0;
+
+  int _selected = 0;
+  float _position = 0.0f;
+  uint32_t _lastTick = 0;
+
+  // Layout of the current frame. The other buffer holds the previous one
+  RowLayout _layouts[2][listMaxRows];
+  int _layoutCounts[2] = {0, 0};
+  int _current = 0;
+  boolean _layoutValid = false;
+  String _header;
+  String _placeholder;
+};
+
+#endif
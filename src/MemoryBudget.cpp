@@ -0,0 +1,405 @@
+#include "MemoryBudget.h"
+
+#if defined(MEMORY_BUDGET) && defined(ALLOC_COUNTER)
+#error "MEMORY_BUDGET and ALLOC_COUNTER both wrap malloc; build one at a time"
+#endif
+
+MemoryBudget memoryBudget;
+
+static const char *const memorySubsystemNames[MemorySubsystemCount] = {"untagged", "parser", "client", "images", "ui", "web"};
+
+// Shared with the allocator wrappers, which may run on any task
+static portMUX_TYPE memoryMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t memoryCurrent[MemorySubsystemCount];
+static volatile uint32_t memoryPeak[MemorySubsystemCount];
+static volatile uint32_t memoryBudgets[MemorySubsystemCount];
+static volatile uint32_t memoryOverruns[MemorySubsystemCount];
+static volatile uint32_t memoryFailures[MemorySubsystemCount];
+static volatile uint32_t memoryUntracked = 0;
+
+struct TaskTag
+{
+    TaskHandle_t task;
+    volatile uint8_t tag;
+};
+
+static TaskTag memoryTaskTags[memoryMaxTasks];
+static volatile int memoryTaskTagCount = 0;
+
+// Must be called with memoryMux held. bytes is negative for a release
+static void chargeLocked(uint8_t tag, int32_t bytes)
+{
+    uint32_t before = memoryCurrent[tag];
+    uint32_t after = (bytes < 0 && (uint32_t)-bytes > before) ? 0 : before + bytes;
+    memoryCurrent[tag] = after;
+    if (after > memoryPeak[tag])
+        memoryPeak[tag] = after;
+    uint32_t budget = memoryBudgets[tag];
+    if (budget && before <= budget && after > budget)
+        memoryOverruns[tag]++;
+}
+
+#ifdef MEMORY_BUDGET
+#define memoryBlockMask (memoryTrackedBlocks - 1)
+
+// Open addressing with linear probing; the size sits above the tag byte
+struct TrackedBlock
+{
+    void *pointer;
+    uint32_t sizeAndTag;
+};
+
+static TrackedBlock memoryBlocks[memoryTrackedBlocks];
+static int memoryBlockCount = 0;
+
+static inline uint32_t blockHome(void *pointer)
+{
+    return (((uint32_t)(uintptr_t)pointer >> 3) * 2654435761u >> 16) & memoryBlockMask;
+}
+
+// Must be called with memoryMux held. Keeps the table at most 3/4 full
+static boolean insertBlock(void *pointer, uint32_t size, uint8_t tag)
+{
+    if (memoryBlockCount >= memoryTrackedBlocks * 3 / 4)
+        return false;
+    uint32_t i = blockHome(pointer);
+    while (memoryBlocks[i].pointer)
+        i = (i + 1) & memoryBlockMask;
+    memoryBlocks[i].pointer = pointer;
+    memoryBlocks[i].sizeAndTag = (size << 8) | tag;
+    memoryBlockCount++;
+    return true;
+}
+
+// Must be called with memoryMux held. Shifts later entries back over the hole
+static boolean removeBlock(void *pointer, uint32_t *sizeAndTag)
+{
+    uint32_t i = blockHome(pointer);
+    while (memoryBlocks[i].pointer != pointer)
+    {
+        if (!memoryBlocks[i].pointer)
+            return false;
+        i = (i + 1) & memoryBlockMask;
+    }
+    *sizeAndTag = memoryBlocks[i].sizeAndTag;
+
+    uint32_t hole = i;
+    for (uint32_t j = (i + 1) & memoryBlockMask; memoryBlocks[j].pointer; j = (j + 1) & memoryBlockMask)
+    {
+        uint32_t home = blockHome(memoryBlocks[j].pointer);
+        if (((j - home) & memoryBlockMask) >= ((j - hole) & memoryBlockMask))
+        {
+            memoryBlocks[hole] = memoryBlocks[j];
+            hole = j;
+        }
+    }
+    memoryBlocks[hole].pointer = nullptr;
+    memoryBlockCount--;
+    return true;
+}
+
+static inline uint8_t currentTag()
+{
+    int count = memoryTaskTagCount;
+    if (!count)
+        return MemoryUntagged;
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < count; i++)
+    {
+        if (memoryTaskTags[i].task == task)
+            return memoryTaskTags[i].tag;
+    }
+    return MemoryUntagged;
+}
+
+static void trackAllocation(void *pointer, size_t size, uint8_t tag)
+{
+    if (!pointer)
+    {
+        if (size)
+            memoryFailures[tag]++;
+        return;
+    }
+    if (tag == MemoryUntagged)
+        return;
+    portENTER_CRITICAL_SAFE(&memoryMux);
+    if (insertBlock(pointer, size, tag))
+        chargeLocked(tag, size);
+    else
+        memoryUntracked++;
+    portEXIT_CRITICAL_SAFE(&memoryMux);
+}
+
+// Returns the tag pointer was charged to, or MemoryUntagged
+static uint8_t untrackAllocation(void *pointer, uint32_t *size)
+{
+    if (!pointer || !memoryBlockCount)
+        return MemoryUntagged;
+    uint32_t sizeAndTag;
+    uint8_t tag = MemoryUntagged;
+    portENTER_CRITICAL_SAFE(&memoryMux);
+    if (removeBlock(pointer, &sizeAndTag))
+    {
+        tag = sizeAndTag & 0xFF;
+        *size = sizeAndTag >> 8;
+        chargeLocked(tag, -(int32_t)*size);
+    }
+    portEXIT_CRITICAL_SAFE(&memoryMux);
+    return tag;
+}
+
+// Linked with -Wl,--wrap=malloc etc., so every allocation in the firmware passes here.
+// The block leaves the table before it is freed, so a reuse of the address cannot be removed by mistake
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *pointer, size_t size);
+    void __real_free(void *pointer);
+
+    void *__wrap_malloc(size_t size)
+    {
+        void *pointer = __real_malloc(size);
+        trackAllocation(pointer, size, currentTag());
+        return pointer;
+    }
+
+    void *__wrap_calloc(size_t count, size_t size)
+    {
+        void *pointer = __real_calloc(count, size);
+        trackAllocation(pointer, count * size, currentTag());
+        return pointer;
+    }
+
+    // A grown block stays with the subsystem that allocated it
+    void *__wrap_realloc(void *pointer, size_t size)
+    {
+        uint32_t oldSize = 0;
+        uint8_t tag = untrackAllocation(pointer, &oldSize);
+        boolean tracked = tag != MemoryUntagged;
+        if (!tracked)
+            tag = currentTag();
+
+        void *resized = __real_realloc(pointer, size);
+        if (!resized && size)
+        {
+            // The old block is still allocated
+            memoryFailures[tag]++;
+            if (tracked)
+                trackAllocation(pointer, oldSize, tag);
+            return nullptr;
+        }
+        if (resized)
+            trackAllocation(resized, size, tag);
+        return resized;
+    }
+
+    void __wrap_free(void *pointer)
+    {
+        uint32_t size;
+        untrackAllocation(pointer, &size);
+        __real_free(pointer);
+    }
+}
+#endif
+
+MemoryBudget::MemoryBudget()
+{
+    memset(_overrunWarned, 0, sizeof(_overrunWarned));
+}
+
+// Bytes a subsystem may hold; 0 for no limit
+void MemoryBudget::setBudget(MemorySubsystem subsystem, uint32_t bytes)
+{
+    memoryBudgets[subsystem] = bytes;
+}
+
+// Largest block that must stay allocatable, e.g. the biggest image download
+void MemoryBudget::setReserve(uint32_t bytes)
+{
+    _reserve = bytes;
+}
+
+// Warn when task's stack has had less than minFreeBytes left
+void MemoryBudget::watchTask(TaskHandle_t task, const char *name, uint32_t minFreeBytes)
+{
+    if (!task || _taskCount >= memoryMaxWatchedTasks)
+        return;
+    WatchedTask &watched = _tasks[_taskCount++];
+    watched.task = task;
+    watched.name = name;
+    watched.minFreeBytes = minFreeBytes;
+    watched.lowest = UINT32_MAX;
+    watched.warned = false;
+}
+
+// Book a buffer that bypasses malloc (heap_caps_malloc). Negative to release
+void MemoryBudget::charge(MemorySubsystem subsystem, int32_t bytes)
+{
+    portENTER_CRITICAL(&memoryMux);
+    chargeLocked(subsystem, bytes);
+    portEXIT_CRITICAL(&memoryMux);
+}
+
+// Check before a large allocation. Warns if it would go over the budget;
+// returns false if no free block is large enough, so malloc would fail
+boolean MemoryBudget::admit(MemorySubsystem subsystem, size_t bytes)
+{
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    uint32_t budget = memoryBudgets[subsystem];
+    if (budget && memoryCurrent[subsystem] + bytes > budget)
+        log_w("Memory: %s would hold %u of %u bytes", subsystemName(subsystem), memoryCurrent[subsystem] + bytes, budget);
+    if (bytes > largest)
+    {
+        log_w("Memory: %s needs %u bytes, largest free block is %u", subsystemName(subsystem), bytes, largest);
+        return false;
+    }
+    return true;
+}
+
+// Record the heap and check budgets, reserve and stacks. Call every few seconds from loop()
+void MemoryBudget::sample()
+{
+    _free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    _largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    _fragmentation = _free ? 100 - (uint32_t)((uint64_t)_largest * 100 / _free) : 0;
+    _history[_historyNext] = {_free, _largest};
+    _historyNext = (_historyNext + 1) % memoryHistory;
+    if (_historyCount < memoryHistory)
+        _historyCount++;
+
+    boolean reserveLost = _reserve && _largest < _reserve;
+    if (reserveLost && !_reserveWarned)
+        log_w("Memory: largest free block %u is below the %u byte reserve (free %u, fragmentation %u%%)", _largest, _reserve, _free, _fragmentation);
+    _reserveWarned = reserveLost;
+
+    for (int subsystem = 0; subsystem < MemorySubsystemCount; subsystem++)
+    {
+        uint32_t budget = memoryBudgets[subsystem];
+        boolean over = budget && memoryCurrent[subsystem] > budget;
+        if (over && !_overrunWarned[subsystem])
+            log_w("Memory: %s holds %u bytes, budget %u", subsystemName(subsystem), memoryCurrent[subsystem], budget);
+        _overrunWarned[subsystem] = over;
+    }
+
+    for (int i = 0; i < _taskCount; i++)
+    {
+        WatchedTask &watched = _tasks[i];
+        uint32_t free = uxTaskGetStackHighWaterMark(watched.task);
+        watched.lowest = min(watched.lowest, free);
+        if (free < watched.minFreeBytes && !watched.warned)
+        {
+            log_w("Memory: %s stack has had only %u bytes left", watched.name, free);
+            watched.warned = true;
+        }
+    }
+}
+
+void MemoryBudget::print(Print &out)
+{
+    uint32_t lowestFree = UINT32_MAX;
+    uint32_t lowestLargest = UINT32_MAX;
+    for (int i = 0; i < _historyCount; i++)
+    {
+        lowestFree = min(lowestFree, _history[i].free);
+        lowestLargest = min(lowestLargest, _history[i].largest);
+    }
+    if (!_historyCount)
+        lowestFree = lowestLargest = 0;
+    out.printf("heap: free=%u largest=%u fragmentation=%u%% | last %d samples: lowest free=%u lowest largest=%u\n",
+               _free, _largest, _fragmentation, _historyCount, lowestFree, lowestLargest);
+
+    if (enabled())
+    {
+        for (int subsystem = 0; subsystem < MemorySubsystemCount; subsystem++)
+        {
+            out.printf("%s: current=%u peak=%u budget=%u overruns=%u failures=%u\n", subsystemName(subsystem),
+                       current(subsystem), peak(subsystem), budget(subsystem), overruns(subsystem), failures(subsystem));
+        }
+        out.printf("untracked blocks=%u\n", untrackedBlocks());
+    }
+
+    for (int i = 0; i < _taskCount; i++)
+        out.printf("stack %s: lowest free=%u\n", _tasks[i].name, _tasks[i].lowest);
+}
+
+uint32_t MemoryBudget::current(int subsystem)
+{
+    return memoryCurrent[subsystem];
+}
+
+uint32_t MemoryBudget::peak(int subsystem)
+{
+    return memoryPeak[subsystem];
+}
+
+uint32_t MemoryBudget::budget(int subsystem)
+{
+    return memoryBudgets[subsystem];
+}
+
+// Allocations that returned nullptr. Only counted in the memory-budget build
+uint32_t MemoryBudget::failures(int subsystem)
+{
+    return memoryFailures[subsystem];
+}
+
+// Times the subsystem went from within its budget to over it
+uint32_t MemoryBudget::overruns(int subsystem)
+{
+    return memoryOverruns[subsystem];
+}
+
+// Tagged allocations not charged because the block table was full
+uint32_t MemoryBudget::untrackedBlocks()
+{
+    return memoryUntracked;
+}
+
+boolean MemoryBudget::enabled()
+{
+#ifdef MEMORY_BUDGET
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *MemoryBudget::subsystemName(int subsystem)
+{
+    return memorySubsystemNames[subsystem];
+}
+
+MemoryScope::MemoryScope(MemorySubsystem subsystem)
+{
+#ifdef MEMORY_BUDGET
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL(&memoryMux);
+    for (int i = 0; i < memoryTaskTagCount; i++)
+    {
+        if (memoryTaskTags[i].task == task)
+            _slot = i;
+    }
+    if (_slot < 0 && memoryTaskTagCount < memoryMaxTasks)
+    {
+        _slot = memoryTaskTagCount;
+        memoryTaskTags[_slot].task = task;
+        memoryTaskTags[_slot].tag = MemoryUntagged;
+        memoryTaskTagCount++;
+    }
+    portEXIT_CRITICAL(&memoryMux);
+
+    // Only this task writes its own tag
+    if (_slot >= 0)
+    {
+        _previous = memoryTaskTags[_slot].tag;
+        memoryTaskTags[_slot].tag = subsystem;
+    }
+#endif
+}
+
+MemoryScope::~MemoryScope()
+{
+    if (_slot >= 0)
+        memoryTaskTags[_slot].tag = _previous;
+}
@@ -0,0 +1,110 @@
+#ifndef MEMORYBUDGET_H_INCLUDE
+#define MEMORYBUDGET_H_INCLUDE
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/*
+MemoryBudget accounts heap use per subsystem. A MemoryScope tags the
+allocations its task makes while the scope lives. The memory-budget build
+environment (MEMORY_BUDGET) links with malloc, calloc, realloc and free
+wrapped and keeps a fixed table of tagged blocks, so a free is charged
+back to the subsystem that made the allocation, whichever task frees it.
+Buffers taken with heap_caps_malloc (sprites, band buffers) bypass the
+wrap; charge() books them by hand.
+sample() works in every build: it records free heap, the largest free
+block and fragmentation, checks the stack watermarks of watched tasks and
+warns when a subsystem went over its budget or the largest block can no
+longer hold the reserve. admit() asks the same before a large allocation.
+*/
+
+typedef enum
+{
+  MemoryUntagged = 0,
+  MemoryParser,
+  MemoryClient,
+  MemoryImages,
+  MemoryUI,
+  MemoryWeb,
+  MemorySubsystemCount
+} MemorySubsystem;
+
+#define memoryHistory 30         // heap samples kept for the trend
+#define memoryMaxTasks 8         // tasks that can open a MemoryScope
+#define memoryMaxWatchedTasks 6
+#define memoryTrackedBlocks 1024 // power of two
+
+class MemoryBudget
+{
+public:
+  MemoryBudget();
+
+  void setBudget(MemorySubsystem subsystem, uint32_t bytes);
+  void setReserve(uint32_t bytes);
+  void watchTask(TaskHandle_t task, const char *name, uint32_t minFreeBytes);
+  void charge(MemorySubsystem subsystem, int32_t bytes);
+  boolean admit(MemorySubsystem subsystem, size_t bytes);
+
+  void sample();
+  void print(Print &out);
+
+  uint32_t current(int subsystem);
+  uint32_t peak(int subsystem);
+  uint32_t budget(int subsystem);
+  uint32_t failures(int subsystem);
+  uint32_t overruns(int subsystem);
+  uint32_t untrackedBlocks();
+  uint32_t freeBytes() { return _free; }
+  uint32_t largestBlock() { return _largest; }
+  // 0 when the free heap is one block, near 100 when it is scattered
+  uint32_t fragmentationPercent() { return _fragmentation; }
+
+  static boolean enabled();
+  static const char *subsystemName(int subsystem);
+
+private:
+  struct HeapSample
+  {
+    uint32_t free;
+    uint32_t largest;
+  };
+
+  struct WatchedTask
+  {
+    TaskHandle_t task;
+    const char *name;
+    uint32_t minFreeBytes;
+    uint32_t lowest;
+    boolean warned;
+  };
+
+  HeapSample _history[memoryHistory];
+  int _historyNext = 0;
+  int _historyCount = 0;
+  uint32_t _free = 0;
+  uint32_t _largest = 0;
+  uint32_t _fragmentation = 0;
+  uint32_t _reserve = 0;
+  boolean _reserveWarned = false;
+
+  WatchedTask _tasks[memoryMaxWatchedTasks];
+  int _taskCount = 0;
+  boolean _overrunWarned[MemorySubsystemCount];
+};
+
+// Tags the calling task's allocations until destroyed. Scopes nest
+class MemoryScope
+{
+public:
+  MemoryScope(MemorySubsystem subsystem);
+  ~MemoryScope();
+
+private:
+  int _slot = -1;
+  uint8_t _previous = MemoryUntagged;
+};
+
+extern MemoryBudget memoryBudget;
+
+#endif
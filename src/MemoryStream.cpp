@@ -0,0 +1,48 @@
+#include "MemoryStream.h"
+
+MemoryStream::MemoryStream(const uint8_t *data, size_t size)
+{
+    _data = data;
+    _size = size;
+    // Data that is not there now never arrives: readStringUntil() must not wait at the end
+    setTimeout(0);
+}
+
+MemoryStream::MemoryStream(const char *text)
+{
+    _data = (const uint8_t *)text;
+    _size = strlen(text);
+    setTimeout(0);
+}
+
+int MemoryStream::available()
+{
+    return _size - _position;
+}
+
+int MemoryStream::read()
+{
+    if (_position >= _size)
+        return -1;
+    return _data[_position++];
+}
+
+int MemoryStream::peek()
+{
+    if (_position >= _size)
+        return -1;
+    return _data[_position];
+}
+
+size_t MemoryStream::readBytes(char *buffer, size_t length)
+{
+    size_t count = min(length, _size - _position);
+    memcpy(buffer, _data + _position, count);
+    _position += count;
+    return count;
+}
+
+size_t MemoryStream::write(uint8_t data)
+{
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef MEMORYSTREAM_H_INCLUDE
+#define MEMORYSTREAM_H_INCLUDE
+
+#include <Arduino.h>
+
+/*
+MemoryStream reads a fixed buffer as a Stream, so code written for a
+network response can run on data in memory. Writes are ignored.
+*/
+
+class MemoryStream : public Stream
+{
+public:
+  MemoryStream(const uint8_t *data, size_t size);
+  MemoryStream(const char *text);
+  void rewind() { _position = 0; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  using Stream::readBytes;
+  size_t readBytes(char *buffer, size_t length) override;
+  size_t write(uint8_t data) override;
+
+private:
+  const uint8_t *_data;
+  size_t _size;
+  size_t _position = 0;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "Metrics.h"
+#include "RequestTrace.h"
+
+// Sends the status line and headers. The body follows in chunks
+MetricsWriter::MetricsWriter(WebServer *server)
+{
+    _server = server;
+    _server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _server->send(200, "text/plain; version=0.0.4", "");
+}
+
+// Writes the same text to out, e.g. the serial console
+MetricsWriter::MetricsWriter(Print *out)
+{
+    _out = out;
+}
+
+// Sends the rest and the final empty chunk
+MetricsWriter::~MetricsWriter()
+{
+    sendBuffer();
+    if (_server)
+        _server->sendContent("", 0);
+}
+
+void MetricsWriter::type(const char *name, const char *type, const char *help)
+{
+    print("# HELP ");
+    print(name);
+    print(' ');
+    print(help);
+    print("\n# TYPE ");
+    print(name);
+    print(' ');
+    print(type);
+    print('\n');
+}
+
+void MetricsWriter::sample(const char *name, const char *labels, uint32_t value)
+{
+    beginSample(name, labels);
+    print(value);
+    print('\n');
+}
+
+void MetricsWriter::sample(const char *name, const char *labels, float value)
+{
+    beginSample(name, labels);
+    print(value, 6);
+    print('\n');
+}
+
+// RequestTrace histograms, in seconds. Endpoint and phase pairs without samples are left out
+void MetricsWriter::requestHistograms()
+{
+    char labels[metricsLabelBytes];
+    type("dialplay_request_duration_seconds", "histogram", "Spotify request time by endpoint and phase");
+    for (int endpoint = 0; endpoint < TraceEndpointCount; endpoint++)
+    {
+        for (int phase = 0; phase < TracePhaseCount; phase++)
+        {
+            uint32_t count = 0;
+            for (int bucket = 0; bucket < traceBuckets; bucket++)
+                count += RequestTrace::bucketCount(endpoint, phase, bucket);
+            if (!count)
+                continue;
+
+            // Prometheus buckets are cumulative
+            uint32_t cumulative = 0;
+            for (int bucket = 0; bucket < traceBuckets; bucket++)
+            {
+                cumulative += RequestTrace::bucketCount(endpoint, phase, bucket);
+                if (bucket == traceBuckets - 1)
+                    snprintf(labels, sizeof(labels), "endpoint=\"%s\",phase=\"%s\",le=\"+Inf\"",
+                             RequestTrace::endpointName(endpoint), RequestTrace::phaseName(phase));
+                else
+                    snprintf(labels, sizeof(labels), "endpoint=\"%s\",phase=\"%s\",le=\"%g\"",
+                             RequestTrace::endpointName(endpoint), RequestTrace::phaseName(phase), RequestTrace::bucketLimit(bucket) / 1000.0);
+                sample("dialplay_request_duration_seconds_bucket", labels, cumulative);
+            }
+            snprintf(labels, sizeof(labels), "endpoint=\"%s\",phase=\"%s\"",
+                     RequestTrace::endpointName(endpoint), RequestTrace::phaseName(phase));
+            sample("dialplay_request_duration_seconds_sum", labels, RequestTrace::sumMillis(endpoint, phase) / 1000.0f);
+            sample("dialplay_request_duration_seconds_count", labels, count);
+        }
+    }
+
+    type("dialplay_request_errors_total", "counter", "Spotify requests that did not return 2xx");
+    for (int endpoint = 0; endpoint < TraceEndpointCount; endpoint++)
+    {
+        snprintf(labels, sizeof(labels), "endpoint=\"%s\"", RequestTrace::endpointName(endpoint));
+        sample("dialplay_request_errors_total", labels, RequestTrace::errors(endpoint));
+    }
+}
+
+size_t MetricsWriter::write(uint8_t data)
+{
+    if (_length == sizeof(_buffer))
+        sendBuffer();
+    _buffer[_length++] = data;
+    return 1;
+}
+
+size_t MetricsWriter::write(const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        write(data[i]);
+    return size;
+}
+
+boolean MetricsWriter::enabled()
+{
+#ifdef METRICS_ENDPOINT
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MetricsWriter::beginSample(const char *name, const char *labels)
+{
+    print(name);
+    if (labels)
+    {
+        print('{');
+        print(labels);
+        print('}');
+    }
+    print(' ');
+}
+
+void MetricsWriter::sendBuffer()
+{
+    if (_length && _server)
+        _server->sendContent(_buffer, _length);
+    else if (_length)
+        _out->write((const uint8_t *)_buffer, _length);
+    _length = 0;
+}
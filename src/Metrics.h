@@ -0,0 +1,46 @@
+#ifndef METRICS_H_INCLUDE
+#define METRICS_H_INCLUDE
+
+#include <Arduino.h>
+#include <WebServer.h>
+
+/*
+MetricsWriter streams a /metrics response in the Prometheus text format.
+Output goes through a small fixed buffer that is sent as HTTP chunks,
+so the response size does not depend on free heap.
+The endpoint is built in the metrics build environment (METRICS_ENDPOINT),
+which also enables RequestTrace for the request histograms. The same
+text can be written to any Print, which the serial console uses.
+*/
+
+#define metricsBufferBytes 512
+#define metricsLabelBytes 96
+
+class MetricsWriter : public Print
+{
+public:
+  MetricsWriter(WebServer *server);
+  MetricsWriter(Print *out);
+  ~MetricsWriter();
+
+  void type(const char *name, const char *type, const char *help);
+  void sample(const char *name, const char *labels, uint32_t value);
+  void sample(const char *name, const char *labels, float value);
+  void requestHistograms();
+
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t *data, size_t size) override;
+
+  static boolean enabled();
+
+private:
+  void beginSample(const char *name, const char *labels);
+  void sendBuffer();
+
+  WebServer *_server = nullptr;
+  Print *_out = nullptr;
+  char _buffer[metricsBufferBytes];
+  size_t _length = 0;
+};
+
+#endif
@@ -0,0 +1,396 @@
+#include "PlayWidgets.h"
+#include <algorithm>
+
+#define quadrantUnits 16384
+#define circleUnits (4 * quadrantUnits)
+
+VolumeArcWidget::VolumeArcWidget(int32_t cx, int32_t cy, int32_t outerRadius, int32_t thickness, uint16_t color)
+    : Widget(Rect(cx - outerRadius, cy - outerRadius, outerRadius * 2, outerRadius * 2))
+{
+    _cx = cx;
+    _cy = cy;
+    _outerRadius = min(outerRadius, (int32_t)255);
+    _innerRadius = _outerRadius - thickness;
+    _color = color;
+
+    // Partial coverage is blended toward black, the compositor background
+    uint8_t r = (color >> 11) & 0x1F;
+    uint8_t g = (color >> 5) & 0x3F;
+    uint8_t b = color & 0x1F;
+    for (int level = 0; level < volumeArcShades; level++)
+    {
+        int32_t weight = level + 1;
+        _shades[level] = ((r * weight / volumeArcShades) << 11) | ((g * weight / volumeArcShades) << 5) | (b * weight / volumeArcShades);
+    }
+}
+
+// Angle of the pixel center (a + 0.5, b + 0.5) from the quadrant start direction
+uint16_t VolumeArcWidget::angleUnits(int32_t a, int32_t b)
+{
+    float angle = atan2f(a + 0.5f, b + 0.5f);
+    return (uint16_t)min((int32_t)lroundf(angle * quadrantUnits / HALF_PI), (int32_t)quadrantUnits - 1);
+}
+
+// The ring is symmetric in the four quadrants around a pixel corner center,
+// so one quadrant is enough. Sorted by angle for range lookups
+boolean VolumeArcWidget::buildTable()
+{
+    int32_t count = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        count = 0;
+        for (int32_t a = 0; a < _outerRadius; a++)
+        {
+            for (int32_t b = 0; b < _outerRadius; b++)
+            {
+                float distance = sqrtf((a + 0.5f) * (a + 0.5f) + (b + 0.5f) * (b + 0.5f));
+                float coverage = min(_outerRadius + 0.5f - distance, distance - _innerRadius + 0.5f);
+                if (coverage <= 0.0f)
+                    continue;
+                if (pass == 1)
+                {
+                    RingPixel &pixel = _table[count];
+                    pixel.angle = angleUnits(a, b);
+                    pixel.a = a;
+                    pixel.b = b;
+                    pixel.coverage = (uint8_t)(min(coverage, 1.0f) * 255.0f);
+                    pixel.radius = (uint8_t)lroundf(distance);
+                }
+                count++;
+            }
+        }
+        if (pass == 0)
+        {
+            _table = (RingPixel *)malloc(sizeof(RingPixel) * count);
+            if (!_table)
+            {
+                log_e("VolumeArc: failed to allocate %d ring pixels", count);
+                return false;
+            }
+        }
+    }
+    std::sort(_table, _table + count, [](const RingPixel &p, const RingPixel &q)
+              { return p.angle < q.angle; });
+    _tableSize = count;
+    return true;
+}
+
+// Only the ring pixels inside the band are visited, and only up to the current value
+void VolumeArcWidget::draw(LovyanGFX *dst, int32_t ox, int32_t oy)
+{
+    if (!_visible || _value <= 0)
+        return;
+    if (!_table && !buildTable())
+        return;
+
+    uint32_t endAngle = (uint32_t)min(_value, 100) * circleUnits / 100;
+    for (int quadrant = 0; quadrant < 4 && (uint32_t)quadrant * quadrantUnits < endAngle; quadrant++)
+    {
+        drawQuadrant(dst, quadrant, ox, oy, ox + dst->width() - 1, oy + dst->height() - 1, endAngle);
+    }
+}
+
+// (x0, y0)-(x1, y1) is the band in panel coordinates, both ends inclusive
+void VolumeArcWidget::drawQuadrant(LovyanGFX *dst, int quadrant, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t endAngle)
+{
+    // Map the band into the quadrant's (a, b) coordinates. Clockwise, starting at 12 o'clock:
+    // 0: (cx + a, cy - 1 - b), 1: (cx + b, cy + a), 2: (cx - 1 - a, cy + b), 3: (cx - 1 - b, cy - 1 - a)
+    int32_t a0, a1, b0, b1;
+    switch (quadrant)
+    {
+    case 0:
+        a0 = x0 - _cx, a1 = x1 - _cx, b0 = _cy - 1 - y1, b1 = _cy - 1 - y0;
+        break;
+    case 1:
+        a0 = y0 - _cy, a1 = y1 - _cy, b0 = x0 - _cx, b1 = x1 - _cx;
+        break;
+    case 2:
+        a0 = _cx - 1 - x1, a1 = _cx - 1 - x0, b0 = y0 - _cy, b1 = y1 - _cy;
+        break;
+    default:
+        a0 = _cy - 1 - y1, a1 = _cy - 1 - y0, b0 = _cx - 1 - x1, b1 = _cx - 1 - x0;
+        break;
+    }
+    a0 = max(a0, (int32_t)0);
+    b0 = max(b0, (int32_t)0);
+    a1 = min(a1, _outerRadius - 1);
+    b1 = min(b1, _outerRadius - 1);
+    if (a0 > a1 || b0 > b1)
+        return;
+
+    // The angle grows with a and shrinks with b, so the box spans this angle range
+    uint32_t base = (uint32_t)quadrant * quadrantUnits;
+    uint32_t from = base + angleUnits(a0, b1);
+    uint32_t to = min(base + angleUnits(a1, b0), endAngle + quadrantUnits / 64);
+    if (from > to)
+        return;
+
+    auto compare = [](const RingPixel &pixel, uint32_t angle)
+    { return pixel.angle < angle; };
+    const RingPixel *pixel = std::lower_bound(_table, _table + _tableSize, from - base, compare);
+    const RingPixel *end = _table + _tableSize;
+
+    for (; pixel < end && base + pixel->angle <= to; pixel++)
+    {
+        if (pixel->a < a0 || pixel->a > a1 || pixel->b < b0 || pixel->b > b1)
+            continue;
+
+        // Antialias the end of the sweep by the arc length to the pixel center
+        uint32_t coverage = pixel->coverage;
+        uint32_t angle = base + pixel->angle;
+        if (angle + quadrantUnits / 64 > endAngle)
+        {
+            float arc = ((float)endAngle - angle) * TWO_PI / circleUnits * pixel->radius + 0.5f;
+            if (arc <= 0.0f)
+                continue;
+            if (arc < 1.0f)
+                coverage = coverage * arc;
+        }
+        if (coverage == 0)
+            continue;
+        int level = coverage * volumeArcShades / 256;
+
+        int32_t x, y;
+        switch (quadrant)
+        {
+        case 0:
+            x = _cx + pixel->a, y = _cy - 1 - pixel->b;
+            break;
+        case 1:
+            x = _cx + pixel->b, y = _cy + pixel->a;
+            break;
+        case 2:
+            x = _cx - 1 - pixel->a, y = _cy + pixel->b;
+            break;
+        default:
+            x = _cx - 1 - pixel->b, y = _cy - 1 - pixel->a;
+            break;
+        }
+        dst->drawPixel(x - x0, y - y0, _shades[level]);
+    }
+}
+
+// Only the sector between the old and the new value needs redrawing
+void VolumeArcWidget::setValue(int value)
+{
+    if (value == _value)
+        return;
+    if (_visible)
+    {
+        float from = angleForValue(min(value, _value));
+        float to = angleForValue(max(value, _value));
+        invalidate(sectorBounds(from, to));
+    }
+    _value = value;
+}
+
+void VolumeArcWidget::setVisible(boolean visible)
+{
+    if (visible == _visible)
+        return;
+    _visible = visible;
+    invalidate(sectorBounds(angleForValue(0), angleForValue(_value)));
+}
+
+// Bounding box of the ring sector from startAngle to endAngle (degrees, clockwise from 3 o'clock)
+Rect VolumeArcWidget::sectorBounds(float startAngle, float endAngle)
+{
+    float left = _cx, right = _cx, top = _cy, bottom = _cy;
+    boolean first = true;
+    auto include = [&](float angle, int32_t radius)
+    {
+        float radian = angle * DEG_TO_RAD;
+        float px = _cx + cosf(radian) * radius;
+        float py = _cy + sinf(radian) * radius;
+        if (first)
+        {
+            left = right = px;
+            top = bottom = py;
+            first = false;
+        }
+        left = min(left, px);
+        right = max(right, px);
+        top = min(top, py);
+        bottom = max(bottom, py);
+    };
+
+    include(startAngle, _outerRadius);
+    include(startAngle, _innerRadius);
+    include(endAngle, _outerRadius);
+    include(endAngle, _innerRadius);
+    for (float axis = ceilf(startAngle / 90.0f) * 90.0f; axis < endAngle; axis += 90.0f)
+    {
+        include(axis, _outerRadius);
+    }
+
+    // One pixel margin for rounding at the sector edges
+    int32_t x = (int32_t)floorf(left) - 1;
+    int32_t y = (int32_t)floorf(top) - 1;
+    return Rect(x, y, (int32_t)ceilf(right) + 2 - x, (int32_t)ceilf(bottom) + 2 - y);
+}
+
+PlayPauseWidget::PlayPauseWidget(const Rect &bounds, uint16_t color) : Widget(bounds)
+{
+    _color = color;
+}
+
+void PlayPauseWidget::draw(LovyanGFX *dst, int32_t ox, int32_t oy)
+{
+    int32_t x = _bounds.x - ox;
+    int32_t y = _bounds.y - oy;
+    if (_playing)
+    {
+        dst->fillRect(x + 6, y, 10, _bounds.h, _color);
+        dst->fillRect(x + 29, y, 10, _bounds.h, _color);
+    }
+    else
+    {
+        dst->fillTriangle(x, y, x + _bounds.w, y + _bounds.h / 2, x, y + _bounds.h, _color);
+    }
+}
+
+void PlayPauseWidget::setPlaying(boolean playing)
+{
+    if (playing == _playing)
+        return;
+    _playing = playing;
+    invalidate();
+}
+
+SkipIconWidget::SkipIconWidget(const Rect &bounds, boolean forward, uint16_t color) : Widget(bounds)
+{
+    _forward = forward;
+    _color = color;
+}
+
+void SkipIconWidget::draw(LovyanGFX *dst, int32_t ox, int32_t oy)
+{
+    int32_t x = _bounds.x - ox;
+    int32_t y = _bounds.y - oy;
+    int32_t w = _bounds.w;
+    int32_t h = _bounds.h;
+    if (_forward)
+    {
+        dst->fillTriangle(x, y, x + w, y + h / 2, x, y + h, _color);
+        dst->fillRect(x + w - 8, y, 8, h, _color);
+    }
+    else
+    {
+        dst->fillTriangle(x, y + h / 2, x + w, y, x + w, y + h, _color);
+        dst->fillRect(x, y, 8, h, _color);
+    }
+}
+
+ArtTileWidget::ArtTileWidget(const Rect &bounds, LGFX_Sprite *art) : Widget(bounds)
+{
+    _art = art;
+}
+
+void ArtTileWidget::draw(LovyanGFX *dst, int32_t ox, int32_t oy)
+{
+    _art->pushSprite(dst, _bounds.x - ox, _bounds.y - oy);
+}
+
+LabelWidget::LabelWidget(const Rect &bounds, GlyphCache *glyphs, uint16_t color) : Widget(bounds)
+{
+    _glyphs = glyphs;
+    _color = color;
+    _strip.setColorDepth(1);
+}
+
+// Cost depends on the label size only, not on the text length or glyphs
+void LabelWidget::draw(LovyanGFX *dst, int32_t ox, int32_t oy)
+{
+    if (_textWidth <= 0)
+        return;
+    int32_t x = _bounds.x - ox;
+    int32_t y = _bounds.y - oy;
+    dst->setClipRect(x, y, _bounds.w, _bounds.h);
+    _strip.pushSprite(dst, x + _offset, y);
+    dst->clearClipRect();
+}
+
+// Rasterize the whole text once. 1-bit keeps even long CJK titles small
+void LabelWidget::renderStrip()
+{
+    _strip.deleteSprite();
+    _textWidth = min(_glyphs->textWidth(_text), (int32_t)labelMaxStripWidth);
+    if (_textWidth <= 0)
+        return;
+    if (!_strip.createSprite(_textWidth, _bounds.h))
+    {
+        log_e("Label: failed to allocate %dx%d strip", _textWidth, _bounds.h);
+        _textWidth = 0;
+        return;
+    }
+    _strip.setPaletteColor(1, _color);
+    _strip.fillScreen(0);
+    _glyphs->drawString(&_strip, _text, 0, 0, top_left, 1);
+}
+
+// Time based, so the scroll speed does not depend on the frame rate
+void LabelWidget::tick(uint32_t now)
+{
+    if (_textWidth <= _bounds.w)
+        return;
+
+    if (_restart)
+    {
+        _restart = false;
+        _scrolling = false;
+        _phaseStart = now;
+        setOffset(0);
+        return;
+    }
+
+    uint32_t elapsed = now - _phaseStart;
+    if (!_scrolling)
+    {
+        if (elapsed >= _pause)
+        {
+            _scrolling = true;
+            _phaseStart = now;
+        }
+        return;
+    }
+
+    int32_t travel = (int32_t)(elapsed * _speed / 1000);
+    int32_t cycle = _textWidth + _bounds.w;
+    if (travel >= cycle)
+    {
+        _restart = true;
+        setOffset(0);
+        return;
+    }
+
+    int32_t offset = -travel;
+    if (offset < -_textWidth)
+        offset += cycle;
+    setOffset(offset);
+}
+
+// Setting the same text keeps the current scroll position
+void LabelWidget::setText(const String &text)
+{
+    if (text == _text)
+        return;
+    _text = text;
+    renderStrip();
+    _restart = true;
+    setOffset(0);
+    invalidate();
+}
+
+void LabelWidget::setScroll(int32_t pixelsPerSecond, uint32_t pauseMillis)
+{
+    _speed = pixelsPerSecond;
+    _pause = pauseMillis;
+}
+
+void LabelWidget::setOffset(int32_t offset)
+{
+    if (offset == _offset)
+        return;
+    _offset = offset;
+    invalidate();
+}
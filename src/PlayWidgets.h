@@ -0,0 +1,123 @@
+#ifndef PLAYWIDGETS_H_INCLUDE
+#define PLAYWIDGETS_H_INCLUDE
+
+#include "Compositor.h"
+#include "GlyphCache.h"
+
+/*
+Widgets of the play screen. Setters only invalidate what actually changed.
+Colors are RGB565: LovyanGFX treats uint32_t colors as RGB888.
+*/
+
+// Volume ring around the panel edge, starting at 12 o'clock.
+// Drawn from a table of the ring pixels of one quadrant, sorted by angle,
+// so a band only visits the pixels of the arc that fall inside it.
+// Edges are antialiased against the black background
+#define volumeArcShades 16
+
+class VolumeArcWidget : public Widget
+{
+public:
+  VolumeArcWidget(int32_t cx, int32_t cy, int32_t outerRadius, int32_t thickness, uint16_t color);
+  void draw(LovyanGFX *dst, int32_t ox, int32_t oy) override;
+
+  void setValue(int value);
+  void setVisible(boolean visible);
+
+private:
+  struct RingPixel
+  {
+    uint16_t angle;   // clockwise from the quadrant start, 16384 per quadrant
+    uint8_t a;        // offset along the quadrant start direction
+    uint8_t b;        // offset toward the center line of the previous quadrant
+    uint8_t coverage; // radial coverage 0-255
+    uint8_t radius;
+  };
+
+  boolean buildTable();
+  void drawQuadrant(LovyanGFX *dst, int quadrant, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t endAngle);
+  Rect sectorBounds(float startAngle, float endAngle);
+  static float angleForValue(int value) { return 270.0f + 360.0f * value / 100.0f; }
+  static uint16_t angleUnits(int32_t a, int32_t b);
+
+  int32_t _cx, _cy, _outerRadius, _innerRadius;
+  uint16_t _color;
+  uint16_t _shades[volumeArcShades];
+  RingPixel *_table = nullptr;
+  int32_t _tableSize = 0;
+  int _value = 0;
+  boolean _visible = false;
+};
+
+// Play triangle or pause bars
+class PlayPauseWidget : public Widget
+{
+public:
+  PlayPauseWidget(const Rect &bounds, uint16_t color);
+  void draw(LovyanGFX *dst, int32_t ox, int32_t oy) override;
+  void setPlaying(boolean playing);
+
+private:
+  uint16_t _color;
+  boolean _playing = false;
+};
+
+// Static skip previous / next icon
+class SkipIconWidget : public Widget
+{
+public:
+  SkipIconWidget(const Rect &bounds, boolean forward, uint16_t color);
+  void draw(LovyanGFX *dst, int32_t ox, int32_t oy) override;
+
+private:
+  boolean _forward;
+  uint16_t _color;
+};
+
+// Album art tile. Call invalidate() after the sprite content changed
+class ArtTileWidget : public Widget
+{
+public:
+  ArtTileWidget(const Rect &bounds, LGFX_Sprite *art);
+  void draw(LovyanGFX *dst, int32_t ox, int32_t oy) override;
+
+private:
+  LGFX_Sprite *_art;
+};
+
+// Single line label. The text is rasterized once into a 1-bit strip when it
+// changes; drawing is a clipped copy of the strip at the scroll offset.
+// Text wider than the bounds scrolls as a marquee:
+// pause, scroll out to the left, re-enter from the right, pause again
+#define labelMaxStripWidth 2048
+
+class LabelWidget : public Widget
+{
+public:
+  LabelWidget(const Rect &bounds, GlyphCache *glyphs, uint16_t color);
+  void draw(LovyanGFX *dst, int32_t ox, int32_t oy) override;
+  void tick(uint32_t now) override;
+  boolean animating() override { return _textWidth > _bounds.w; }
+
+  void setText(const String &text);
+  void setScroll(int32_t pixelsPerSecond, uint32_t pauseMillis);
+
+private:
+  void setOffset(int32_t offset);
+  void renderStrip();
+
+  GlyphCache *_glyphs;
+  uint16_t _color;
+  LGFX_Sprite _strip;
+  String _text;
+  int32_t _textWidth = 0;
+  int32_t _offset = 0;
+
+  int32_t _speed = 20;
+  uint32_t _pause = 1000;
+  boolean _scrolling = false;
+  boolean _restart = true;
+  uint32_t _phaseStart = 0;
+};
+
+#endif
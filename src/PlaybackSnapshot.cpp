@@ -0,0 +1,106 @@
+#include "PlaybackSnapshot.h"
+
+void PlaybackSnapshot::clear()
+{
+    version = 0;
+    deviceID[0] = 0;
+    trackName[0] = 0;
+    artistName[0] = 0;
+    imageURL[0] = 0;
+    supportsVolume = false;
+    isPlaying = false;
+    volume = 0;
+    progressMillis = 0;
+    durationMillis = 0;
+}
+
+// Everything except the version and the playback position
+boolean PlaybackSnapshot::sameState(const PlaybackSnapshot &other) const
+{
+    return durationMillis == other.durationMillis && diff(other) == 0;
+}
+
+// PlaybackChange bits of the fields that differ from previous
+uint8_t PlaybackSnapshot::diff(const PlaybackSnapshot &previous) const
+{
+    uint8_t changes = 0;
+    if (strcmp(trackName, previous.trackName) != 0)
+        changes |= PlaybackChangedTrack;
+    if (strcmp(artistName, previous.artistName) != 0)
+        changes |= PlaybackChangedArtist;
+    if (strcmp(imageURL, previous.imageURL) != 0)
+        changes |= PlaybackChangedArt;
+    if (volume != previous.volume)
+        changes |= PlaybackChangedVolume;
+    if (isPlaying != previous.isPlaying)
+        changes |= PlaybackChangedPlayState;
+    if (supportsVolume != previous.supportsVolume || strcmp(deviceID, previous.deviceID) != 0)
+        changes |= PlaybackChangedDevice;
+    return changes;
+}
+
+// Copy text, truncated to the buffer
+void PlaybackSnapshot::copyText(char *target, size_t size, const char *text)
+{
+    strncpy(target, text, size - 1);
+    target[size - 1] = 0;
+}
+
+// Append separator and text, or just the text if target is empty
+void PlaybackSnapshot::appendText(char *target, size_t size, const char *separator, const char *text)
+{
+    if (target[0])
+        strlcat(target, separator, size);
+    strlcat(target, text, size);
+}
+
+PlaybackChannel::PlaybackChannel() : _sequence(0)
+{
+    _slots[0].clear();
+    _slots[1].clear();
+}
+
+// Single writer. Fills in the version of snapshot and publishes a copy.
+// The sequence is 2 * published count, odd while a slot is being written
+void PlaybackChannel::publish(PlaybackSnapshot &snapshot)
+{
+    uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+    uint32_t published = sequence >> 1;
+    const PlaybackSnapshot &current = _slots[published & 1];
+    snapshot.version = current.sameState(snapshot) ? current.version : current.version + 1;
+
+    // Readers keep using the current slot while the other one is written
+    _sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _slots[(published + 1) & 1] = snapshot;
+    _sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// Copy the latest snapshot. Retries only if the writer started to reuse
+// the slot meanwhile, which takes two publications during one copy
+void PlaybackChannel::read(PlaybackSnapshot &snapshot) const
+{
+    while (true)
+    {
+        uint32_t sequence = _sequence.load(std::memory_order_acquire);
+        uint32_t published = sequence >> 1;
+        snapshot = _slots[published & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) - published * 2 < 3)
+            return;
+    }
+}
+
+// Same as read() for the version only
+uint32_t PlaybackChannel::version() const
+{
+    while (true)
+    {
+        uint32_t sequence = _sequence.load(std::memory_order_acquire);
+        uint32_t published = sequence >> 1;
+        uint32_t version = _slots[published & 1].version;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) - published * 2 < 3)
+            return version;
+    }
+}
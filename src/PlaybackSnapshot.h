@@ -0,0 +1,66 @@
+#ifndef PLAYBACKSNAPSHOT_H_INCLUDE
+#define PLAYBACKSNAPSHOT_H_INCLUDE
+
+#include <Arduino.h>
+#include <atomic>
+
+/*
+PlaybackSnapshot is one complete playback state in fixed buffers, so
+filling it never allocates. PlaybackChannel publishes snapshots from the
+task that fetches them to any number of readers with a seqlock over two
+slots: readers never block and never see a half written state.
+version counts published changes; progressMillis alone does not count,
+so a reader whose version is unchanged can skip redrawing.
+*/
+
+#define snapshotIdBytes 48
+#define snapshotTextBytes 160
+#define snapshotURLBytes 128
+
+// Bits of PlaybackSnapshot::diff()
+typedef enum
+{
+  PlaybackChangedTrack = 1 << 0,
+  PlaybackChangedArtist = 1 << 1,
+  PlaybackChangedArt = 1 << 2,
+  PlaybackChangedVolume = 1 << 3,
+  PlaybackChangedPlayState = 1 << 4,
+  PlaybackChangedDevice = 1 << 5, // device ID or its volume support
+  PlaybackChangedAll = 0x3F
+} PlaybackChange;
+
+struct PlaybackSnapshot
+{
+  uint32_t version;
+  char deviceID[snapshotIdBytes];
+  char trackName[snapshotTextBytes];
+  char artistName[snapshotTextBytes];
+  char imageURL[snapshotURLBytes];
+  boolean supportsVolume;
+  boolean isPlaying;
+  int volume;
+  long progressMillis;
+  long durationMillis;
+
+  void clear();
+  boolean sameState(const PlaybackSnapshot &other) const;
+  uint8_t diff(const PlaybackSnapshot &previous) const;
+
+  static void copyText(char *target, size_t size, const char *text);
+  static void appendText(char *target, size_t size, const char *separator, const char *text);
+};
+
+class PlaybackChannel
+{
+public:
+  PlaybackChannel();
+  void publish(PlaybackSnapshot &snapshot);
+  void read(PlaybackSnapshot &snapshot) const;
+  uint32_t version() const;
+
+private:
+  PlaybackSnapshot _slots[2];
+  std::atomic<uint32_t> _sequence;
+};
+
+#endif
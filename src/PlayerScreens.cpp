@@ -0,0 +1,388 @@
+#include "PlayerScreens.h"
+
+// ダイヤルの回転速度に応じた加速（画面ごと）
+static const DialCurve volumeCurve = {1, 4.0f, 24.0f, 5.0f};  // 速く回すと数ノッチで0〜100
+static const DialCurve menuCurve = {dialCountsPerDetent, 0.0f, 0.0f, 1.0f};
+static const DialCurve listCurve = {dialCountsPerDetent, 4.0f, 20.0f, 8.0f};
+
+PlayerScreens::PlaylistSource::PlaylistSource(PlayerScreens *screens)
+    : PlaylistListSource(&screens->_service->playlists(), PlaylistName, &screens->_selectedPlaylistId)
+{
+    _screens = screens;
+}
+
+boolean PlayerScreens::PlaylistSource::drawRowIcon(LovyanGFX *dst, int row, int32_t x, int32_t y)
+{
+    return row > 0 && _screens->_host->drawPlaylistIcon(row - 1, dst, x, y);
+}
+
+PlayerScreens::PlayerScreens(PlayerView *view, PlayerService *service, PlayerHost *host, DialMotion *dial)
+    : _view(view),
+      _service(service),
+      _host(host),
+      _dial(dial),
+      _menuItems{"<< Back", "Select Playlist", "Select Device"},
+      _menuSource(_menuItems, PlayerMenuItemCount),
+      _deviceSource(&service->devices(), DeviceName),
+      _playlistSource(this)
+{
+    _playing.clear();
+    _shown.clear();
+}
+
+void PlayerScreens::begin()
+{
+    _curveScreen = -1;
+    showPlay(true);
+}
+
+void PlayerScreens::handle()
+{
+    // コマンドの反映待ちの間は入力を受け付けない（二重送信防止）
+    // ダイヤルのイベントはリングに残り、待ちの後でまとめて反映する
+    if (_settling)
+    {
+        if ((int32_t)(millis() - _settleMillis) < 0)
+            return;
+        _settling = false;
+        showPlay(_settleFull);
+    }
+
+    switch (_screen)
+    {
+    case PlayerScreenPlay:
+        handlePlay();
+        break;
+    case PlayerScreenMenu:
+        handleMenu();
+        break;
+    case PlayerScreenDevices:
+        handleDevices();
+        break;
+    case PlayerScreenPlaylists:
+        handlePlaylists();
+        break;
+    }
+}
+
+uint32_t PlayerScreens::untilNext(uint32_t limit)
+{
+    uint32_t now = millis();
+    uint32_t timeout = limit;
+    if (_settling)
+        timeout = min(timeout, (uint32_t)max((int32_t)(_settleMillis - now), (int32_t)0));
+    if (_screen == PlayerScreenPlay)
+    {
+        if (_volume != _playing.volume)
+            timeout = min(timeout, (uint32_t)max((int32_t)(_volumeMillis + playerVolumeSettleMillis + 1 - now), (int32_t)0));
+        if (_trackEndMillis != 0)
+            timeout = min(timeout, (uint32_t)max((int32_t)(_trackEndMillis + 1 - now), (int32_t)0));
+    }
+    return timeout;
+}
+
+void PlayerScreens::restore(const PlaybackSnapshot &shown)
+{
+    _shown = shown;
+    _restored = true;
+}
+
+void PlayerScreens::handlePlay()
+{
+    if (_host->buttonReleased())
+    {
+        _host->beep(20);
+        showMenu();
+        return;
+    }
+
+    // 長押しで即座にプレイリスト再生
+    if (_host->buttonLongReleased() && !_selectedPlaylistId.isEmpty())
+    {
+        _host->beep(50);
+        _service->playPlaylist(_selectedPlaylistId);
+        settle(false);
+        return;
+    }
+
+    // Dial
+    int steps = _dial->take();
+    if (_playing.supportsVolume)
+    {
+        // Position changed
+        if (steps != 0)
+        {
+            _volume = constrain(_volume + steps, 0, 100);
+            _volumeMillis = millis();
+            _host->lock();
+            _view->setVolume(_volume);
+            _host->unlock();
+        }
+        // Position not changed. Wait 1 second and request volume change
+        else if (millis() - _volumeMillis > playerVolumeSettleMillis && _volume != _playing.volume)
+        {
+            _host->beep(20);
+            _service->changeVolume(_volume);
+            settle(false);
+            return;
+        }
+    }
+
+    // Auto redraw
+    if (_trackEndMillis != 0 && (int32_t)(millis() - _trackEndMillis) > 0)
+    {
+        _trackEndMillis = 0;
+        showPlay(false);
+        return;
+    }
+
+    // Touch
+    int32_t x, y;
+    if (!_host->tapped(x, y) || y <= 65 || y >= 65 + 60)
+        return;
+    if (x > 95 && x < viewWidth - 95)
+    {
+        // Play or Pause
+        _host->beep(20);
+        if (_playing.isPlaying)
+            _service->pausePlayback();
+        else
+            _service->resumePlayback();
+        _service->getPlaybackState();
+        _service->playback().read(_playing);
+        redrawPlay();
+    }
+    else if (x < 75)
+    {
+        _host->beep(20);
+        _service->skipToPrev();
+        settle(false);
+    }
+    else if (x > 75 + 60)
+    {
+        _host->beep(20);
+        _service->skipToNext();
+        settle(false);
+    }
+}
+
+void PlayerScreens::handleMenu()
+{
+    // ボタン押下で選択
+    if (_host->buttonReleased())
+    {
+        _host->beep(20);
+        switch (_selectedRow)
+        {
+        case PlayerMenuDevices:
+            showDevices();
+            break;
+        case PlayerMenuPlaylists:
+            showPlaylists();
+            break;
+        default:
+            showPlay(true);  // 完全リフレッシュの確保
+            break;
+        }
+        return;
+    }
+
+    // ダイヤル回転でメニュー選択
+    int steps = _dial->take();
+    if (steps != 0)
+        select(constrain(_selectedRow + steps, 0, PlayerMenuItemCount - 1));
+}
+
+void PlayerScreens::handleDevices()
+{
+    if (_host->buttonReleased())
+    {
+        _host->beep(20);
+        // 「<< Back」が選択されている場合
+        if (_selectedRow == 0)
+        {
+            showMenu();
+            return;
+        }
+
+        int index = _selectedRow - 1;  // Back optionの分を調整
+        const EntryStore &devices = _service->devices();
+        if (index < devices.size() && strcmp(devices.text(index, DeviceID), _playing.deviceID) != 0)
+            _service->selectDevice(devices.text(index, DeviceID));
+        settle(true);
+        return;
+    }
+
+    int steps = _dial->take();
+    if (steps != 0)
+        select(constrain(_selectedRow + steps, 0, _service->devices().size()));  // +1 for Back option
+}
+
+void PlayerScreens::handlePlaylists()
+{
+    if (_host->buttonReleased())
+    {
+        _host->beep(20);
+        _host->playlistsClosed();
+        // 「<< Back」が選択されている場合
+        if (_selectedRow == 0)
+        {
+            showMenu();
+            return;
+        }
+
+        int index = _selectedRow - 1;  // Back optionの分を調整
+        const EntryStore &playlists = _service->playlists();
+        if (index < playlists.size())
+        {
+            // 選択したプレイリストを保存して再生、再生画面に戻る
+            _selectedPlaylistId = playlists.id(index);
+            _host->playlistSelected(_selectedPlaylistId);
+            _service->playPlaylist(_selectedPlaylistId);
+            settle(true);
+        }
+        return;
+    }
+
+    // プレイリストをスクロール
+    int steps = _dial->take();
+    if (steps != 0)
+    {
+        int row = constrain(_selectedRow + steps, 0, _service->playlists().size());  // +1 for Back option
+        _host->playlistFocused(row - 1);
+        select(row);
+    }
+
+    // サムネイルの読み込みが終わったらリストを描き直す
+    if (_host->playlistIconsChanged())
+    {
+        _host->lock();
+        _view->listChanged();
+        _host->unlock();
+    }
+}
+
+// Get status and show player screen
+void PlayerScreens::showPlay(boolean full)
+{
+    // 他の画面から戻った場合は全体を再合成（黒画面のちらつきなし）
+    if (full || _host->activeScreen() != _view->playScreen())
+        _host->setActiveScreen(_view->playScreen());
+
+    setScreen(PlayerScreenPlay);
+    _service->getPlaybackState();
+    _service->playback().read(_playing);
+    _volume = _playing.volume;
+
+    if (_playing.durationMillis > 0)
+        _trackEndMillis = millis() + (_playing.durationMillis - _playing.progressMillis) + playerTrackEndMillis;
+    else
+        _trackEndMillis = 0;
+
+    redrawPlay();
+}
+
+// Redraw player screen components
+void PlayerScreens::redrawPlay()
+{
+    // ウィジェットは値が変わった部分だけを無効化する（描画は描画タスクが行う）
+    // 前回反映した状態との差分だけを更新（再生位置だけの変化では何もしない）
+    // restore()の直後は版数が一致しても差分を取る
+    boolean sameVersion = _playing.version == _shown.version && !_restored;
+    uint8_t changes = sameVersion ? 0 : _playing.diff(_shown);
+    _restored = false;
+    if (changes & PlaybackChangedArt)
+        _host->loadArt(_playing.imageURL);
+
+    _host->lock();
+    // ダイヤル操作で変えた音量は必ず戻す
+    _view->showPlayback(_playing, changes);
+    _host->unlock();
+    _shown = _playing;
+
+    if (changes)
+        _host->playbackShown(changes);
+}
+
+void PlayerScreens::showMenu()
+{
+    setScreen(PlayerScreenMenu);
+    showList(&_menuSource, PlayerMenuBack);
+}
+
+void PlayerScreens::showDevices()
+{
+    setScreen(PlayerScreenDevices);
+    _service->getDeviceList();
+
+    const EntryStore &devices = _service->devices();
+    int row = 0;
+    for (int i = 0; i < devices.size(); i++)
+    {
+        if (strcmp(_playing.deviceID, devices.text(i, DeviceID)) == 0)
+        {
+            row = i + 1;  // +1 for Back option
+            break;
+        }
+    }
+    showList(&_deviceSource, row);
+}
+
+void PlayerScreens::showPlaylists()
+{
+    setScreen(PlayerScreenPlaylists);
+    _host->showLoading("Loading playlists...");
+    _service->getUserPlaylists();
+
+    // デフォルトで先頭の「<< Back」を選択、以前に選択したプレイリストがあればその行
+    int row = 0;
+    if (!_selectedPlaylistId.isEmpty())
+        row = _service->playlists().find(_selectedPlaylistId) + 1;  // +1 for Back option
+    _host->playlistsLoaded(row - 1);
+    showList(&_playlistSource, row);
+}
+
+// Hand a list to the render task. Scrolling is animated there
+void PlayerScreens::showList(ListSource *source, int selectedRow)
+{
+    _selectedRow = selectedRow;
+    _host->lock();
+    _view->showList(source, selectedRow);
+    if (_host->activeScreen() != _view->listScreen())
+        _host->setActiveScreen(_view->listScreen());
+    else
+        _view->listScreen()->invalidateAll();
+    _host->unlock();
+}
+
+void PlayerScreens::select(int row)
+{
+    _selectedRow = row;
+    _host->lock();
+    _view->select(row);
+    _host->unlock();
+}
+
+// Fetch the playback state once the command settled
+void PlayerScreens::settle(boolean full)
+{
+    _settling = true;
+    _settleMillis = millis() + playerCommandSettleMillis;
+    _settleFull = full;
+}
+
+// 画面が変わったら加速カーブを切り替え、前の画面の回転は捨てる
+// （切り替えた後の回転は、一覧の読み込み中のものも次の画面で反映する）
+void PlayerScreens::setScreen(PlayerScreen screen)
+{
+    _screen = screen;
+    if (_curveScreen == _screen)
+        return;
+    _curveScreen = _screen;
+    if (_screen == PlayerScreenPlay)
+        _dial->setCurve(volumeCurve);
+    else if (_screen == PlayerScreenMenu)
+        _dial->setCurve(menuCurve);
+    else
+        _dial->setCurve(listCurve);
+}
@@ -0,0 +1,177 @@
+#ifndef PLAYERSCREENS_H_INCLUDE
+#define PLAYERSCREENS_H_INCLUDE
+
+#include <Arduino.h>
+#include "PlayerView.h"
+#include "SpotifyLists.h"
+#include "DialEncoder.h"
+
+/*
+PlayerScreens is the screen logic of the player: the play screen, the
+menu and the device and playlist lists. It turns dial steps, button
+presses and taps into Spotify commands and screen changes, and keeps
+PlayerView in step with the published playback state by diffing it
+against what is shown. The firmware (main.cpp) and the host simulator
+(src/sim) run this same code: the firmware with SPClient, the M5Dial
+input and RenderLoop, the simulator with MockSpotify, scripted input
+and a virtual panel.
+After a command the playback state is fetched again once it settled
+(playerCommandSettleMillis); until then handle() takes no input, and
+dial rotation waits in the DialEncoder ring.
+*/
+
+#define playerCommandSettleMillis 100  // after a command, until the playback state is fetched again
+#define playerVolumeSettleMillis 1000  // after the dial stops, until the volume is sent
+#define playerTrackEndMillis 100       // after the end of the track, until it is fetched again
+
+typedef enum
+{
+  PlayerScreenPlay = 0,
+  PlayerScreenMenu,
+  PlayerScreenDevices,
+  PlayerScreenPlaylists
+} PlayerScreen;
+
+typedef enum
+{
+  PlayerMenuBack = 0,
+  PlayerMenuPlaylists,
+  PlayerMenuDevices,
+  PlayerMenuItemCount
+} PlayerMenuItem;
+
+// Spotify as the screens use it: SPClient on the device, MockSpotify in the simulator
+class PlayerService
+{
+public:
+  virtual ~PlayerService() {}
+  virtual const PlaybackChannel &playback() = 0;
+  virtual const EntryStore &devices() = 0;
+  virtual const EntryStore &playlists() = 0;
+
+  virtual int getPlaybackState() = 0;
+  virtual int getDeviceList() = 0;
+  virtual int getUserPlaylists() = 0;
+  virtual int changeVolume(int volume) = 0;
+  virtual int resumePlayback() = 0;
+  virtual int pausePlayback() = 0;
+  virtual int skipToNext() = 0;
+  virtual int skipToPrev() = 0;
+  virtual int selectDevice(const String &deviceID) = 0;
+  virtual int playPlaylist(const String &playlistId) = 0;
+};
+
+// Everything around the screens: input, the panel, album art and storage
+class PlayerHost
+{
+public:
+  virtual ~PlayerHost() {}
+
+  // Input since the last handle(). A tap is reported once, when it ends
+  virtual boolean buttonReleased() = 0;
+  virtual boolean buttonLongReleased() = 0;
+  virtual boolean tapped(int32_t &x, int32_t &y) = 0;
+  virtual void beep(uint32_t millis) {}
+
+  // The panel. Hold lock() while changing the view; setActiveScreen(nullptr)
+  // hands the panel over for direct drawing
+  virtual void lock() {}
+  virtual void unlock() {}
+  virtual Compositor *activeScreen() = 0;
+  virtual void setActiveScreen(Compositor *screen) = 0;
+  virtual void showLoading(const char *message) {}
+
+  // Write the art of imageURL into PlayerView::art() (empty: none), then artChanged()
+  virtual void loadArt(const char *imageURL) = 0;
+  // The play screen now shows these changes (PlaybackChange bits)
+  virtual void playbackShown(uint8_t changes) {}
+
+  // Playlist icons: loaded for the rows around focus, -1 for none
+  virtual void playlistsLoaded(int focus) {}
+  virtual void playlistFocused(int focus) {}
+  virtual void playlistsClosed() {}
+  // True once if icons finished loading since the last call
+  virtual boolean playlistIconsChanged() { return false; }
+  virtual boolean drawPlaylistIcon(int index, LovyanGFX *dst, int32_t x, int32_t y) { return false; }
+  virtual void playlistSelected(const String &playlistId) {}
+};
+
+class PlayerScreens
+{
+public:
+  PlayerScreens(PlayerView *view, PlayerService *service, PlayerHost *host, DialMotion *dial);
+
+  // Show the play screen after other screens. Rotation made meanwhile is dropped
+  void begin();
+  // Fetch the playback state and show it. full recomposes the whole panel
+  void showPlay(boolean full);
+  void showMenu();
+  void showDevices();
+  void showPlaylists();
+
+  // Input and timers. Call from loop() while a player screen is shown
+  void handle();
+  // A command settles: no input until the playback state is fetched again
+  boolean settling() { return _settling; }
+  // Milliseconds until handle() has work without new input, at most limit
+  uint32_t untilNext(uint32_t limit);
+
+  // The play screen shows shown, drawn before the first fetch (e.g. saved at the last boot)
+  void restore(const PlaybackSnapshot &shown);
+
+  PlayerScreen screen() { return _screen; }
+  const PlaybackSnapshot &playing() { return _playing; }
+  const PlaybackSnapshot &shown() { return _shown; }
+  const String &selectedPlaylist() { return _selectedPlaylistId; }
+  void setSelectedPlaylist(const String &playlistId) { _selectedPlaylistId = playlistId; }
+
+private:
+  // Playlists with the host's icons
+  class PlaylistSource : public PlaylistListSource
+  {
+  public:
+    PlaylistSource(PlayerScreens *screens);
+    boolean drawRowIcon(LovyanGFX *dst, int row, int32_t x, int32_t y) override;
+
+  private:
+    PlayerScreens *_screens;
+  };
+
+  void handlePlay();
+  void handleMenu();
+  void handleDevices();
+  void handlePlaylists();
+
+  void redrawPlay();
+  void showList(ListSource *source, int selectedRow);
+  void select(int row);
+  void settle(boolean full);
+  void setScreen(PlayerScreen screen);
+
+  PlayerView *_view;
+  PlayerService *_service;
+  PlayerHost *_host;
+  DialMotion *_dial;
+
+  String _menuItems[PlayerMenuItemCount];
+  TextListSource _menuSource;
+  EntryListSource _deviceSource;
+  PlaylistSource _playlistSource;
+  String _selectedPlaylistId;
+
+  PlayerScreen _screen = PlayerScreenPlay;
+  int _curveScreen = -1;  // screen of the dial's curve
+  int _selectedRow = 0;
+
+  PlaybackSnapshot _playing;  // the last state read from the service
+  PlaybackSnapshot _shown;    // what the play screen shows
+  boolean _restored = false;  // _shown came from restore(): its version means nothing
+  int _volume = 0;            // the dial's volume, sent once it settles
+  uint32_t _volumeMillis = 0;
+  uint32_t _trackEndMillis = 0;  // 0: no track playing
+  boolean _settling = false;
+  uint32_t _settleMillis = 0;
+  boolean _settleFull = false;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "PlayerView.h"
+
+PlayerView::PlayerView(GlyphCache *glyphs, uint16_t color)
+    : _volumeArc(viewWidth / 2, viewHeight / 2, viewWidth / 2, 8, color),
+      _playPause(Rect(98, 65, 60, 60), color),
+      _skipPrev(Rect(34, 70, 40, 50), false, color),
+      _skipNext(Rect(166, 70, 40, 50), true, color),
+      _artTile(Rect(30, 150, artSize, artSize), &_art),
+      _track(Rect(90, 150, 110, 25), glyphs, WHITE),
+      _artist(Rect(90, 180, 110, 25), glyphs, WHITE),
+      _listView(Rect(0, 0, viewWidth, viewHeight), glyphs, color, listRowHeight)
+{
+}
+
+// Allocate the art sprite and the band buffers of both screens.
+// iconSize is the size of the row icons of lists, 0 for none
+boolean PlayerView::begin(LovyanGFX *panel, int32_t iconSize)
+{
+    _art.setColorDepth(16);
+    if (!_art.createSprite(artSize, artSize))
+    {
+        log_e("PlayerView: failed to allocate the album art");
+        return false;
+    }
+
+    if (!_play.begin(panel, viewWidth, viewHeight, playBandPixels))
+        return false;
+    _play.add(&_volumeArc, "volume");
+    _play.add(&_playPause, "playPause");
+    _play.add(&_skipPrev, "skipPrev");
+    _play.add(&_skipNext, "skipNext");
+    _play.add(&_artTile, "art");
+    _play.add(&_track, "track");
+    _play.add(&_artist, "artist");
+    _track.setScroll(1000 / labelScrollDelay, labelScrollPause);
+    _artist.setScroll(1000 / labelScrollDelay, labelScrollPause);
+
+    if (!_list.begin(panel, viewWidth, viewHeight, listBandPixels))
+        return false;
+    _list.add(&_listView, "list");
+    _listView.setIconSize(iconSize);
+    return true;
+}
+
+void PlayerView::showPlayback(const PlaybackSnapshot &playing, uint8_t changes)
+{
+    _volumeArc.setValue(playing.volume);
+    if (changes & PlaybackChangedDevice)
+        _volumeArc.setVisible(playing.supportsVolume);
+    if (changes & PlaybackChangedPlayState)
+        _playPause.setPlaying(playing.isPlaying);
+    if (changes & PlaybackChangedTrack)
+        _track.setText(playing.trackName);
+    if (changes & PlaybackChangedArtist)
+        _artist.setText(playing.artistName);
+}
+
+TextListSource::TextListSource(const String *rows, int count)
+{
+    _rows = rows;
+    _count = count;
+}
+
+EntryListSource::EntryListSource(const EntryStore *entries, uint8_t nameField)
+{
+    _entries = entries;
+    _nameField = nameField;
+}
+
+String EntryListSource::rowLabel(int row)
+{
+    return row == 0 ? "<< Back" : _entries->text(row - 1, _nameField);
+}
+
+PlaylistListSource::PlaylistListSource(const EntryStore *playlists, uint8_t nameField, const String *selectedId)
+    : EntryListSource(playlists, nameField)
+{
+    _selectedId = selectedId;
+}
+
+String PlaylistListSource::rowLabel(int row)
+{
+    // 選択中のプレイリストにチェックマーク表示
+    if (row > 0 && _entries->idEquals(row - 1, *_selectedId))
+        return ">> " + String(_entries->text(row - 1, _nameField));
+    return EntryListSource::rowLabel(row);
+}
+
+String PlaylistListSource::headerText(int selectedRow)
+{
+    // トラック数表示 (戻るオプション以外が選択されている場合)
+    if (selectedRow > 0 && (selectedRow - 1) < _entries->size())
+        return String(_entries->value(selectedRow - 1)) + " tracks";
+    return " ";
+}
+
+String PlaylistListSource::placeholderText()
+{
+    return _entries->size() == 0 ? "No playlists found" : "";
+}
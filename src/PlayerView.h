@@ -0,0 +1,109 @@
+#ifndef PLAYERVIEW_H_INCLUDE
+#define PLAYERVIEW_H_INCLUDE
+
+#include "Compositor.h"
+#include "PlayWidgets.h"
+#include "ListView.h"
+#include "EntryStore.h"
+#include "PlaybackSnapshot.h"
+
+/*
+PlayerView holds the two screens of the player: the play screen (volume
+ring, play/pause and skip icons, album art, track and artist labels) and
+the list screen shared by the menu, device and playlist lists. It is
+driven only by playback snapshots and ListSources, so the firmware and
+the host simulator (src/sim) draw the same screens.
+Hold the render lock while changing it.
+*/
+
+#define viewWidth 240
+#define viewHeight 240
+#define playBandPixels (viewWidth * 40)
+#define listBandPixels (viewWidth * 20)
+#define listRowHeight 30
+#define artSize 50
+#define labelScrollDelay 50  // ms per pixel
+#define labelScrollPause 1000
+
+class PlayerView
+{
+public:
+  PlayerView(GlyphCache *glyphs, uint16_t color);
+  boolean begin(LovyanGFX *panel, int32_t iconSize);
+
+  Compositor *playScreen() { return &_play; }
+  Compositor *listScreen() { return &_list; }
+  // Album art shown on the play screen. Call artChanged() after writing it
+  LGFX_Sprite *art() { return &_art; }
+
+  // Play screen. showPlayback() sets the parts in changes (PlaybackChange bits)
+  // and always the volume, which the dial may have moved
+  void showPlayback(const PlaybackSnapshot &playing, uint8_t changes);
+  void setVolume(int volume) { _volumeArc.setValue(volume); }
+  void setVolumeVisible(boolean visible) { _volumeArc.setVisible(visible); }
+  void setPlaying(boolean playing) { _playPause.setPlaying(playing); }
+  void setTrack(const String &track) { _track.setText(track); }
+  void setArtist(const String &artist) { _artist.setText(artist); }
+  void artChanged() { _artTile.invalidate(); }
+
+  // List screen
+  void showList(ListSource *source, int selectedRow) { _listView.setSource(source, selectedRow); }
+  void select(int row) { _listView.setSelected(row); }
+  void listChanged() { _listView.reload(); }
+
+private:
+  LGFX_Sprite _art;
+  Compositor _play;
+  VolumeArcWidget _volumeArc;
+  PlayPauseWidget _playPause;
+  SkipIconWidget _skipPrev;
+  SkipIconWidget _skipNext;
+  ArtTileWidget _artTile;
+  LabelWidget _track;
+  LabelWidget _artist;
+
+  Compositor _list;
+  ListView _listView;
+};
+
+// Fixed rows, e.g. the menu
+class TextListSource : public ListSource
+{
+public:
+  TextListSource(const String *rows, int count);
+  int rowCount() override { return _count; }
+  String rowLabel(int row) override { return _rows[row]; }
+
+private:
+  const String *_rows;
+  int _count;
+};
+
+// Entries of a store below a "<< Back" row. Row n is entry n - 1
+class EntryListSource : public ListSource
+{
+public:
+  EntryListSource(const EntryStore *entries, uint8_t nameField);
+  int rowCount() override { return 1 + _entries->size(); }
+  String rowLabel(int row) override;
+
+protected:
+  const EntryStore *_entries;
+  uint8_t _nameField;
+};
+
+// Playlists with the selected one marked and the track count in the header.
+// The value of each entry is its track count
+class PlaylistListSource : public EntryListSource
+{
+public:
+  PlaylistListSource(const EntryStore *playlists, uint8_t nameField, const String *selectedId);
+  String rowLabel(int row) override;
+  String headerText(int selectedRow) override;
+  String placeholderText() override;
+
+private:
+  const String *_selectedId;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include "Power.h"
+
+PowerManager power;
+
+PowerManager::PowerManager()
+{
+}
+
+// Call from loop()'s task. Clocks in MHz; lowMHz must be at least 80 for WiFi
+void PowerManager::begin(uint32_t lowMHz, uint32_t highMHz)
+{
+    _loopTask = xTaskGetCurrentTaskHandle();
+    _boostMutex = xSemaphoreCreateMutex();
+    _lowMHz = lowMHz;
+    _highMHz = highMHz;
+
+    esp_pm_config_esp32s3_t config;
+    config.max_freq_mhz = highMHz;
+    config.min_freq_mhz = lowMHz;
+    config.light_sleep_enable = true;
+    _lightSleep = esp_pm_configure(&config) == ESP_OK;
+    if (!_lightSleep)
+    {
+        // Built without tickless idle: frequency scaling only
+        config.light_sleep_enable = false;
+    }
+    _managed = _lightSleep || esp_pm_configure(&config) == ESP_OK;
+    if (!_lightSleep)
+    {
+        log_w("Power: no light sleep, the SDK lacks %s", _managed ? "tickless idle" : "the power manager");
+    }
+
+    if (_managed)
+    {
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "awake", &_awakeLock);
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "boost", &_boostLock);
+        esp_pm_lock_acquire(_awakeLock);
+        if (_lightSleep)
+            esp_sleep_enable_gpio_wakeup();
+    }
+    else
+    {
+        setCpuFrequencyMhz(_lowMHz);
+    }
+    log_i("Power: %s, %u-%u MHz", _lightSleep ? "light sleep" : (_managed ? "frequency scaling" : "manual clock"), _lowMHz, _highMHz);
+}
+
+// Pin whose change must end a light sleep. Its interrupt handler must call wakeFromISR()
+void PowerManager::addWakePin(uint8_t pin)
+{
+    if (_wakePinCount < powerMaxWakePins)
+        _wakePins[_wakePinCount++] = pin;
+}
+
+// Block loop() until wake() or timeoutMillis. allowSleep lets the CPU light sleep meanwhile
+void PowerManager::idle(uint32_t timeoutMillis, boolean allowSleep)
+{
+    uint32_t start = millis();
+    boolean sleep = allowSleep && _lightSleep;
+    if (sleep)
+    {
+        armWakePins();
+        esp_pm_lock_release(_awakeLock);
+    }
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMillis));
+    if (sleep)
+    {
+        esp_pm_lock_acquire(_awakeLock);
+        disarmWakePins();
+    }
+    _idleMillis += millis() - start;
+}
+
+void PowerManager::wake()
+{
+    _lastWakeMillis = millis();
+    if (_loopTask)
+        xTaskNotifyGive(_loopTask);
+}
+
+void IRAM_ATTR PowerManager::wakeFromISR()
+{
+    // Back to edge interrupts before the level interrupt fires again
+    portENTER_CRITICAL_ISR(&_mux);
+    restoreWakePins();
+    portEXIT_CRITICAL_ISR(&_mux);
+
+    _lastWakeMillis = millis();
+    _wakeCount++;
+    if (_loopTask)
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_loopTask, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void PowerManager::boost()
+{
+    if (_managed)
+    {
+        esp_pm_lock_acquire(_boostLock);
+        return;
+    }
+    if (!_boostMutex)
+        return;
+    xSemaphoreTake(_boostMutex, portMAX_DELAY);
+    if (_boosts++ == 0)
+        setCpuFrequencyMhz(_highMHz);
+    xSemaphoreGive(_boostMutex);
+}
+
+void PowerManager::unboost()
+{
+    if (_managed)
+    {
+        esp_pm_lock_release(_boostLock);
+        return;
+    }
+    if (!_boostMutex)
+        return;
+    xSemaphoreTake(_boostMutex, portMAX_DELAY);
+    if (--_boosts == 0)
+        setCpuFrequencyMhz(_lowMHz);
+    xSemaphoreGive(_boostMutex);
+}
+
+// Light sleep only wakes on GPIO levels: wake on the level opposite to the current one
+void PowerManager::armWakePins()
+{
+    portENTER_CRITICAL(&_mux);
+    for (int i = 0; i < _wakePinCount; i++)
+    {
+        gpio_num_t pin = (gpio_num_t)_wakePins[i];
+        gpio_wakeup_enable(pin, gpio_get_level(pin) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+    _armed = true;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void PowerManager::disarmWakePins()
+{
+    portENTER_CRITICAL(&_mux);
+    restoreWakePins();
+    portEXIT_CRITICAL(&_mux);
+}
+
+// Must be called with _mux held
+void IRAM_ATTR PowerManager::restoreWakePins()
+{
+    if (!_armed)
+        return;
+    for (int i = 0; i < _wakePinCount; i++)
+    {
+        gpio_wakeup_disable((gpio_num_t)_wakePins[i]);
+        gpio_set_intr_type((gpio_num_t)_wakePins[i], GPIO_INTR_ANYEDGE);
+    }
+    _armed = false;
+}
+
+PowerBoost::PowerBoost()
+{
+    power.boost();
+}
+
+PowerBoost::~PowerBoost()
+{
+    power.unboost();
+}
@@ -0,0 +1,83 @@
+#ifndef POWER_H_INCLUDE
+#define POWER_H_INCLUDE
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <esp_pm.h>
+
+/*
+PowerManager lets loop() block until something happens instead of
+spinning. Input interrupts call wakeFromISR(), other tasks call wake(),
+and idle() returns on the first of those or when the timeout (the next
+deadline) passes. The CPU runs at the low clock and is raised to the
+high clock only inside a PowerBoost scope (JPEG decode, TLS).
+With the ESP-IDF power manager available, the clock is scaled by it and
+idle(..., true) lets it enter light sleep; the wake pins are switched to
+level wakeup for that time. Without it, the clock is set directly.
+Light sleep needs CONFIG_PM_ENABLE and FreeRTOS tickless idle
+(CONFIG_FREERTOS_USE_TICKLESS_IDLE). The prebuilt Arduino-ESP32 SDK of
+platform = espressif32 has no tickless idle, so the stock build gets
+frequency scaling at most, and begin() logs a warning. Light sleep takes
+an ESP-IDF build with both options (framework = arduino, espidf).
+*/
+
+#define powerMaxWakePins 4
+
+class PowerManager
+{
+public:
+  PowerManager();
+  void begin(uint32_t lowMHz, uint32_t highMHz);
+  void addWakePin(uint8_t pin);
+
+  void idle(uint32_t timeoutMillis, boolean allowSleep);
+  void wake();
+  void wakeFromISR();
+  uint32_t lastWakeMillis() { return _lastWakeMillis; }
+
+  void boost();
+  void unboost();
+
+  boolean managed() { return _managed; }
+  boolean lightSleep() { return _lightSleep; }
+  uint32_t idleMillis() { return _idleMillis; }
+  uint32_t wakeCount() { return _wakeCount; }
+
+private:
+  void armWakePins();
+  void disarmWakePins();
+  void restoreWakePins();
+
+  TaskHandle_t _loopTask = nullptr;
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  uint8_t _wakePins[powerMaxWakePins];
+  uint8_t _wakePinCount = 0;
+  volatile boolean _armed = false;
+  volatile uint32_t _lastWakeMillis = 0;
+
+  boolean _managed = false;
+  boolean _lightSleep = false;
+  esp_pm_lock_handle_t _awakeLock = nullptr;
+  esp_pm_lock_handle_t _boostLock = nullptr;
+  SemaphoreHandle_t _boostMutex = nullptr;
+  int _boosts = 0;
+  uint32_t _lowMHz = 80;
+  uint32_t _highMHz = 240;
+
+  uint32_t _idleMillis = 0;
+  volatile uint32_t _wakeCount = 0;
+};
+
+// Keeps the high CPU clock for its lifetime
+class PowerBoost
+{
+public:
+  PowerBoost();
+  ~PowerBoost();
+};
+
+extern PowerManager power;
+
+#endif
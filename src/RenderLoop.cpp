@@ -0,0 +1,109 @@
+#include "RenderLoop.h"
+#include "MemoryBudget.h"
+
+#define renderTaskStack 6144
+
+RenderLoop::RenderLoop()
+{
+}
+
+// Start the render task. It should run above loop() so network waits never delay a frame
+void RenderLoop::begin(uint32_t framesPerSecond, UBaseType_t priority, BaseType_t core)
+{
+    _periodMicros = 1000000 / framesPerSecond;
+    _lock = xSemaphoreCreateRecursiveMutex();
+    xTaskCreatePinnedToCore(renderTask, "render", renderTaskStack, this, priority, &_task, core);
+}
+
+// Switch the compositor shown on the panel. Waits for the frame in flight
+void RenderLoop::setActive(Compositor *compositor)
+{
+    lock();
+    _active = compositor;
+    if (compositor)
+        compositor->invalidateAll();
+    unlock();
+}
+
+void RenderLoop::setProfiler(RenderProfiler *profiler)
+{
+    lock();
+    _profiler = profiler;
+    unlock();
+}
+
+void RenderLoop::lock()
+{
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+}
+
+// Widget state may have changed: wake the render task if it sleeps
+void RenderLoop::unlock()
+{
+    xSemaphoreGiveRecursive(_lock);
+    if (_task && xTaskGetCurrentTaskHandle() != _task)
+        xTaskNotifyGive(_task);
+}
+
+void RenderLoop::renderTask(void *param)
+{
+    ((RenderLoop *)param)->renderLoop();
+}
+
+// Frame pacing clock: wake every period, tick animations, push what changed
+void RenderLoop::renderLoop()
+{
+    MemoryScope memory(MemoryUI);
+    TickType_t period = max((TickType_t)1, (TickType_t)pdMS_TO_TICKS(_periodMicros / 1000));
+    TickType_t lastWake = xTaskGetTickCount();
+
+    while (true)
+    {
+        if (_animating)
+        {
+            vTaskDelayUntil(&lastWake, period);
+        }
+        else
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            lastWake = xTaskGetTickCount();
+        }
+
+        uint32_t start = micros();
+        lock();
+        if (_active)
+        {
+            uint32_t tickStart = micros();
+            _active->tick(millis());
+            uint32_t tickMicros = micros() - tickStart;
+            if (_active->isDirty())
+            {
+                if (_profiler)
+                {
+                    _profiler->beginFrame(_active);
+                    _profiler->ticked(tickMicros);
+                }
+                _active->setProfiler(_profiler);
+                uint32_t pixels = _active->render();
+                if (pixels > 0 && !_firstPixelMillis)
+                    _firstPixelMillis = millis();
+                if (_profiler)
+                {
+                    uint32_t frameMicros = micros() - start;
+                    _profiler->endFrame(frameMicros, pixels, frameMicros > _periodMicros);
+                }
+            }
+        }
+        // Keep the frame clock while something moves or is left dirty
+        _animating = _active && (_active->animating() || _active->isDirty());
+        unlock();
+
+        uint32_t elapsed = micros() - start;
+        _lastFrameMicros = elapsed;
+        if (elapsed > _maxFrameMicros)
+            _maxFrameMicros = elapsed;
+        if (elapsed > _periodMicros)
+            _missedFrames++;
+        _frameCount++;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef RENDERLOOP_H_INCLUDE
+#define RENDERLOOP_H_INCLUDE
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "Compositor.h"
+#include "RenderProfiler.h"
+
+/*
+RenderLoop owns the panel from a dedicated task. At a fixed frame rate it
+ticks the active compositor's animations and pushes its dirty area, so
+the UI keeps moving while loop() is blocked in HTTP.
+Other tasks must hold lock() while they change widget state, and
+setActive(nullptr) before drawing to the display directly.
+When nothing animates and nothing is dirty the task sleeps until the
+next unlock(), so an idle screen costs no CPU wakeups.
+*/
+
+class RenderLoop
+{
+public:
+  RenderLoop();
+  void begin(uint32_t framesPerSecond, UBaseType_t priority, BaseType_t core);
+
+  void setActive(Compositor *compositor);
+  Compositor *active() { return _active; }
+
+  void lock();
+  void unlock();
+
+  boolean animating() { return _animating; }
+  // Record every rendered frame into profiler
+  void setProfiler(RenderProfiler *profiler);
+
+  uint32_t frameCount() { return _frameCount; }
+  uint32_t missedFrames() { return _missedFrames; }
+  uint32_t lastFrameMicros() { return _lastFrameMicros; }
+  uint32_t maxFrameMicros() { return _maxFrameMicros; }
+  uint32_t framePeriodMicros() { return _periodMicros; }
+  // millis() when the first frame reached the panel, 0 before that
+  uint32_t firstPixelMillis() { return _firstPixelMillis; }
+  TaskHandle_t taskHandle() { return _task; }
+
+private:
+  static void renderTask(void *param);
+  void renderLoop();
+
+  Compositor *_active = nullptr;
+  RenderProfiler *_profiler = nullptr;
+  SemaphoreHandle_t _lock = nullptr;
+  TaskHandle_t _task = nullptr;
+  uint32_t _periodMicros = 0;
+
+  volatile uint32_t _frameCount = 0;
+  volatile uint32_t _missedFrames = 0;
+  volatile uint32_t _lastFrameMicros = 0;
+  volatile uint32_t _maxFrameMicros = 0;
+  volatile uint32_t _firstPixelMillis = 0;
+  volatile boolean _animating = false;
+};
+
+#endif
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include "RenderProfiler.h"
+#include "Compositor.h"
+
+RenderProfiler::RenderProfiler()
+{
+}
+
+// Allocate the ring. Returns false outside the render-profile build or when out of memory
+boolean RenderProfiler::begin()
+{
+#ifdef RENDER_PROFILE
+    _frames = (Frame *)calloc(profilerFrames, sizeof(Frame));
+    _samples = (uint32_t *)malloc(profilerFrames * sizeof(uint32_t));
+    if (!_frames || !_samples)
+    {
+        log_e("RenderProfiler: failed to allocate %u frames", profilerFrames);
+        free(_frames);
+        free(_samples);
+        _frames = nullptr;
+        _samples = nullptr;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RenderProfiler::beginFrame(Compositor *compositor)
+{
+    if (!_frames)
+        return;
+    _current = &_frames[_next];
+    memset(_current, 0, sizeof(Frame));
+    _current->compositor = compositor;
+    _composing = 0;
+    _inFlight = false;
+}
+
+void RenderProfiler::ticked(uint32_t micros)
+{
+    if (_current)
+        _current->tickMicros = micros;
+}
+
+void RenderProfiler::bandStarted()
+{
+    memset(_bandPixels[_composing], 0, sizeof(_bandPixels[_composing]));
+}
+
+void RenderProfiler::widgetDrawn(int index, uint32_t micros, uint32_t pixels)
+{
+    if (!_current || index >= profilerMaxWidgets)
+        return;
+    WidgetSample &sample = _current->widgets[index];
+    sample.drawMicros = min((uint32_t)UINT16_MAX, sample.drawMicros + micros);
+    sample.pixels = min((uint32_t)UINT16_MAX, sample.pixels + pixels);
+    _bandPixels[_composing][index] = min((uint32_t)UINT16_MAX, _bandPixels[_composing][index] + pixels);
+}
+
+// Time blocked on the band on the wire: after pushing the composed band
+// (which waits for the previous one) or in the final wait (lastBand)
+void RenderProfiler::transferWaited(uint32_t micros, boolean lastBand)
+{
+    if (!_current)
+        return;
+    _current->transferMicros += micros;
+
+    if (_inFlight)
+    {
+        const uint16_t *covered = _bandPixels[_composing ^ 1];
+        uint32_t total = 0;
+        for (int i = 0; i < profilerMaxWidgets; i++)
+            total += covered[i];
+        for (int i = 0; total && i < profilerMaxWidgets; i++)
+        {
+            WidgetSample &sample = _current->widgets[i];
+            sample.transferMicros = min((uint32_t)UINT16_MAX, sample.transferMicros + micros * covered[i] / total);
+        }
+    }
+
+    if (lastBand)
+    {
+        _inFlight = false;
+    }
+    else
+    {
+        // The band just pushed is now on the wire; compose the next one into the other slot
+        _composing ^= 1;
+        _inFlight = true;
+    }
+}
+
+void RenderProfiler::endFrame(uint32_t frameMicros, uint32_t pixels, boolean missed)
+{
+    if (!_current)
+        return;
+    _current->frameMicros = frameMicros;
+    _current->pixels = pixels;
+    _current->missed = missed;
+    _current = nullptr;
+    _next = (_next + 1) % profilerFrames;
+    if (_count < profilerFrames)
+        _count++;
+}
+
+void RenderProfiler::reset()
+{
+    _current = nullptr;
+    _next = 0;
+    _count = 0;
+}
+
+boolean RenderProfiler::enabled()
+{
+#ifdef RENDER_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+static uint32_t frameTime(const RenderProfiler::Frame &frame, int widget) { return frame.frameMicros; }
+static uint32_t tickTime(const RenderProfiler::Frame &frame, int widget) { return frame.tickMicros; }
+static uint32_t transferTime(const RenderProfiler::Frame &frame, int widget) { return frame.transferMicros; }
+static uint32_t framePixels(const RenderProfiler::Frame &frame, int widget) { return frame.pixels; }
+
+// What is left of the frame after ticking and waiting for the bus: fills and widget draws
+static uint32_t composeTime(const RenderProfiler::Frame &frame, int widget)
+{
+    uint32_t other = frame.tickMicros + frame.transferMicros;
+    return frame.frameMicros > other ? frame.frameMicros - other : 0;
+}
+
+static uint32_t widgetDrawTime(const RenderProfiler::Frame &frame, int widget) { return frame.widgets[widget].drawMicros; }
+static uint32_t widgetPixels(const RenderProfiler::Frame &frame, int widget) { return frame.widgets[widget].pixels; }
+static uint32_t widgetTransferTime(const RenderProfiler::Frame &frame, int widget) { return frame.widgets[widget].transferMicros; }
+
+// Frame summaries, then per compositor the widgets that were drawn.
+// Times are in microseconds; a widget's samples only count frames that drew it
+void RenderProfiler::print(Print &out)
+{
+    if (!_frames || !_count)
+        return;
+
+    uint32_t missed = 0;
+    for (int i = 0; i < _count; i++)
+        missed += _frames[i].missed;
+    out.printf("render: %d frames, %u missed\n", _count, missed);
+    printSummary(out, "frame us", nullptr, -1, frameTime);
+    printSummary(out, "tick us", nullptr, -1, tickTime);
+    printSummary(out, "compose us", nullptr, -1, composeTime);
+    printSummary(out, "transfer us", nullptr, -1, transferTime);
+    printSummary(out, "pixels", nullptr, -1, framePixels);
+
+    for (int i = 0; i < _count; i++)
+    {
+        Compositor *compositor = _frames[i].compositor;
+        boolean seen = false;
+        for (int j = 0; j < i && !seen; j++)
+            seen = _frames[j].compositor == compositor;
+        if (seen || !compositor)
+            continue;
+
+        int widgets = min(compositor->widgetCount(), profilerMaxWidgets);
+        for (int widget = 0; widget < widgets; widget++)
+        {
+            const char *name = compositor->widgetName(widget);
+            out.printf("%s:\n", name);
+            printSummary(out, "  draw us", compositor, widget, widgetDrawTime);
+            printSummary(out, "  pixels", compositor, widget, widgetPixels);
+            printSummary(out, "  transfer us", compositor, widget, widgetTransferTime);
+        }
+    }
+}
+
+// One line: count, min, avg, p99 and max of metric over the matching frames
+void RenderProfiler::printSummary(Print &out, const char *name, Compositor *compositor, int widget, Metric metric)
+{
+    int count = 0;
+    uint64_t sum = 0;
+    for (int i = 0; i < _count; i++)
+    {
+        const Frame &frame = _frames[i];
+        if (widget >= 0 && (frame.compositor != compositor || !frame.widgets[widget].pixels))
+            continue;
+        uint32_t value = metric(frame, widget);
+        _samples[count++] = value;
+        sum += value;
+    }
+    if (!count)
+    {
+        out.printf("%s: n=0\n", name);
+        return;
+    }
+
+    std::sort(_samples, _samples + count);
+    int p99 = (count * 99 + 99) / 100 - 1;
+    out.printf("%s: n=%d min=%u avg=%u p99=%u max=%u\n", name, count, _samples[0], (uint32_t)(sum / count),
+               _samples[p99], _samples[count - 1]);
+}
@@ -0,0 +1,79 @@
+#ifndef RENDERPROFILER_H_INCLUDE
+#define RENDERPROFILER_H_INCLUDE
+
+#include <Arduino.h>
+
+/*
+RenderProfiler keeps the last profilerFrames rendered frames in a ring:
+frame time, tick time, compose time (CPU), transfer wait (time blocked on
+the SPI DMA), pixels pushed, and per widget the draw time, the pixels it
+covered and its share of the transfer wait. A band's wait is split over
+the widgets in that band by covered pixels, since one transfer carries
+them all. print() writes min/avg/p99 of each over the frames in the ring.
+It works in the render-profile build environment (RENDER_PROFILE);
+otherwise nothing is allocated and the render path skips all timing.
+*/
+
+#define profilerFrames 128
+#define profilerMaxWidgets 8
+
+class Compositor;
+
+class RenderProfiler
+{
+public:
+  // One rendered frame as kept in the ring. Widgets are indexed in compositor order
+  struct WidgetSample
+  {
+    uint16_t drawMicros;
+    uint16_t pixels;
+    uint16_t transferMicros;
+  };
+
+  struct Frame
+  {
+    Compositor *compositor;
+    uint32_t frameMicros;
+    uint32_t tickMicros;
+    uint32_t transferMicros;
+    uint32_t pixels;
+    boolean missed;
+    WidgetSample widgets[profilerMaxWidgets];
+  };
+
+  RenderProfiler();
+  boolean begin();
+
+  // Called by the render task, with the render lock held
+  void beginFrame(Compositor *compositor);
+  void ticked(uint32_t micros);
+  void bandStarted();
+  void widgetDrawn(int index, uint32_t micros, uint32_t pixels);
+  void transferWaited(uint32_t micros, boolean lastBand);
+  void endFrame(uint32_t frameMicros, uint32_t pixels, boolean missed);
+
+  // Call with the render lock held
+  void print(Print &out);
+  void reset();
+  uint32_t frames() { return _count; }
+
+  static boolean enabled();
+
+private:
+  typedef uint32_t (*Metric)(const Frame &frame, int widget);
+
+  void printSummary(Print &out, const char *name, Compositor *compositor, int widget, Metric metric);
+
+  Frame *_frames = nullptr;
+  Frame *_current = nullptr;
+  int _next = 0;
+  int _count = 0;
+  uint32_t *_samples = nullptr;
+
+  // Covered pixels of each widget in the band being composed and in the one on the wire
+  uint16_t _bandPixels[2][profilerMaxWidgets];
+  int _composing = 0;
+  boolean _inFlight = false;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef REQUESTBUILDER_H_INCLUDE
+#define REQUESTBUILDER_H_INCLUDE
+
+#include <Arduino.h>
+
+/*
+RequestBuilder writes a URL or request body into a fixed buffer, usually
+on the stack, instead of concatenating Strings. It never allocates; text
+that does not fit is dropped and overflowed() turns true.
+*/
+
+template <size_t Capacity>
+class RequestBuilder
+{
+public:
+  RequestBuilder() { reset(); }
+
+  void reset()
+  {
+    _length = 0;
+    _buffer[0] = 0;
+    _overflowed = false;
+  }
+
+  RequestBuilder &add(const char *text)
+  {
+    size_t length = strlen(text);
+    if (_length + length >= Capacity)
+    {
+      _overflowed = true;
+      return *this;
+    }
+    memcpy(_buffer + _length, text, length + 1);
+    _length += length;
+    return *this;
+  }
+
+  RequestBuilder &add(const String &text) { return add(text.c_str()); }
+
+  RequestBuilder &add(long value)
+  {
+    char digits[12];
+    char *cursor = digits + sizeof(digits) - 1;
+    *cursor = 0;
+    unsigned long magnitude = value < 0 ? -(unsigned long)value : value;
+    do
+    {
+      *--cursor = '0' + magnitude % 10;
+      magnitude /= 10;
+    } while (magnitude);
+    if (value < 0)
+      *--cursor = '-';
+    return add(cursor);
+  }
+
+  RequestBuilder &add(int value) { return add((long)value); }
+
+  const char *c_str() const { return _buffer; }
+  uint8_t *bytes() { return (uint8_t *)_buffer; }
+  size_t length() const { return _length; }
+  boolean overflowed() const { return _overflowed; }
+
+private:
+  char _buffer[Capacity];
+  size_t _length;
+  boolean _overflowed;
+};
+
+#endif
@@ -0,0 +1,259 @@
+#include <WiFi.h>
+#include "RequestTrace.h"
+
+#define traceHostBytes 64
+
+static const uint32_t traceBucketLimits[traceBuckets] = {5, 10, 25, 50, 100, 250, 500, 1000, 2500, 0xFFFFFFFF};
+
+static const char *const traceEndpointNames[TraceEndpointCount] = {
+    "/api/token", "/me/player", "/me/player/volume", "/me/player/play", "/me/player/pause",
+    "/me/player/next", "/me/player/previous", "/me/player/devices", "/me/playlists", "other"};
+
+static const char *const tracePhaseNames[TracePhaseCount] = {"dns", "connect", "first_byte", "body", "parse", "total"};
+
+#ifdef REQUEST_TRACE
+static uint32_t traceCounts[TraceEndpointCount][TracePhaseCount][traceBuckets];
+static uint32_t traceSums[TraceEndpointCount][TracePhaseCount];
+static uint32_t traceErrors[TraceEndpointCount];
+#endif
+
+// Keep the body's read timeout, so the traced build waits like the untraced one
+void TimedStream::begin(Stream *stream)
+{
+    _stream = stream;
+    setTimeout(stream->getTimeout());
+    _waitStart = 0;
+    _waitMicros = 0;
+}
+
+int TimedStream::available()
+{
+    int count = _stream->available();
+    account(count > 0);
+    return count;
+}
+
+int TimedStream::read()
+{
+    int data = _stream->read();
+    account(data >= 0);
+    return data;
+}
+
+int TimedStream::peek()
+{
+    int data = _stream->peek();
+    account(data >= 0);
+    return data;
+}
+
+size_t TimedStream::write(uint8_t data)
+{
+    return _stream->write(data);
+}
+
+// A wait runs from the first call that found no data to the next one that did
+void TimedStream::account(boolean gotData)
+{
+    if (!gotData)
+    {
+        if (!_waitStart)
+            _waitStart = micros() | 1;
+    }
+    else if (_waitStart)
+    {
+        _waitMicros += micros() - _waitStart;
+        _waitStart = 0;
+    }
+}
+
+RequestTrace::RequestTrace(const char *url)
+{
+    _url = url;
+#ifdef REQUEST_TRACE
+    _endpoint = endpointOf(url);
+    _start = micros();
+#endif
+}
+
+RequestTrace::~RequestTrace()
+{
+    if (!_finished)
+        finish(0);
+}
+
+// Resolve and connect before the request, so both can be timed.
+// HTTPClient then reuses the open connection
+void RequestTrace::connect(TracedHTTPClient &http)
+{
+#ifdef REQUEST_TRACE
+    const char *host = strstr(_url, "://");
+    host = host ? host + 3 : _url;
+    char name[traceHostBytes];
+    size_t length = strcspn(host, "/:");
+    length = min(length, sizeof(name) - 1);
+    memcpy(name, host, length);
+    name[length] = '\0';
+
+    // The result stays in the lwIP cache, so the lookup in connect() is instant
+    IPAddress address;
+    uint32_t resolveStart = micros();
+    WiFi.hostByName(name, address);
+    uint32_t resolved = micros();
+    record(TracePhaseDNS, resolved - resolveStart);
+
+    http.connect();
+    _connected = micros();
+    record(TracePhaseConnect, _connected - resolved);
+#endif
+}
+
+void RequestTrace::firstByte()
+{
+#ifdef REQUEST_TRACE
+    _firstByte = micros();
+    record(TracePhaseFirstByte, _firstByte - (_connected ? _connected : _start));
+#endif
+}
+
+Stream *RequestTrace::body(Stream *stream)
+{
+#ifdef REQUEST_TRACE
+    _hasBody = true;
+    _stream.begin(stream);
+    return &_stream;
+#else
+    return stream;
+#endif
+}
+
+// Record body, parse and total times. result is the HTTP status or HTTPClient error
+void RequestTrace::finish(int result)
+{
+    _finished = true;
+#ifdef REQUEST_TRACE
+    uint32_t now = micros();
+    if (_hasBody && _firstByte)
+    {
+        uint32_t wait = _stream.waitMicros();
+        uint32_t handling = now - _firstByte;
+        record(TracePhaseBody, wait);
+        record(TracePhaseParse, handling > wait ? handling - wait : 0);
+    }
+    record(TracePhaseTotal, now - _start);
+    if (result < 200 || result >= 300)
+        traceErrors[_endpoint]++;
+#endif
+}
+
+boolean RequestTrace::enabled()
+{
+#ifdef REQUEST_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *RequestTrace::endpointName(int endpoint)
+{
+    return traceEndpointNames[endpoint];
+}
+
+const char *RequestTrace::phaseName(int phase)
+{
+    return tracePhaseNames[phase];
+}
+
+// Upper limit of bucket in ms, 0xFFFFFFFF for the last one
+uint32_t RequestTrace::bucketLimit(int bucket)
+{
+    return traceBucketLimits[bucket];
+}
+
+uint32_t RequestTrace::bucketCount(int endpoint, int phase, int bucket)
+{
+#ifdef REQUEST_TRACE
+    return traceCounts[endpoint][phase][bucket];
+#else
+    return 0;
+#endif
+}
+
+uint32_t RequestTrace::sumMillis(int endpoint, int phase)
+{
+#ifdef REQUEST_TRACE
+    return traceSums[endpoint][phase];
+#else
+    return 0;
+#endif
+}
+
+uint32_t RequestTrace::errors(int endpoint)
+{
+#ifdef REQUEST_TRACE
+    return traceErrors[endpoint];
+#else
+    return 0;
+#endif
+}
+
+// One line per endpoint and phase that has samples: count, mean and bucket counts
+void RequestTrace::print(Print &out)
+{
+    for (int endpoint = 0; endpoint < TraceEndpointCount; endpoint++)
+    {
+        for (int phase = 0; phase < TracePhaseCount; phase++)
+        {
+            uint32_t count = 0;
+            for (int bucket = 0; bucket < traceBuckets; bucket++)
+                count += bucketCount(endpoint, phase, bucket);
+            if (!count)
+                continue;
+
+            out.printf("%s %s: n=%u mean=%ums |", endpointName(endpoint), phaseName(phase), count, sumMillis(endpoint, phase) / count);
+            for (int bucket = 0; bucket < traceBuckets; bucket++)
+                out.printf(" %u", bucketCount(endpoint, phase, bucket));
+            out.printf(" | errors=%u\n", errors(endpoint));
+        }
+    }
+}
+
+// The endpoint whose path matches the most of url. Query strings are ignored
+TraceEndpoint RequestTrace::endpointOf(const char *url)
+{
+    const char *path = strstr(url, "://");
+    path = path ? strchr(path + 3, '/') : url;
+    if (!path)
+        return TraceEndpointOther;
+
+    int best = TraceEndpointOther;
+    size_t bestLength = 0;
+    for (int endpoint = 0; endpoint < TraceEndpointOther; endpoint++)
+    {
+        const char *name = traceEndpointNames[endpoint];
+        size_t length = strlen(name);
+        const char *start = strstr(path, name);
+        if (!start || length <= bestLength)
+            continue;
+        char next = start[length];
+        if (next == '\0' || next == '?' || next == '/')
+        {
+            best = endpoint;
+            bestLength = length;
+        }
+    }
+    return (TraceEndpoint)best;
+}
+
+void RequestTrace::record(TracePhase phase, uint32_t elapsedMicros)
+{
+#ifdef REQUEST_TRACE
+    uint32_t elapsedMillis = elapsedMicros / 1000;
+    int bucket = 0;
+    while (elapsedMillis > traceBucketLimits[bucket])
+        bucket++;
+    traceCounts[_endpoint][phase][bucket]++;
+    traceSums[_endpoint][phase] += elapsedMillis;
+#endif
+}
@@ -0,0 +1,109 @@
+#ifndef REQUESTTRACE_H_INCLUDE
+#define REQUESTTRACE_H_INCLUDE
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+
+/*
+RequestTrace times the phases of one SPClient request: DNS lookup,
+connect (TCP and TLS handshake together, WiFiClientSecure does both in
+one call), time to first byte, body transfer (time spent waiting for
+data) and parse (the rest of the body handling). Call finish() before
+HTTPClient::end(), so closing the connection is not timed. The body
+stream keeps the client's read timeout. On destruction the
+phases go into fixed-bucket histograms per endpoint, kept in static
+arrays, so memory does not grow with the number of requests.
+It works in the request-trace build environment (REQUEST_TRACE);
+otherwise every call returns at once and body() passes the stream through.
+*/
+
+typedef enum
+{
+  TracePhaseDNS = 0,
+  TracePhaseConnect,
+  TracePhaseFirstByte,
+  TracePhaseBody,
+  TracePhaseParse,
+  TracePhaseTotal,
+  TracePhaseCount
+} TracePhase;
+
+typedef enum
+{
+  TraceEndpointToken = 0,
+  TraceEndpointPlayer,
+  TraceEndpointVolume,
+  TraceEndpointPlay,
+  TraceEndpointPause,
+  TraceEndpointNext,
+  TraceEndpointPrevious,
+  TraceEndpointDevices,
+  TraceEndpointPlaylists,
+  TraceEndpointOther,
+  TraceEndpointCount
+} TraceEndpoint;
+
+#define traceBuckets 10  // the last one has no upper limit
+
+// Makes HTTPClient::connect() callable, so the connection can be timed before the request
+class TracedHTTPClient : public HTTPClient
+{
+public:
+  using HTTPClient::connect;
+};
+
+// Stream that adds up the time read() calls wait for data
+class TimedStream : public Stream
+{
+public:
+  void begin(Stream *stream);
+  uint32_t waitMicros() { return _waitMicros; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t data) override;
+
+private:
+  void account(boolean gotData);
+
+  Stream *_stream = nullptr;
+  uint32_t _waitStart = 0;
+  uint32_t _waitMicros = 0;
+};
+
+class RequestTrace
+{
+public:
+  RequestTrace(const char *url);
+  ~RequestTrace();
+
+  void connect(TracedHTTPClient &http);
+  void firstByte();
+  Stream *body(Stream *stream);
+  void finish(int result);
+
+  static boolean enabled();
+  static const char *endpointName(int endpoint);
+  static const char *phaseName(int phase);
+  static uint32_t bucketLimit(int bucket);
+  static uint32_t bucketCount(int endpoint, int phase, int bucket);
+  static uint32_t sumMillis(int endpoint, int phase);
+  static uint32_t errors(int endpoint);
+  static void print(Print &out);
+
+private:
+  static TraceEndpoint endpointOf(const char *url);
+  void record(TracePhase phase, uint32_t elapsedMicros);
+
+  const char *_url;
+  TraceEndpoint _endpoint = TraceEndpointOther;
+  uint32_t _start = 0;
+  uint32_t _connected = 0;
+  uint32_t _firstByte = 0;
+  boolean _hasBody = false;
+  boolean _finished = false;
+  TimedStream _stream;
+};
+
+#endif
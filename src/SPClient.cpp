@@ -3,9 +3,24 @@
 #include <UrlEncode.h>
 #include "JsonStreamScanner.h"
 #include "SPClient.h"
+#include "RequestBuilder.h"
+#include "AllocCounter.h"
+#include "Power.h"
+#include "RequestTrace.h"
+#include "MemoryBudget.h"
+#include "Trace.h"
 
 #define authRedirectURL "https://sgrastar.github.io/M5DialPlay/"
-#define authtokenURL "https://accounts.spotify.com/api/token"
+#define spotifyApiBase "https://api.spotify.com"
+#define spotifyAccountsBase "https://accounts.spotify.com"
+#define authtokenPath "/api/token"
+#define playerPath "/v1/me/player"
+#define commandURLBytes 128
+#define commandBodyBytes 128
+
+// Header names longer than the String inline buffer, built once
+static const String authorizationKey = "Authorization";
+static const String contentLengthKey = "Content-Length";
 
 // Generate random 64 characters
 String randomString64()
@@ -49,8 +64,19 @@ String SHA256HashInBase64(String source)
     return result;
 }
 
-SPClient::SPClient()
+SPClient::SPClient() : devices(0, DeviceFieldCount), playlists(playlistIdLength, PlaylistFieldCount)
+{
+    devices.begin(deviceCapacity, deviceArenaBytes);
+    playlists.begin(playlistCapacity, playlistArenaBytes);
+    setBaseURLs(nullptr, nullptr);
+}
+
+// Send API and token requests to other servers, e.g. tools/replay.py.
+// nullptr restores Spotify. http:// bases are used without TLS
+void SPClient::setBaseURLs(const char *apiBase, const char *accountsBase)
 {
+    _apiBase = apiBase ? apiBase : spotifyApiBase;
+    _accountsBase = accountsBase ? accountsBase : spotifyAccountsBase;
 }
 
 // Generate code verifier and return authentication URL
@@ -81,16 +107,24 @@ int SPClient::requestAccessToken(String code)
     payload += "&client_id=" + urlEncode(clientID);
     payload += "&code_verifier=" + urlEncode(codeVerifier);
 
-    httpClient.begin(authtokenURL, SpotifyPEM);
+    PowerBoost boost;
+    MemoryScope memory(MemoryClient);
+    RequestBuilder<commandURLBytes> url;
+    url.add(_accountsBase).add(authtokenPath);
+    RequestTrace trace(url.c_str());
+    beginRequest(url.c_str());
     httpClient.addHeader("Content-Type", "application/x-www-form-urlencoded");
     const char *headerKeys[] = {"Transfer-Encoding"};
     httpClient.collectHeaders(headerKeys, 1);
+    trace.connect(httpClient);
     int result = httpClient.POST(payload);
+    trace.firstByte();
     if (result == HTTP_CODE_OK)
     {
         boolean chunked = (httpClient.header("Transfer-Encoding") == "chunked");
         WiFiClient *stream = httpClient.getStreamPtr();
-        JsonStreamScanner scanner = JsonStreamScanner(stream, chunked);
+        MemoryScope parsing(MemoryParser);
+        JsonStreamScanner scanner(trace.body(stream), chunked);
         while (scanner.available())
         {
             String path = scanner.scanNextKey();
@@ -112,6 +146,7 @@ int SPClient::requestAccessToken(String code)
     {
         log_e("Error: %d, %s", result, httpClient.getString().c_str());
     }
+    trace.finish(result);
     httpClient.end();
     return result;
 }
@@ -125,17 +160,25 @@ int SPClient::refreshAccessToken()
     payload += "&refresh_token=" + urlEncode(refreshToken);
     payload += "&client_id=" + urlEncode(clientID);
 
-    httpClient.begin(authtokenURL, SpotifyPEM);
+    PowerBoost boost;
+    MemoryScope memory(MemoryClient);
+    RequestBuilder<commandURLBytes> url;
+    url.add(_accountsBase).add(authtokenPath);
+    RequestTrace trace(url.c_str());
+    beginRequest(url.c_str());
     httpClient.addHeader("Content-Type", "application/x-www-form-urlencoded");
     const char *headerKeys[] = {"Transfer-Encoding"};
     httpClient.collectHeaders(headerKeys, 1);
+    trace.connect(httpClient);
     int result = httpClient.POST(payload);
+    trace.firstByte();
     if (result == HTTP_CODE_OK)
     {
         boolean chunked = (httpClient.header("Transfer-Encoding") == "chunked");
         accessToken = "";
         WiFiClient *stream = httpClient.getStreamPtr();
-        JsonStreamScanner scanner = JsonStreamScanner(stream, chunked);
+        MemoryScope parsing(MemoryParser);
+        JsonStreamScanner scanner(trace.body(stream), chunked);
         while (scanner.available())
         {
             String path = scanner.scanNextKey();
@@ -150,6 +193,7 @@ int SPClient::refreshAccessToken()
         }
         needsRefresh = false;
     }
+    trace.finish(result);
     httpClient.end();
     return result;
 }
@@ -157,88 +201,90 @@ int SPClient::refreshAccessToken()
 // Get current playback state
 int SPClient::getPlaybackState()
 {
-    deviceID = "";
-    artistName = "";
-    trackName = "";
-    imageURL = "";
-    duration_ms = 0;
-    progress_ms = 0;
-    volume = 0;
-    supportsVolume = false;
-    isPlaying = false;
+    // Filled off to the side, readers keep seeing the last published state
+    _fetched.clear();
 
     if (accessToken.length() == 0)
+    {
+        playback.publish(_fetched);
         return 0;
-    httpClient.begin("https://api.spotify.com/v1/me/player", SpotifyPEM);
-    httpClient.addHeader("Authorization", "Bearer " + accessToken);
+    }
+    PowerBoost boost;
+    MemoryScope memory(MemoryClient);
+    RequestBuilder<commandURLBytes> url;
+    url.add(_apiBase).add(playerPath);
+    RequestTrace trace(url.c_str());
+    beginRequest(url.c_str());
+    httpClient.addHeader(authorizationKey, authorization());
     const char *headerKeys[] = {"Transfer-Encoding"};
     httpClient.collectHeaders(headerKeys, 1);
+    trace.connect(httpClient);
     int result = httpClient.GET();
+    trace.firstByte();
     if (result == HTTP_CODE_OK)
     {
         boolean chunked = (httpClient.header("Transfer-Encoding") == "chunked");
         WiFiClient *stream = httpClient.getStreamPtr();
-        JsonStreamScanner scanner = JsonStreamScanner(stream, chunked);
+        MemoryScope parsing(MemoryParser);
+        JsonStreamScanner scanner(trace.body(stream), chunked);
         while (scanner.available())
         {
             String path = scanner.scanNextKey();
             if (path == "/device/id")
             {
-                deviceID = scanner.scanString();
+                scanner.scanString(_fetched.deviceID, sizeof(_fetched.deviceID));
             }
             else if (path == "/device/volume_percent")
             {
-                volume = scanner.scanInt();
+                _fetched.volume = scanner.scanInt();
             }
             else if (path == "/device/supports_volume")
             {
-                supportsVolume = scanner.scanBoolean();
+                _fetched.supportsVolume = scanner.scanBoolean();
             }
             else if (path == "/progress_ms")
             {
-                progress_ms = scanner.scanInt();
+                _fetched.progressMillis = scanner.scanInt();
             }
             else if (path == "/is_playing")
             {
-                isPlaying = scanner.scanBoolean();
+                _fetched.isPlaying = scanner.scanBoolean();
             }
             else if (path == "/item/artists/name")
             {
-                //artistName = scanner.scanString();
-                String currentArtist = scanner.scanString();
-                if (artistName.length() > 0) {
-                    artistName += ", " + currentArtist;
-                } else {
-                    artistName = currentArtist;
-                }
+                char currentArtist[snapshotTextBytes];
+                scanner.scanString(currentArtist, sizeof(currentArtist));
+                PlaybackSnapshot::appendText(_fetched.artistName, sizeof(_fetched.artistName), ", ", currentArtist);
             }
             else if (path == "/item/duration_ms")
             {
-                duration_ms = scanner.scanInt();
+                _fetched.durationMillis = scanner.scanInt();
             }
             else if (path == "/item/name")
             {
-                trackName = scanner.scanString();
+                scanner.scanString(_fetched.trackName, sizeof(_fetched.trackName));
             }
             else if (path == "/item/album/images/url")
             {
-                imageURL = scanner.scanString();
-                log_e("Image URL from API: %s", imageURL.c_str());
+                scanner.scanString(_fetched.imageURL, sizeof(_fetched.imageURL));
+                trace_text(traceLevelDebug, traceHttp, "player image %s", _fetched.imageURL);
             }
         }
     }
     else if (result == HTTP_CODE_NO_CONTENT){
-        log_i("No active playback state");
+        trace_i(traceHttp, "player: no active playback");
         
         // 必要に応じて、デフォルトまたは代替情報を設定
-        trackName = "No track playing";
-        artistName = "Select a playlist to play";
+        PlaybackSnapshot::copyText(_fetched.trackName, sizeof(_fetched.trackName), "No track playing");
+        PlaybackSnapshot::copyText(_fetched.artistName, sizeof(_fetched.artistName), "Select a playlist to play");
     }
     else
     {
         log_e("Error: %d", result);
     }
+    trace.finish(result);
     httpClient.end();
+    playback.publish(_fetched);
     if (result == 401)
         needsRefresh = true;
     return result;
@@ -247,40 +293,33 @@ int SPClient::getPlaybackState()
 // Get device list
 int SPClient::getDeviceList()
 {
-    deviceIDs.clear();
-    deviceNames.clear();
-
-    httpClient.begin("https://api.spotify.com/v1/me/player/devices", SpotifyPEM);
-    httpClient.addHeader("Authorization", "Bearer " + accessToken);
+    devices.reset();
+
+    PowerBoost boost;
+    MemoryScope memory(MemoryClient);
+    RequestBuilder<commandURLBytes> url;
+    url.add(_apiBase).add(playerPath "/devices");
+    RequestTrace trace(url.c_str());
+    beginRequest(url.c_str());
+    httpClient.addHeader(authorizationKey, authorization());
     const char *headerKeys[] = {"Transfer-Encoding"};
     httpClient.collectHeaders(headerKeys, 1);
+    trace.connect(httpClient);
     int result = httpClient.GET();
+    trace.firstByte();
     if (result == HTTP_CODE_OK)
     {
         boolean chunked = (httpClient.header("Transfer-Encoding") == "chunked");
         WiFiClient *stream = httpClient.getStreamPtr();
-        JsonStreamScanner scanner = JsonStreamScanner(stream, chunked);
-        while (scanner.available())
-        {
-            String path = scanner.scanNextKey();
-            if (path == "/devices/id")
-            {
-                String idString = scanner.scanString();
-                if (!idString.isEmpty())
-                    deviceIDs.push_back(idString);
-            }
-            else if (path == "/devices/name")
-            {
-                String nameString = scanner.scanString();
-                if (!nameString.isEmpty())
-                    deviceNames.push_back(nameString);
-            }
-        }
+        MemoryScope parsing(MemoryParser);
+        JsonStreamScanner scanner(trace.body(stream), chunked);
+        parseDeviceList(scanner, devices);
     }
     else
     {
         log_e("Error: %d", result);
     }
+    trace.finish(result);
     httpClient.end();
     if (result == 401)
         needsRefresh = true;
@@ -289,75 +328,35 @@ int SPClient::getDeviceList()
 
 // Get user playlists
 int SPClient::getUserPlaylists() {
-    playlistIds.clear();
-    playlistNames.clear();
-    playlistImageURLs.clear();
-    playlistTrackCounts.clear();  // 曲数情報を追加
+    playlists.reset();
 
     if (accessToken.isEmpty())
         return 0;
 
-    httpClient.begin("https://api.spotify.com/v1/me/playlists?limit=50", SpotifyPEM);
-    httpClient.addHeader("Authorization", "Bearer " + accessToken);
+    PowerBoost boost;
+    MemoryScope memory(MemoryClient);
+    RequestBuilder<commandURLBytes> url;
+    url.add(_apiBase).add("/v1/me/playlists?limit=50");
+    RequestTrace trace(url.c_str());
+    beginRequest(url.c_str());
+    httpClient.addHeader(authorizationKey, authorization());
     const char *headerKeys[] = {"Transfer-Encoding"};
     httpClient.collectHeaders(headerKeys, 1);
+    trace.connect(httpClient);
     int result = httpClient.GET();
+    trace.firstByte();
     
     if (result == HTTP_CODE_OK) {
         boolean chunked = (httpClient.header("Transfer-Encoding") == "chunked");
         WiFiClient *stream = httpClient.getStreamPtr();
-        JsonStreamScanner scanner = JsonStreamScanner(stream, chunked);
-        
-        String currentPlaylistId = "";
-        String currentPlaylistName = "";
-        String currentPlaylistImageURL = "";
-        int currentTrackCount = 0;
-        
-        while (scanner.available()) {
-            String path = scanner.scanNextKey();
-            
-            if (path == "/items/id") {
-                // 新しいプレイリストの開始
-                if (!currentPlaylistId.isEmpty()) {
-                    // 前のプレイリスト情報があれば保存
-                    playlistIds.push_back(currentPlaylistId);
-                    playlistNames.push_back(currentPlaylistName);
-                    playlistImageURLs.push_back(currentPlaylistImageURL);
-                    playlistTrackCounts.push_back(currentTrackCount);
-                    
-                    // リセット
-                    currentPlaylistImageURL = "";
-                    currentTrackCount = 0;
-                }
-                
-                currentPlaylistId = scanner.scanString();
-                currentPlaylistName = "";  // 新しいプレイリストのためリセット
-            }
-            else if (path == "/items/name") {
-                currentPlaylistName = scanner.scanString();
-            }
-            else if (path == "/items/images/url") {
-                // 最初の画像URLだけを保存（通常は最大サイズの画像）
-                if (currentPlaylistImageURL.isEmpty()) {
-                    currentPlaylistImageURL = scanner.scanString();
-                }
-            }
-            else if (path == "/items/tracks/total") {
-                currentTrackCount = scanner.scanInt();
-            }
-        }
-        
-        // 最後のプレイリスト情報を保存
-        if (!currentPlaylistId.isEmpty()) {
-            playlistIds.push_back(currentPlaylistId);
-            playlistNames.push_back(currentPlaylistName);
-            playlistImageURLs.push_back(currentPlaylistImageURL);
-            playlistTrackCounts.push_back(currentTrackCount);
-        }
+        MemoryScope parsing(MemoryParser);
+        JsonStreamScanner scanner(trace.body(stream), chunked);
+        parsePlaylists(scanner, playlists);
     } else {
         log_e("Error: %d", result);
     }
     
+    trace.finish(result);
     httpClient.end();
     if (result == 401)
         needsRefresh = true;
@@ -366,35 +365,79 @@ int SPClient::getUserPlaylists() {
 }
 
 // Play a specific playlist
-int SPClient::playPlaylist(String playlistId) {
+int SPClient::playPlaylist(const String &playlistId) {
     if (accessToken.isEmpty() || playlistId.isEmpty())
         return 0;
         
     // Spotify APIのドキュメントに従って正しいJSONペイロードを構築
-    String payload = "{\"context_uri\":\"spotify:playlist:" + playlistId + "\"}";
-    return sendPutCommand("https://api.spotify.com/v1/me/player/play", payload);
+    RequestBuilder<commandBodyBytes> payload;
+    payload.add("{\"context_uri\":\"spotify:playlist:").add(playlistId).add("\"}");
+    if (payload.overflowed())
+        return 0;
+    return sendPutCommand(playerPath "/play", payload.c_str());
+}
+
+// "Bearer <token>", rebuilt only when the access token changed
+const String &SPClient::authorization()
+{
+    if (_authorizationToken != accessToken)
+    {
+        _authorizationToken = accessToken;
+        _authorization = "Bearer " + accessToken;
+    }
+    return _authorization;
 }
 
-// Send API command using PUT method
-int SPClient::sendPutCommand(String urlString, String payload)
+// Send API command using PUT method. path is below the API base
+int SPClient::sendPutCommand(const char *path, const char *payload)
 {
-    httpClient.begin(urlString, SpotifyPEM);
-    httpClient.addHeader("Authorization", "Bearer " + accessToken);
-    int result = httpClient.PUT(payload);
+    AllocCounter allocations;
+    RequestBuilder<commandURLBytes> url;
+    url.add(_apiBase).add(path);
+    if (url.overflowed())
+        return 0;
+
+    PowerBoost boost;
+    MemoryScope memory(MemoryClient);
+    RequestTrace trace(url.c_str());
+    beginRequest(url.c_str());
+    httpClient.addHeader(authorizationKey, authorization());
+    trace.connect(httpClient);
+    int result = httpClient.PUT((uint8_t *)payload, strlen(payload));
+    trace.firstByte();
+    trace.finish(result);
     httpClient.end();
+    if (AllocCounter::enabled())
+        log_i("PUT %s: %u allocations", path, allocations.count());
     if (result == 401)
         needsRefresh = true;
     return result;
 }
 
-// Send API command using POST method
-int SPClient::sendPostCommand(String urlString, String payload)
+// Send API command using POST method. path is below the API base
+int SPClient::sendPostCommand(const char *path, const char *payload)
 {
-    httpClient.begin(urlString, SpotifyPEM);
-    httpClient.addHeader("Authorization", "Bearer " + accessToken);
-    httpClient.addHeader("Content-Length", String(payload.length()));
-    int result = httpClient.POST(payload);
+    AllocCounter allocations;
+    RequestBuilder<commandURLBytes> url;
+    url.add(_apiBase).add(path);
+    if (url.overflowed())
+        return 0;
+    RequestBuilder<12> contentLength;
+    contentLength.add((long)strlen(payload));
+
+    PowerBoost boost;
+    MemoryScope memory(MemoryClient);
+    RequestTrace trace(url.c_str());
+    beginRequest(url.c_str());
+    httpClient.addHeader(authorizationKey, authorization());
+    httpClient.addHeader(contentLengthKey, contentLength.c_str());
+    trace.connect(httpClient);
+    int result = httpClient.POST((uint8_t *)payload, strlen(payload));
+    trace.firstByte();
+    trace.finish(result);
     httpClient.end();
+    if (AllocCounter::enabled())
+        log_i("POST %s: %u allocations", path, allocations.count());
     if (result == 401)
         needsRefresh = true;
     return result;
@@ -403,35 +446,50 @@ int SPClient::sendPostCommand(String urlString, String payload)
 // Request changing volume
 int SPClient::changeVolume(int newVolume)
 {
-    return sendPutCommand("https://api.spotify.com/v1/me/player/volume?volume_percent=" + String(newVolume), "{}");
+    RequestBuilder<commandURLBytes> path;
+    path.add(playerPath "/volume?volume_percent=").add(newVolume);
+    return sendPutCommand(path.c_str(), "{}");
 }
 
 // Request resume
 int SPClient::resumePlayback()
 {
-    return sendPutCommand("https://api.spotify.com/v1/me/player/play", "{}");
+    return sendPutCommand(playerPath "/play", "{}");
 }
 
 // Request pause
 int SPClient::pausePlayback()
 {
-    return sendPutCommand("https://api.spotify.com/v1/me/player/pause", "{}");
+    return sendPutCommand(playerPath "/pause", "{}");
 }
 
 // Request skipping to next track
 int SPClient::skipToNext()
 {
-    return sendPostCommand("https://api.spotify.com/v1/me/player/next", "");
+    return sendPostCommand(playerPath "/next", "");
 }
 
 // Request skipping to previous track
 int SPClient::skipToPrev()
 {
-    return sendPostCommand("https://api.spotify.com/v1/me/player/previous", "");
+    return sendPostCommand(playerPath "/previous", "");
 }
 
 // Transfer Playback to specified device
-int SPClient::selectDevice(String newDeviceID)
+int SPClient::selectDevice(const String &newDeviceID)
+{
+    RequestBuilder<commandBodyBytes> payload;
+    payload.add("{ \"device_ids\": [\"").add(newDeviceID).add("\"] }");
+    if (payload.overflowed())
+        return 0;
+    return sendPutCommand(playerPath, payload.c_str());
+}
+
+// The replay server speaks plain HTTP; Spotify needs TLS with its root certificate
+void SPClient::beginRequest(const char *url)
 {
-    return sendPutCommand("https://api.spotify.com/v1/me/player", "{ \"device_ids\": [\"" + newDeviceID + "\"] }");
-}
\ No newline at end of file
+    if (strncmp(url, "https:", 6) == 0)
+        httpClient.begin(url, SpotifyPEM);
+    else
+        httpClient.begin(url);
+}
@@ -3,8 +3,13 @@
 
 #include <Arduino.h>
 #include <HTTPClient.h>
+#include "EntryStore.h"
+#include "PlaybackSnapshot.h"
+#include "RequestTrace.h"
+#include "SpotifyLists.h"
 
 extern const char *SpotifyPEM;
+
 extern String clientID;
 // extern String clientSecret;
 
@@ -19,25 +24,15 @@ public:
 
   boolean needsRefresh;
 
-  std::vector<String> deviceIDs;
-  std::vector<String> deviceNames;
-  
-  // 新しいプレイリスト用ベクトル
-  std::vector<String> playlistIds;
-  std::vector<String> playlistNames;
-  std::vector<String> playlistImageURLs;
-  std::vector<int> playlistTrackCounts;  // 各プレイリストの曲数
-
-
-  String deviceID;
-  boolean isPlaying;
-  String trackName;
-  String artistName;
-  String imageURL;
-  boolean supportsVolume;
-  int volume;
-  long progress_ms;
-  long duration_ms;
+  // Device IDs are not always base62, so they are kept as text
+  EntryStore devices;
+
+  // プレイリスト（値は各プレイリストの曲数）
+  EntryStore playlists;
+
+
+  // Latest result of getPlaybackState(), safe to read from any task
+  PlaybackChannel playback;
 
   String authURLString();
   int requestAccessToken(String code);
@@ -48,10 +43,13 @@ public:
   
   // プレイリスト管理用の新機能
   int getUserPlaylists();
-  int playPlaylist(String playlistId);
+  int playPlaylist(const String &playlistId);
+
+  void setBaseURLs(const char *apiBase, const char *accountsBase);
+  const String &apiBase() { return _apiBase; }
 
-  int sendPutCommand(String urlString, String payload);
-  int sendPostCommand(String urlString, String payload);
+  int sendPutCommand(const char *path, const char *payload);
+  int sendPostCommand(const char *path, const char *payload);
 
   int changeVolume(int newVolume);
   int resumePlayback();
@@ -60,10 +58,18 @@ public:
   int skipToNext();
   int skipToPrev();
 
-  int selectDevice(String newDeviceID);
+  int selectDevice(const String &newDeviceID);
 
 private:
-  HTTPClient httpClient;
+  const String &authorization();
+  void beginRequest(const char *url);
+
+  TracedHTTPClient httpClient;
+  PlaybackSnapshot _fetched;
+  String _authorization;
+  String _authorizationToken;
+  String _apiBase;
+  String _accountsBase;
 };
 
 #endif
\ No newline at end of file
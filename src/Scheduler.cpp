@@ -0,0 +1,84 @@
+#include "Scheduler.h"
+
+Scheduler::Scheduler()
+{
+    for (int i = 0; i < schedulerMaxSteps; i++)
+    {
+        _entries[i].step = nullptr;
+    }
+}
+
+// Run step from loop() after delayMillis. Returns false if all entries are in use
+boolean Scheduler::after(uint32_t delayMillis, SchedulerStep step)
+{
+    cancel(step);
+    for (int i = 0; i < schedulerMaxSteps; i++)
+    {
+        if (!_entries[i].step)
+        {
+            _entries[i].step = step;
+            _entries[i].due = millis() + delayMillis;
+            return true;
+        }
+    }
+    log_e("Scheduler: no free entry");
+    return false;
+}
+
+void Scheduler::cancel(SchedulerStep step)
+{
+    for (int i = 0; i < schedulerMaxSteps; i++)
+    {
+        if (_entries[i].step == step)
+            _entries[i].step = nullptr;
+    }
+}
+
+boolean Scheduler::pending(SchedulerStep step)
+{
+    for (int i = 0; i < schedulerMaxSteps; i++)
+    {
+        if (_entries[i].step == step)
+            return true;
+    }
+    return false;
+}
+
+// Call once per loop(). Runs the due steps; a step may schedule new ones
+void Scheduler::run()
+{
+    _loopStartMicros = micros();
+
+    uint32_t nowMillis = millis();
+    for (int i = 0; i < schedulerMaxSteps; i++)
+    {
+        SchedulerStep step = _entries[i].step;
+        if (step && (int32_t)(nowMillis - _entries[i].due) >= 0)
+        {
+            _entries[i].step = nullptr;
+            step();
+        }
+    }
+}
+
+// Call at the end of loop(), before it waits
+void Scheduler::finishLoop()
+{
+    _lastLoopMicros = micros() - _loopStartMicros;
+    _maxLoopMicros = max(_maxLoopMicros, _lastLoopMicros);
+}
+
+// Milliseconds until the next step is due, at most limitMillis
+uint32_t Scheduler::untilNext(uint32_t limitMillis)
+{
+    uint32_t now = millis();
+    uint32_t wait = limitMillis;
+    for (int i = 0; i < schedulerMaxSteps; i++)
+    {
+        if (!_entries[i].step)
+            continue;
+        int32_t remaining = (int32_t)(_entries[i].due - now);
+        wait = min(wait, (uint32_t)max(remaining, (int32_t)0));
+    }
+    return wait;
+}
@@ -0,0 +1,47 @@
+#ifndef SCHEDULER_H_INCLUDE
+#define SCHEDULER_H_INCLUDE
+
+#include <Arduino.h>
+
+/*
+Scheduler runs steps from loop() once their time has come, so code that
+has to wait schedules its continuation instead of calling delay().
+It also records the longest loop() iteration, from run() to
+finishLoop() so the idle wait after it is not counted: that is bounded
+by the slowest step (usually one HTTP request).
+Steps are plain functions; scheduling a step again moves it.
+*/
+
+#define schedulerMaxSteps 8
+
+typedef void (*SchedulerStep)();
+
+class Scheduler
+{
+public:
+  Scheduler();
+  boolean after(uint32_t delayMillis, SchedulerStep step);
+  void cancel(SchedulerStep step);
+  boolean pending(SchedulerStep step);
+  void run();
+  void finishLoop();
+  uint32_t untilNext(uint32_t limitMillis);
+
+  uint32_t maxLoopMicros() { return _maxLoopMicros; }
+  uint32_t lastLoopMicros() { return _lastLoopMicros; }
+  void resetLoopStats() { _maxLoopMicros = 0; }
+
+private:
+  struct Entry
+  {
+    SchedulerStep step;
+    uint32_t due;
+  };
+
+  Entry _entries[schedulerMaxSteps];
+  uint32_t _loopStartMicros = 0;
+  uint32_t _lastLoopMicros = 0;
+  uint32_t _maxLoopMicros = 0;
+};
+
+#endif
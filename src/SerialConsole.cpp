@@ -0,0 +1,100 @@
+#include "SerialConsole.h"
+
+SerialConsole::SerialConsole()
+{
+}
+
+void SerialConsole::begin(Stream *stream)
+{
+    _stream = stream;
+    add("help", "list commands", nullptr);
+}
+
+// name and help must stay valid. Returns false when the table is full
+boolean SerialConsole::add(const char *name, const char *help, ConsoleCommand command)
+{
+    if (_commandCount >= consoleMaxCommands)
+        return false;
+    _commands[_commandCount++] = {name, help, command};
+    return true;
+}
+
+// Read what has arrived. Lines end with CR, LF or both; longer lines than the buffer are dropped
+void SerialConsole::poll()
+{
+#ifdef SERIAL_CONSOLE
+    if (!_stream)
+        return;
+    while (_stream->available())
+    {
+        int c = _stream->read();
+        if (c == '\r' || c == '\n')
+        {
+            if (_overflow)
+                _stream->printf("line longer than %d characters\n", consoleLineBytes - 1);
+            else if (_length > 0)
+            {
+                _line[_length] = '\0';
+                run(_line);
+            }
+            _length = 0;
+            _overflow = false;
+        }
+        else if (c == '\b' || c == 0x7F)
+        {
+            if (_length > 0)
+                _length--;
+        }
+        else if (_length < sizeof(_line) - 1)
+        {
+            _line[_length++] = c;
+        }
+        else
+        {
+            _overflow = true;
+        }
+    }
+#endif
+}
+
+void SerialConsole::printHelp(Print &out)
+{
+    for (int i = 0; i < _commandCount; i++)
+        out.printf("%-10s %s\n", _commands[i].name, _commands[i].help);
+}
+
+boolean SerialConsole::enabled()
+{
+#ifdef SERIAL_CONSOLE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SerialConsole::run(char *line)
+{
+    while (*line == ' ')
+        line++;
+    char *args = line + strcspn(line, " ");
+    if (*args)
+    {
+        *args++ = '\0';
+        while (*args == ' ')
+            args++;
+    }
+    if (!*line)
+        return;
+
+    for (int i = 0; i < _commandCount; i++)
+    {
+        if (strcmp(line, _commands[i].name) != 0)
+            continue;
+        if (_commands[i].command)
+            _commands[i].command(*_stream, args);
+        else
+            printHelp(*_stream);
+        return;
+    }
+    _stream->printf("unknown command: %s (try help)\n", line);
+}
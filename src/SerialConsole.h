@@ -0,0 +1,48 @@
+#ifndef SERIALCONSOLE_H_INCLUDE
+#define SERIALCONSOLE_H_INCLUDE
+
+#include <Arduino.h>
+
+/*
+SerialConsole reads command lines from a stream without blocking: poll()
+takes what has arrived and runs each complete line. A line is a command
+name followed by arguments, which the handler gets as one string.
+It is built in the console build environment (SERIAL_CONSOLE); otherwise
+poll() returns at once.
+*/
+
+#define consoleLineBytes 96
+#define consoleMaxCommands 12
+
+typedef void (*ConsoleCommand)(Print &out, const char *args);
+
+class SerialConsole
+{
+public:
+  SerialConsole();
+  void begin(Stream *stream);
+  boolean add(const char *name, const char *help, ConsoleCommand command);
+  void poll();
+  void printHelp(Print &out);
+
+  static boolean enabled();
+
+private:
+  struct Entry
+  {
+    const char *name;
+    const char *help;
+    ConsoleCommand command;
+  };
+
+  void run(char *line);
+
+  Stream *_stream = nullptr;
+  Entry _commands[consoleMaxCommands];
+  int _commandCount = 0;
+  char _line[consoleLineBytes];
+  size_t _length = 0;
+  boolean _overflow = false;
+};
+
+#endif
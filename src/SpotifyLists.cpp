@@ -0,0 +1,99 @@
+#include "SpotifyLists.h"
+#include "EntryStore.h"
+#include "JsonStreamScanner.h"
+
+// Append one parsed playlist to the store
+static void addPlaylist(EntryStore &playlists, const String &id, const String &name, const String &imageURL, int trackCount)
+{
+    if (playlists.full())
+        return;
+    int index = playlists.add(id);
+    if (index < 0)
+        return;
+    playlists.setText(index, PlaylistName, name);
+    playlists.setText(index, PlaylistImageURL, imageURL);
+    playlists.setValue(index, trackCount);
+}
+
+int parseDeviceList(JsonStreamScanner &scanner, EntryStore &devices)
+{
+    int count = 0;
+    boolean stored = false;
+    while (scanner.available())
+    {
+        String path = scanner.scanNextKey();
+        if (path == "/devices/id")
+        {
+            String idString = scanner.scanString();
+            stored = false;
+            if (!idString.isEmpty())
+            {
+                count++;
+                int index = devices.full() ? -1 : devices.add();
+                if (index >= 0)
+                {
+                    devices.setText(index, DeviceID, idString);
+                    stored = true;
+                }
+            }
+        }
+        else if (path == "/devices/name" && stored)
+        {
+            String nameString = scanner.scanString();
+            devices.setText(devices.size() - 1, DeviceName, nameString);
+        }
+    }
+    return count;
+}
+
+int parsePlaylists(JsonStreamScanner &scanner, EntryStore &playlists)
+{
+    int count = 0;
+    String currentPlaylistId = "";
+    String currentPlaylistName = "";
+    String currentPlaylistImageURL = "";
+    int currentTrackCount = 0;
+
+    while (scanner.available())
+    {
+        String path = scanner.scanNextKey();
+
+        if (path == "/items/id")
+        {
+            // 新しいプレイリストの開始
+            if (!currentPlaylistId.isEmpty())
+            {
+                // 前のプレイリスト情報があれば保存
+                addPlaylist(playlists, currentPlaylistId, currentPlaylistName, currentPlaylistImageURL, currentTrackCount);
+
+                // リセット
+                currentPlaylistImageURL = "";
+                currentTrackCount = 0;
+            }
+
+            currentPlaylistId = scanner.scanString();
+            currentPlaylistName = "";  // 新しいプレイリストのためリセット
+            count++;
+        }
+        else if (path == "/items/name")
+        {
+            currentPlaylistName = scanner.scanString();
+        }
+        else if (path == "/items/images/url")
+        {
+            // 画像は大きい順に並ぶので、最後（最小サイズ）のURLをサムネイル用に保存
+            currentPlaylistImageURL = scanner.scanString();
+        }
+        else if (path == "/items/tracks/total")
+        {
+            currentTrackCount = scanner.scanInt();
+        }
+    }
+
+    // 最後のプレイリスト情報を保存
+    if (!currentPlaylistId.isEmpty())
+    {
+        addPlaylist(playlists, currentPlaylistId, currentPlaylistName, currentPlaylistImageURL, currentTrackCount);
+    }
+    return count;
+}
@@ -0,0 +1,42 @@
+#ifndef SPOTIFYLISTS_H_INCLUDE
+#define SPOTIFYLISTS_H_INCLUDE
+
+/*
+Layout of the device and playlist EntryStores that SPClient fills, and
+the parsers that fill them from API responses.
+Kept apart from SPClient.h so code without HTTP, like the list screens,
+the host simulator (src/sim) and the scale suite (src/scale), can use
+them.
+*/
+
+class EntryStore;
+class JsonStreamScanner;
+
+// Text fields of the playlist and device stores
+typedef enum
+{
+  PlaylistName = 0,
+  PlaylistImageURL,
+  PlaylistFieldCount
+} PlaylistField;
+
+typedef enum
+{
+  DeviceID = 0,
+  DeviceName,
+  DeviceFieldCount
+} DeviceField;
+
+#define playlistIdLength 22       // base62 Spotify ID
+#define playlistCapacity 50       // limit of one /me/playlists page
+#define playlistArenaBytes 16384  // names and mosaic image URLs
+#define deviceCapacity 16
+#define deviceArenaBytes 2048
+
+// Fill a reset store from a /me/player/devices or /me/playlists body.
+// Entries past the capacity of the store are dropped; the return value
+// counts every entry of the response
+int parseDeviceList(JsonStreamScanner &scanner, EntryStore &devices);
+int parsePlaylists(JsonStreamScanner &scanner, EntryStore &playlists);
+
+#endif
@@ -0,0 +1,281 @@
+#include <HTTPClient.h>
+#include "ThumbnailLoader.h"
+#include "Power.h"
+#include "MemoryBudget.h"
+
+#define thumbnailMaxBytes 65536
+#define thumbnailReadBlock 1024
+#define thumbnailTaskStack 8192
+
+ThumbnailLoader::ThumbnailLoader()
+{
+}
+
+// Allocate cache slots and start background fetch tasks
+void ThumbnailLoader::begin(int thumbSize, int window, int maxFetches)
+{
+    _thumbSize = thumbSize;
+    _window = window;
+    _maxFetches = maxFetches;
+
+    int slotCount = 2 * window + 1;
+    _lock = xSemaphoreCreateMutex();
+    _work = xSemaphoreCreateCounting(slotCount * 4, 0);
+
+    for (int i = 0; i < slotCount; i++)
+    {
+        Slot *slot = new Slot();
+        slot->index = -1;
+        slot->state = SlotEmpty;
+        slot->generation = 0;
+        slot->sprite.setColorDepth(16);
+        slot->sprite.createSprite(thumbSize, thumbSize);
+        memoryBudget.charge(MemoryImages, slot->sprite.bufferLength());
+        _slots.push_back(slot);
+    }
+
+    for (int i = 0; i < maxFetches; i++)
+    {
+        TaskHandle_t worker = nullptr;
+        xTaskCreatePinnedToCore(workerTask, "thumbnail", thumbnailTaskStack, this, 1, &worker, tskNO_AFFINITY);
+        _workers.push_back(worker);
+    }
+}
+
+// Take URLs from a text field of source. All slots and pending fetches are dropped
+void ThumbnailLoader::setSource(const EntryStore *source, uint8_t urlField)
+{
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _source = source;
+    _urlField = urlField;
+    _focus = -1;
+    for (Slot *slot : _slots)
+    {
+        slot->index = -1;
+        slot->state = SlotEmpty;
+        slot->generation = ++_generation;
+    }
+    xSemaphoreGive(_lock);
+}
+
+// Move the focus. Slots outside the window are cancelled and the window is requeued
+void ThumbnailLoader::setFocus(int index)
+{
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _focus = index;
+
+    for (Slot *slot : _slots)
+    {
+        if (slot->index >= 0 && abs(slot->index - index) > _window)
+        {
+            slot->index = -1;
+            slot->state = SlotEmpty;
+            slot->generation = ++_generation;
+        }
+    }
+
+    int queued = 0;
+    for (int distance = 0; distance <= _window; distance++)
+    {
+        for (int side = 0; side < (distance == 0 ? 1 : 2); side++)
+        {
+            int candidate = (side == 0) ? index + distance : index - distance;
+            if (candidate < 0 || !_source || candidate >= _source->size() || !*_source->text(candidate, _urlField))
+                continue;
+            if (slotForIndex(candidate))
+                continue;
+
+            for (Slot *slot : _slots)
+            {
+                if (slot->state == SlotEmpty)
+                {
+                    slot->index = candidate;
+                    slot->state = SlotQueued;
+                    slot->generation = ++_generation;
+                    slot->url = _source->text(candidate, _urlField);
+                    queued++;
+                    break;
+                }
+            }
+        }
+    }
+    xSemaphoreGive(_lock);
+
+    for (int i = 0; i < queued; i++)
+    {
+        xSemaphoreGive(_work);
+    }
+}
+
+// Drop everything, e.g. when leaving the list screen
+void ThumbnailLoader::clear()
+{
+    setSource(nullptr, 0);
+}
+
+// Return if the thumbnail for index is decoded
+boolean ThumbnailLoader::isReady(int index)
+{
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Slot *slot = slotForIndex(index);
+    boolean ready = (slot && slot->state == SlotReady);
+    xSemaphoreGive(_lock);
+    return ready;
+}
+
+// Push the thumbnail for index if it is ready. Never blocks on network
+boolean ThumbnailLoader::draw(int index, LovyanGFX *dst, int32_t x, int32_t y)
+{
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Slot *slot = slotForIndex(index);
+    boolean ready = (slot && slot->state == SlotReady);
+    if (ready)
+    {
+        slot->sprite.pushSprite(dst, x, y);
+    }
+    xSemaphoreGive(_lock);
+    return ready;
+}
+
+// Return true once after one or more thumbnails finished loading
+boolean ThumbnailLoader::takeUpdated()
+{
+    if (!_updated)
+        return false;
+    _updated = false;
+    return true;
+}
+
+void ThumbnailLoader::workerTask(void *param)
+{
+    ((ThumbnailLoader *)param)->workerLoop();
+}
+
+// Take the best queued slot, fetch and decode it, then publish if still wanted
+void ThumbnailLoader::workerLoop()
+{
+    MemoryScope memory(MemoryImages);
+    LGFX_Sprite scratch;
+    scratch.setColorDepth(16);
+    scratch.createSprite(_thumbSize, _thumbSize);
+
+    while (true)
+    {
+        xSemaphoreTake(_work, portMAX_DELAY);
+
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        Slot *slot = nextQueuedSlot();
+        if (!slot)
+        {
+            xSemaphoreGive(_lock);
+            continue;
+        }
+        slot->state = SlotLoading;
+        uint32_t generation = slot->generation;
+        String url = slot->url;
+        xSemaphoreGive(_lock);
+
+        boolean success = fetchInto(slot, generation, url, scratch);
+
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        if (slot->generation == generation)
+        {
+            if (success)
+            {
+                memcpy(slot->sprite.getBuffer(), scratch.getBuffer(), _thumbSize * _thumbSize * 2);
+                slot->state = SlotReady;
+                _updated = true;
+                power.wake();
+            }
+            else
+            {
+                slot->state = SlotFailed;
+            }
+        }
+        xSemaphoreGive(_lock);
+    }
+}
+
+// Download url into scratch. Gives up as soon as the slot is reassigned
+boolean ThumbnailLoader::fetchInto(Slot *slot, uint32_t generation, const String &url, LGFX_Sprite &scratch)
+{
+    if (WiFi.status() != WL_CONNECTED)
+        return false;
+
+    boolean success = false;
+    PowerBoost boost;
+    HTTPClient http;
+    http.setTimeout(10000);
+    http.begin(url);
+    http.addHeader("User-Agent", "ESP32/M5Dial");
+
+    int httpCode = http.GET();
+    int contentLength = http.getSize();
+    if (httpCode == HTTP_CODE_OK && contentLength > 0 && contentLength <= thumbnailMaxBytes && isCurrent(slot, generation))
+    {
+        size_t size = contentLength;
+        uint8_t *buffer = memoryBudget.admit(MemoryImages, size) ? (uint8_t *)malloc(size) : nullptr;
+        if (buffer)
+        {
+            WiFiClient *stream = http.getStreamPtr();
+            size_t bytesRead = 0;
+            while (bytesRead < size && isCurrent(slot, generation))
+            {
+                size_t block = min((size_t)thumbnailReadBlock, size - bytesRead);
+                size_t count = stream->readBytes(buffer + bytesRead, block);
+                if (count == 0)
+                    break;
+                bytesRead += count;
+            }
+
+            if (bytesRead == size && isCurrent(slot, generation))
+            {
+                scratch.fillScreen(BLACK);
+                // scale 0 fits the image into thumbSize x thumbSize
+                success = scratch.drawJpg(buffer, bytesRead, 0, 0, _thumbSize, _thumbSize, 0, 0, 0.0f, 0.0f);
+            }
+            free(buffer);
+        }
+        else
+        {
+            log_e("Thumbnail: failed to allocate %d bytes", contentLength);
+        }
+    }
+    http.end();
+    return success;
+}
+
+boolean ThumbnailLoader::isCurrent(Slot *slot, uint32_t generation)
+{
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    boolean current = (slot->generation == generation);
+    xSemaphoreGive(_lock);
+    return current;
+}
+
+// Must be called with _lock held
+ThumbnailLoader::Slot *ThumbnailLoader::slotForIndex(int index)
+{
+    if (index < 0)
+        return nullptr;
+    for (Slot *slot : _slots)
+    {
+        if (slot->index == index)
+            return slot;
+    }
+    return nullptr;
+}
+
+// Queued slot nearest to the focus. Must be called with _lock held
+ThumbnailLoader::Slot *ThumbnailLoader::nextQueuedSlot()
+{
+    Slot *best = nullptr;
+    for (Slot *slot : _slots)
+    {
+        if (slot->state != SlotQueued)
+            continue;
+        if (!best || abs(slot->index - _focus) < abs(best->index - _focus))
+            best = slot;
+    }
+    return best;
+}
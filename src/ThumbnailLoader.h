@@ -0,0 +1,76 @@
+#ifndef THUMBNAILLOADER_H_INCLUDE
+#define THUMBNAILLOADER_H_INCLUDE
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "EntryStore.h"
+
+/*
+ThumbnailLoader downloads list thumbnails in background tasks.
+Rows closest to the focused index are fetched first, rows that leave
+the window around the focus are cancelled, and at most maxFetches
+downloads run at the same time. The UI task never waits on a fetch.
+*/
+
+class ThumbnailLoader
+{
+public:
+  ThumbnailLoader();
+  void begin(int thumbSize, int window, int maxFetches);
+
+  void setSource(const EntryStore *source, uint8_t urlField);
+  void setFocus(int index);
+  void clear();
+
+  boolean isReady(int index);
+  boolean draw(int index, LovyanGFX *dst, int32_t x, int32_t y);
+  boolean takeUpdated();
+
+  int workerCount() { return _workers.size(); }
+  TaskHandle_t worker(int i) { return _workers[i]; }
+
+private:
+  typedef enum
+  {
+    SlotEmpty = 0,
+    SlotQueued,
+    SlotLoading,
+    SlotReady,
+    SlotFailed
+  } SlotState;
+
+  struct Slot
+  {
+    int index;
+    SlotState state;
+    uint32_t generation;
+    String url;
+    LGFX_Sprite sprite;
+  };
+
+  static void workerTask(void *param);
+  void workerLoop();
+  Slot *slotForIndex(int index);
+  Slot *nextQueuedSlot();
+  boolean fetchInto(Slot *slot, uint32_t generation, const String &url, LGFX_Sprite &scratch);
+  boolean isCurrent(Slot *slot, uint32_t generation);
+
+  int _thumbSize = 0;
+  int _window = 0;
+  int _maxFetches = 0;
+  std::vector<TaskHandle_t> _workers;
+  int _focus = -1;
+  uint32_t _generation = 0;
+  volatile boolean _updated = false;
+
+  const EntryStore *_source = nullptr;
+  uint8_t _urlField = 0;
+  std::vector<Slot *> _slots;
+  SemaphoreHandle_t _lock = nullptr;
+  SemaphoreHandle_t _work = nullptr;
+};
+
+#endif
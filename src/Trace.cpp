@@ -0,0 +1,95 @@
+#include <freertos/FreeRTOS.h>
+#include "Trace.h"
+
+struct TraceEvent
+{
+    uint32_t micros;
+    const char *format;
+    uint8_t level;
+    uint8_t category;
+    boolean text;
+    union
+    {
+        uint32_t values[traceArgs];
+        char text[traceTextBytes];
+    } data;
+};
+
+static TraceEvent traceRing[traceEvents];
+static uint32_t traceNext = 0; // events recorded since boot; the slot is traceNext % traceEvents
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+
+#define traceCategoryCount 7
+
+static const char *const traceCategoryNames[traceCategoryCount] = {"http", "json", "image", "ui", "wifi", "power", "app"};
+static const char traceLevelLetters[] = "?EWIDV";
+
+void Trace::write(uint8_t level, uint8_t category, const char *format, const uint32_t *values, int count)
+{
+    uint32_t now = micros();
+    portENTER_CRITICAL_SAFE(&traceMux);
+    TraceEvent &event = traceRing[traceNext++ & (traceEvents - 1)];
+    event.micros = now;
+    event.format = format;
+    event.level = level;
+    event.category = category;
+    event.text = false;
+    memcpy(event.data.values, values, count * sizeof(uint32_t));
+    portEXIT_CRITICAL_SAFE(&traceMux);
+}
+
+void Trace::recordText(uint8_t level, uint8_t category, const char *format, const char *text)
+{
+    uint32_t now = micros();
+    size_t length = text ? strlen(text) : 0;
+    const char *tail = length < traceTextBytes ? text : text + length - (traceTextBytes - 1);
+    portENTER_CRITICAL_SAFE(&traceMux);
+    TraceEvent &event = traceRing[traceNext++ & (traceEvents - 1)];
+    event.micros = now;
+    event.format = format;
+    event.level = level;
+    event.category = category;
+    event.text = true;
+    size_t count = min(length, (size_t)traceTextBytes - 1);
+    memcpy(event.data.text, tail, count);
+    event.data.text[count] = '\0';
+    portEXIT_CRITICAL_SAFE(&traceMux);
+}
+
+// Format the events in the ring, oldest first: time in us, level, category, message
+void Trace::print(Print &out)
+{
+    portENTER_CRITICAL(&traceMux);
+    uint32_t end = traceNext;
+    portEXIT_CRITICAL(&traceMux);
+    uint32_t begin = end > traceEvents ? end - traceEvents : 0;
+    out.printf("trace: %u events, %u overwritten\n", end, begin);
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        // Copy first: other tasks keep recording while this prints
+        TraceEvent event;
+        portENTER_CRITICAL(&traceMux);
+        boolean overwritten = traceNext - i > traceEvents;
+        event = traceRing[i & (traceEvents - 1)];
+        portEXIT_CRITICAL(&traceMux);
+        if (overwritten)
+            continue;
+
+        int category = 0;
+        while (category < traceCategoryCount - 1 && !(event.category & (1 << category)))
+            category++;
+        out.printf("%10u %c %-5s ", event.micros, traceLevelLetters[min(event.level, (uint8_t)5)], traceCategoryNames[category]);
+        if (event.text)
+            out.printf(event.format, event.data.text);
+        else
+            out.printf(event.format, event.data.values[0], event.data.values[1], event.data.values[2],
+                       event.data.values[3], event.data.values[4]);
+        out.println();
+    }
+}
+
+uint32_t Trace::recorded()
+{
+    return traceNext;
+}
@@ -0,0 +1,106 @@
+#ifndef TRACE_H_INCLUDE
+#define TRACE_H_INCLUDE
+
+#include <Arduino.h>
+#include <type_traits>
+
+/*
+Trace records events into a RAM ring in binary form: time, level,
+category, the format string pointer and up to traceArgs integer
+arguments (or one short text). Nothing is formatted until print(), so
+an event costs a few stores instead of printf and UART time.
+Levels and categories are chosen at compile time with TRACE_LEVEL and
+TRACE_CATEGORIES; a trace_x() call that is below the level or outside
+the categories compiles to nothing. The default records info and above
+in every category. Errors and warnings are logged as well, whatever the
+level and categories.
+Format strings must be literals, since only their address is kept.
+*/
+
+#define traceLevelError 1
+#define traceLevelWarn 2
+#define traceLevelInfo 3
+#define traceLevelDebug 4
+#define traceLevelVerbose 5
+
+#define traceHttp 0x01
+#define traceJson 0x02
+#define traceImage 0x04
+#define traceUI 0x08
+#define traceWiFi 0x10
+#define tracePower 0x20
+#define traceApp 0x40
+#define traceAll 0x7F
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL traceLevelInfo
+#endif
+#ifndef TRACE_CATEGORIES
+#define TRACE_CATEGORIES traceAll
+#endif
+
+#define traceEvents 128  // power of two
+#define traceArgs 5
+#define traceTextBytes (traceArgs * 4)
+
+#define traceEnabled(level, category) ((level) <= (TRACE_LEVEL) && ((category) & (TRACE_CATEGORIES)) != 0)
+
+// Integer arguments: trace_i(traceImage, "decoded %u bytes", size)
+#define trace_at(level, category, ...) \
+  do \
+  { \
+    if (traceEnabled(level, category)) \
+      Trace::record(level, category, __VA_ARGS__); \
+  } while (0)
+// Errors and warnings also go to log_e()/log_w(), since only console builds can print the ring
+#define trace_e(category, ...) \
+  do \
+  { \
+    log_e(__VA_ARGS__); \
+    trace_at(traceLevelError, category, __VA_ARGS__); \
+  } while (0)
+#define trace_w(category, ...) \
+  do \
+  { \
+    log_w(__VA_ARGS__); \
+    trace_at(traceLevelWarn, category, __VA_ARGS__); \
+  } while (0)
+#define trace_i(category, ...) trace_at(traceLevelInfo, category, __VA_ARGS__)
+#define trace_d(category, ...) trace_at(traceLevelDebug, category, __VA_ARGS__)
+#define trace_v(category, ...) trace_at(traceLevelVerbose, category, __VA_ARGS__)
+
+// One string argument, copied; longer text keeps its end: trace_text(traceLevelInfo, traceImage, "url %s", url)
+#define trace_text(level, category, format, text) \
+  do \
+  { \
+    if (traceEnabled(level, category)) \
+      Trace::recordText(level, category, format, text); \
+  } while (0)
+
+class Trace
+{
+public:
+  template <typename... Args>
+  static void record(uint8_t level, uint8_t category, const char *format, Args... args)
+  {
+    static_assert(sizeof...(Args) <= traceArgs, "too many trace arguments");
+    uint32_t values[traceArgs] = {value(args)...};
+    write(level, category, format, values, sizeof...(Args));
+  }
+  static void recordText(uint8_t level, uint8_t category, const char *format, const char *text);
+
+  static void print(Print &out);
+  static uint32_t recorded();
+
+private:
+  template <typename T>
+  static uint32_t value(T argument)
+  {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "trace arguments are kept as integers; use trace_text for a string");
+    return (uint32_t)argument;
+  }
+  static void write(uint8_t level, uint8_t category, const char *format, const uint32_t *values, int count);
+};
+
+#endif
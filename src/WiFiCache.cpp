@@ -0,0 +1,118 @@
+#include <Preferences.h>
+#include <esp_wifi.h>
+#include "WiFiCache.h"
+
+WiFiCache::WiFiCache(const char *space, const char *key)
+{
+    _space = space;
+    _key = key;
+    memset(&_record, 0, sizeof(_record));
+    _ssid[0] = '\0';
+    _password[0] = '\0';
+}
+
+// Read the cached access point and lease. Returns false if there is none
+boolean WiFiCache::load()
+{
+    Preferences preferences;
+    preferences.begin(_space, true);
+    size_t length = preferences.getBytes(_key, &_record, sizeof(_record));
+    preferences.end();
+    if (length != sizeof(_record) || _record.format != wifiCacheFormat || !_record.ip)
+    {
+        memset(&_record, 0, sizeof(_record));
+        return false;
+    }
+    return true;
+}
+
+// Directed join: fixed BSSID and channel, static config from the cached
+// lease while it is fresh, DHCP otherwise
+boolean WiFiCache::beginCached(uint32_t now)
+{
+    if (!loaded() || !readCredentials())
+        return false;
+    boolean fresh = now && _record.leaseTime && now >= _record.leaseTime && now - _record.leaseTime < wifiCacheLeaseSeconds;
+    if (fresh)
+    {
+        WiFi.config(IPAddress(_record.ip), IPAddress(_record.gateway), IPAddress(_record.subnet),
+                    IPAddress(_record.dns1), IPAddress(_record.dns2));
+        _staticConfig = true;
+    }
+    else
+    {
+        useDHCP();
+    }
+    WiFi.begin(_ssid, _password, _record.channel, _record.bssid);
+    return true;
+}
+
+// Regular join: any BSSID, all channels, DHCP
+boolean WiFiCache::beginScan()
+{
+    useDHCP();
+    if (!readCredentials())
+    {
+        WiFi.begin();
+        return false;
+    }
+    // Passing credentials again also clears the BSSID lock set by beginCached()
+    WiFi.begin(_ssid, _password);
+    return true;
+}
+
+// Drop the static config of beginCached(). The next join runs DHCP
+void WiFiCache::useDHCP()
+{
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    _staticConfig = false;
+}
+
+// Remember the current connection. A join with the cached lease keeps its
+// time, a DHCP join starts a new lease at now. Writes only if something changed
+void WiFiCache::store(uint32_t now)
+{
+    Record record;
+    memset(&record, 0, sizeof(record));
+    record.format = wifiCacheFormat;
+    record.channel = WiFi.channel();
+    const uint8_t *bssid = WiFi.BSSID();
+    if (bssid)
+        memcpy(record.bssid, bssid, sizeof(record.bssid));
+    record.ip = WiFi.localIP();
+    record.gateway = WiFi.gatewayIP();
+    record.subnet = WiFi.subnetMask();
+    record.dns1 = WiFi.dnsIP(0);
+    record.dns2 = WiFi.dnsIP(1);
+    record.leaseTime = _staticConfig ? _record.leaseTime : now;
+    if (!record.ip || memcmp(&record, &_record, sizeof(record)) == 0)
+        return;
+
+    _record = record;
+    Preferences preferences;
+    preferences.begin(_space);
+    preferences.putBytes(_key, &_record, sizeof(_record));
+    preferences.end();
+}
+
+void WiFiCache::remove()
+{
+    Preferences preferences;
+    preferences.begin(_space);
+    preferences.remove(_key);
+    preferences.end();
+    memset(&_record, 0, sizeof(_record));
+}
+
+// SSID and password the driver saved from the last WiFi.begin(ssid, pass)
+boolean WiFiCache::readCredentials()
+{
+    wifi_config_t config;
+    if (esp_wifi_get_config(WIFI_IF_STA, &config) != ESP_OK || !config.sta.ssid[0])
+        return false;
+    memcpy(_ssid, config.sta.ssid, sizeof(config.sta.ssid));
+    _ssid[sizeof(config.sta.ssid)] = '\0';
+    memcpy(_password, config.sta.password, sizeof(config.sta.password));
+    _password[sizeof(config.sta.password)] = '\0';
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef WIFICACHE_H_INCLUDE
+#define WIFICACHE_H_INCLUDE
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+/*
+WiFiCache remembers where the last successful join landed: the access
+point BSSID and channel, and the DHCP lease (IP, gateway, subnet, DNS).
+beginCached() joins that access point directly on its channel with the
+lease as a static config, skipping the channel scan and DHCP exchange.
+The lease is only reused for wifiCacheLeaseSeconds after the DHCP join
+that got it; past that, or when the time is unknown, the directed join
+runs DHCP and renews it. Times are seconds of any clock that keeps
+running across boots (the RTC), 0 when there is none.
+beginScan() is the regular join with the same credentials and DHCP, for
+when the cached join does not connect in time. Call useDHCP() before any
+other join, so a static config left by beginCached() does not stick.
+Credentials are not copied here. They stay in the WiFi driver's own storage.
+*/
+
+#define wifiCacheFormat 2
+#define wifiCacheLeaseSeconds 3600  // shorter than the lease of common routers
+
+class WiFiCache
+{
+public:
+  WiFiCache(const char *space, const char *key);
+  boolean load();
+  boolean beginCached(uint32_t now);
+  boolean beginScan();
+  void useDHCP();
+  void store(uint32_t now);
+  void remove();
+  boolean loaded() { return _record.format == wifiCacheFormat; }
+
+private:
+  struct Record
+  {
+    uint8_t format;
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns1;
+    uint32_t dns2;
+    uint32_t leaseTime;  // when DHCP gave the lease
+  };
+
+  boolean readCredentials();
+
+  const char *_space;
+  const char *_key;
+  Record _record;
+  boolean _staticConfig = false;  // joined with the cached lease, not DHCP
+  char _ssid[33];
+  char _password[65];
+};
+
+#endif
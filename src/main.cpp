@@ -12,6 +12,22 @@
 
 #include "wifiform.h"
 #include "SPClient.h"
+#include "ThumbnailLoader.h"
+#include "PlayerView.h"
+#include "PlayerScreens.h"
+#include "RenderLoop.h"
+#include "GlyphCache.h"
+#include "Scheduler.h"
+#include "LastScreen.h"
+#include "WiFiCache.h"
+#include "DialEncoder.h"
+#include "Power.h"
+#include "Metrics.h"
+#include "RenderProfiler.h"
+#include "MemoryBudget.h"
+#include "SerialConsole.h"
+#include "Benchmark.h"
+#include "Trace.h"
 
 typedef enum
 {
@@ -20,29 +36,13 @@ typedef enum
   StateAPFormQRcode = 2,
   StateAuthQRcode = 3,
   StateWaitAuth = 4,
-  StatePlay = 5,
-  StateMenu = 6,          // New state for menu screen
-  StateDeviceList = 7,    // Updated index
-  StatePlaylistList = 8   // New state for playlist selection
+  StatePlayer = 5,       // 再生画面・メニュー・デバイスとプレイリストの一覧（PlayerScreens）
+  StateConnecting = 6,   // WiFi接続・スキャン中
+  StateError = 7         // 続行できないエラーを表示中
 } ScreenState;
 
-// Define menu items
-typedef enum
-{
-  MenuBack = 0,
-  MenuPlaylists = 1,
-  MenuDevices = 2,
-  MenuItemCount
-} MenuItem;
-
 ScreenState screenState;
 
-// Menu items
-String menuItems[MenuItemCount] = {"<< Back", "Select Playlist", "Select Device"};
-int selectedMenuItem = 0;
-int selectedPlaylistIndex = -1;
-String selectedPlaylistId = "";
-
 // WiFi variables
 IPAddress myIP;
 std::vector<String> wifiVector;
@@ -54,6 +54,9 @@ String AP_ssid = "DialPlay";
 String AP_pass = "DialPlay";
 DNSServer dnsServer;
 WebServer webServer(80);
+boolean webServerStarted = false;
+boolean metricsServing = false;    // 再生中も/metricsを返す（metrics環境のみ）
+#define metricsPollMillis 100      // 再生中のWebサーバーの確認間隔
 
 // Station mode
 String ST_ssid;
@@ -69,36 +72,94 @@ M5GFX Display;
 #define screenHeight 240
 #define qrcodeWidth 160
 #define baseColor 0xFB40
-bool needFullClear = true;
-
-// スクロールテキスト用の変数
-LGFX_Sprite albumArtSprite(&Display);  // アルバムアート用スプライト
-LGFX_Sprite trackNameSprite(&Display);
-LGFX_Sprite artistNameSprite(&Display);
-LGFX_Sprite playlistImageSprite(&Display);  // プレイリストイメージ用スプライト
-size_t trackNamePos = 0;
-size_t artistNamePos = 0;
-int32_t trackNameCursorX = 0;
-int32_t artistNameCursorX = 0;
-unsigned long lastScrollTime = 0;
-const int scrollDelay = 50;  // スクロール速度（ms）
-const int textPause = 1000;  // 端までスクロールした後の待機時間（ms）
-bool isTrackScrolling = false;
-bool isArtistScrolling = false;
-unsigned long trackPauseTime = 0;
-unsigned long artistPauseTime = 0;
+
+// 文字描画用のグリフキャッシュ（同じ文字を何度もデコードしない）
+GlyphCache glyphCache;
+#define glyphCacheGlyphs 256
+#define glyphCacheSlotBytes 72   // 20pxフォント1文字分（1bit）
+
+// 再生画面とリスト画面（変化した部分だけをパネルへ転送、リストは見えている行だけ描画）
+PlayerView playerView(&glyphCache, baseColor);
+LGFX_Sprite albumArtDecodeSprite(&Display);  // デコード用（描画中のスプライトを書き換えないため）
 String currentImageURL = "";  // 現在表示中の画像URL
-String currentPlaylistImageURL = "";  // 現在表示中のプレイリスト画像URL
-String previousTrackName = "";
-String previousArtistName = "";
+
+// 描画専用タスク（HTTP通信中もアニメーションを一定フレームレートで進める）
+RenderLoop renderLoop;
+#define renderFramesPerSecond 30
+#define renderTaskPriority 2    // loop()より高くする
+#define renderTaskCore 1
+RenderProfiler renderProfiler;  // フレームごとの描画時間（render-profile環境のみ）
+
+// プレイリストのサムネイル（バックグラウンドで読み込み）
+ThumbnailLoader thumbnailLoader;
+#define thumbnailSize 24
+#define thumbnailWindow 4     // 選択行から前後何行まで先読みするか
+#define thumbnailFetches 2    // 同時ダウンロード数の上限
+
+// 待ち処理（delay()の代わりにスケジューラで続きを実行）
+Scheduler scheduler;
+#define wifiSettleMillis 100     // WiFi切断後、次の操作まで
+#define wifiPollMillis 500
+#define wifiJoinPolls 20
+#define wifiScanRetries 3        // スキャン失敗時の再試行回数
+#define wifiScanErrorMillis 3000 // 再試行しても失敗したら、エラー表示後にやり直すまで
+#define authErrorMillis 3000
+#define loopStatsMillis 10000    // ループ遅延の最大値を出力する間隔
+#define traceStatsMillis 60000   // リクエストごとの所要時間のヒストグラムを出力する間隔（request-trace環境のみ）
+#define renderStatsMillis 10000  // 描画時間の集計を出力する間隔（render-profile環境のみ）
+#define memoryStatsMillis 10000  // ヒープ・スタックの確認間隔
+
+// サブシステムごとのヒープの上限（超えたら警告、memory-budget環境で集計）
+#define parserBudgetBytes 4096
+#define clientBudgetBytes 56000  // TLSのバッファを含む
+#define imagesBudgetBytes 100000 // サムネイル2枚分のダウンロードとスプライト
+#define uiBudgetBytes 80000      // バンドバッファ・グリフキャッシュ
+#define webBudgetBytes 16384
+#define memoryReserveBytes 32768 // アルバムアートのダウンロードに必要な連続領域
+#define stackMarginBytes 1024
+
+// シリアルコンソール（console環境のみ）
+SerialConsole console;
+#define consolePollMillis 50
+#define benchIterations 20       // benchの既定の繰り返し回数
+#define benchTlsIterations 3
+#define benchSpotifyIterations 5 // bench spotifyの既定の繰り返し回数
+#define benchHost "accounts.spotify.com"
+int wifiJoinCount = 0;
+int wifiScanFailures = 0;
+SchedulerStep wifiJoinedStep = nullptr;
+
+// 前回接続したAP（BSSID・チャンネル）とDHCPの設定
+WiFiCache wifiCache("DialPlay", "wifiCache");
+#define wifiCachedPollMillis 20
+#define wifiCachedJoinPolls 75   // 1.5秒で通常の接続に切り替え
+boolean wifiCachedJoin = false;  // キャッシュを使った接続を試行中
+
+// 前回の再生画面（起動直後、ネットワーク接続前に表示する）
+LastScreen lastScreen("DialPlay", "lastScreen");
+#define lastScreenSaveMillis 30000  // 表示が落ち着いてから保存（曲送り中に何度も書き込まない）
+#define bootPollMillis 20
+boolean bootFromLastScreen = false;
+uint32_t bootLiveMillis = 0;
+
+// 入力割り込みか次の期限まで待つ（待つ間はクロックを下げ、可能ならライトスリープ）
+#define encoderPinA 41
+#define encoderPinB 40
+#define buttonPin 42
+#define touchInterruptPin 14
+#define cpuLowMHz 80
+#define cpuHighMHz 240
+#define idleMaxMillis 60000
+#define serverPollMillis 10     // APモード・認証待ちはWebサーバーを回し続ける
+#define inputPollMillis 10      // ボタン・タッチの変化中はM5Dial.update()を回す
+#define inputSettleMillis 300   // 最後の割り込みから短い間隔で回す時間
+DialEncoder dialEncoder(encoderPinA, encoderPinB);
+
+// ダイヤルの回転速度に応じた加速（画面ごとのカーブはPlayerScreens）。割り込みで記録したイベントから計算する
+DialMotion dialMotion(&dialEncoder);
 
 // Spotify variables
 SPClient spClient;
-int tempVolume = 0;
-int tempDeviceIndex = 0;
-long oldPosition;
-long oldMillis;
-long refreshMillis = 0;
 
 // Preferences (Save refresh token)
 Preferences preferences;
@@ -106,23 +167,42 @@ Preferences preferences;
 // Function declarations
 void resetWiFiAndAuth();
 void scanWiFi();
+void startWiFiScan();
+void pollWiFiScan();
 void startWiFiAP();
+void openWiFiAP();
 void showAPQRcode();
 void showAPFormQRcode();
+void joinWiFi(SchedulerStep joined);
+void pollWiFiJoin();
+void rejoinWiFi();
+uint32_t rtcSeconds();
 void startWiFiST();
+void joinWiFiST();
+void onWiFiSTConnected();
+void startSpotify();
+void showFirstPlayScreen();
+void showLastScreen();
+void saveLastScreen();
+void logBootTiming();
+void logLoopStats();
+void logRequestTrace();
+void logRenderProfile();
+void logMemory();
+void handleMetrics();
+void writeMetrics(MetricsWriter &out);
+void consoleMetrics(Print &out, const char *args);
+void consoleStats(Print &out, const char *args);
+void consoleBench(Print &out, const char *args);
+void consoleTrace(Print &out, const char *args);
+void consoleApi(Print &out, const char *args);
+void handleScreen();
+uint32_t idleTimeout();
+boolean idleMaySleep();
+void onInputInterrupt();
 void showSpotifyAuthQRcode();
 
-void showPlayScreen();
-void redrawPlayScreen();
-void showMenuScreen();
-void redrawMenuScreen(int selectedLine);
-void showDeviceScreen();
-void redrawDeviceScreen(int selectedLine);
-void showPlaylistScreen();
-void redrawPlaylistScreen(int selectedLine);
-void updateScrollingText();
-void downloadAndDisplayAlbumArt();
-void downloadAndDisplayPlaylistImage(String imageURL);
+void downloadAndDisplayAlbumArt(const char *imageURL);
 
 void handleRootGet(void);
 void handleIntermediate(void);
@@ -131,278 +211,168 @@ void handlePostWiFi(void);
 void handleCodeReceiverOptions(void);
 void handleCodeReceiver(void);
 void handleNotFound(void);
+boolean setupRouteOpen(void);
 
 void showMessage(String message, bool isError = false);
+void drawText(const String &text, int32_t x, int32_t y, uint16_t color = baseColor);
 
-// Function to show the menu screen
-void showMenuScreen() {
-  screenState = StateMenu;
-  selectedMenuItem = 0;
-  redrawMenuScreen(selectedMenuItem);
-}
-
-// Function to redraw the menu screen with the selected item
-void redrawMenuScreen(int selectedLine) {
-  Display.clear();
-  
-  Display.fillRect(0, screenHeight / 2 - 12, screenWidth, 24, baseColor);
-  
-  for (int i = 0; i < MenuItemCount; i++) {
-    int y = (i - selectedLine) * 30 + screenHeight / 2;
-    if (y > 0 && y < screenHeight) {
-      if (i == selectedLine) {
-        Display.setTextColor(BLACK);
-        Display.drawString(menuItems[i], screenWidth / 2, y);
-        Display.setTextColor(baseColor);
-      } else {
-        Display.drawString(menuItems[i], screenWidth / 2, y);
-      }
-    }
-  }
-}
-
-// Function to show playlist selection screen
-void showPlaylistScreen() {
-  screenState = StatePlaylistList;
-  Display.clear();
-  Display.drawString("Loading playlists...", screenWidth / 2, screenHeight / 2);
-
-  spClient.getUserPlaylists();
-  
-  // デフォルトで先頭の「<< Back」を選択
-  tempDeviceIndex = 0;
-  
-  // 以前に選択したプレイリストがある場合、そのインデックスを探す (1オフセット)
-  if (!selectedPlaylistId.isEmpty()) {
-    for (int i = 0; i < spClient.playlistIds.size(); i++) {
-      if (spClient.playlistIds[i] == selectedPlaylistId) {
-        tempDeviceIndex = i + 1; // +1 for Back option
-        break;
-      }
-    }
-  }
-  
-  redrawPlaylistScreen(tempDeviceIndex);
-}
-
-// Enhanced redrawPlaylistScreen with images
-void redrawPlaylistScreen(int selectedLine) {
-  Display.clear();
-  
-  // プレイリスト数 + 戻るオプション
-  int lineCount = 1 + spClient.playlistIds.size(); // +1 for Back option
-  
-  if (spClient.playlistIds.size() == 0) { // プレイリストがない場合
-    Display.drawString("No playlists found", screenWidth / 2, screenHeight / 2);
-    return;
-  }
-  
-  if (selectedLine < 0) selectedLine = 0;
-  if (selectedLine >= lineCount) selectedLine = lineCount - 1;
-  
-  // 選択エリアをハイライト
-  Display.fillRect(0, screenHeight / 2 - 12, screenWidth, 24, baseColor);
-  Display.fillRect(0, 0, screenWidth, 42, BLACK);
-  
-  // すべての行を描画
-  for (int i = 0; i < lineCount; i++) {
-    int y = (i - selectedLine) * 30 + screenHeight / 2;
-    if (y > 0 && y < screenHeight) {
-      String displayName;
-      
-      if (i == 0) {
-        displayName = "<< Back"; // 戻るオプション
-      } else {
-        // i-1で実際のプレイリストインデックスを取得
-        displayName = spClient.playlistNames[i-1];
-        
-        // 選択中のプレイリストにチェックマーク表示
-        if (spClient.playlistIds[i-1] == selectedPlaylistId) {
-          displayName = ">> " + displayName;
-        }
-      }
-      
-      if (i == selectedLine) {
-        Display.setTextColor(BLACK);
-        Display.drawString(displayName, screenWidth / 2, y);
-        Display.setTextColor(baseColor);
-      } else {
-        Display.drawString(displayName, screenWidth / 2, y);
-      }
-    }
-  }
-
-  // トラック数表示 (戻るオプション以外が選択されている場合)
-  Display.fillRect(0, 0, screenWidth, 42, BLACK);
-  if (selectedLine > 0 && (selectedLine-1) < spClient.playlistTrackCounts.size()) {
-    Display.setTextSize(1);
-    Display.drawString(String(spClient.playlistTrackCounts[selectedLine-1]) + " tracks", 
-                      screenWidth / 2, screenHeight / 2 - 94);
-  }
-  
-  // ナビゲーションヘルプの表示
-  //Display.drawString("Select: Press", screenWidth / 2, screenHeight - 20);
-}
-
-// Function to download and display playlist image
-void downloadAndDisplayPlaylistImage(String imageURL) {
-  if (currentPlaylistImageURL == imageURL) {
-      return;  // 同じ画像なら再ダウンロードしない
-  }
-  
-  if (imageURL.isEmpty()) {
-      playlistImageSprite.fillScreen(BLACK);
-      currentPlaylistImageURL = "";
-      return;
-  }
-  
-  currentPlaylistImageURL = imageURL;
-  
-  HTTPClient http;
-  http.setTimeout(10000);
-  http.begin(imageURL);
-  http.addHeader("User-Agent", "ESP32/M5Dial");
-  
-  int httpCode = http.GET();
-  
-  if (httpCode == HTTP_CODE_OK) {
-      WiFiClient *stream = http.getStreamPtr();
-      size_t size = http.getSize();
-      
-      if (size > 0) {
-          playlistImageSprite.fillScreen(BLACK);  // スプライトをクリア
-          
-          // エラーハンドリングを強化
-          uint8_t *buffer = (uint8_t *)malloc(size);
-          if (buffer) {
-              size_t bytesRead = stream->readBytes(buffer, size);
-              
-              // バッファからスプライトに描画、失敗時の処理を追加
-              if (!playlistImageSprite.drawJpg(buffer, bytesRead)) {
-                  // 画像描画失敗時はプレースホルダーを表示
-                  playlistImageSprite.fillRect(0, 0, 50, 50, baseColor);
-                  playlistImageSprite.setTextColor(BLACK);
-                  playlistImageSprite.drawString("", 25, 25);
-              }
-              free(buffer);
-          } else {
-              // メモリ確保失敗時の処理
-              playlistImageSprite.fillRect(0, 0, 50, 50, baseColor);
-              playlistImageSprite.setTextColor(BLACK);
-              playlistImageSprite.drawString("!", 25, 25);
-          }
-      }
-  } else {
-      // HTTP要求失敗時の処理
-      playlistImageSprite.fillRect(0, 0, 50, 50, baseColor);
-      playlistImageSprite.setTextColor(BLACK);
-      playlistImageSprite.drawString("X", 25, 25);
+// 再生画面・メニュー・一覧の画面ロジックはPlayerScreens（ホストのシミュレータと共通）
+// SPClientをPlayerScreensのPlayerServiceとして渡す
+class SpotifyService : public PlayerService
+{
+public:
+  const PlaybackChannel &playback() override { return spClient.playback; }
+  const EntryStore &devices() override { return spClient.devices; }
+  const EntryStore &playlists() override { return spClient.playlists; }
+
+  int getPlaybackState() override { return spClient.getPlaybackState(); }
+  int getDeviceList() override { return spClient.getDeviceList(); }
+  int getUserPlaylists() override { return spClient.getUserPlaylists(); }
+  int changeVolume(int volume) override { return spClient.changeVolume(volume); }
+  int resumePlayback() override { return spClient.resumePlayback(); }
+  int pausePlayback() override { return spClient.pausePlayback(); }
+  int skipToNext() override { return spClient.skipToNext(); }
+  int skipToPrev() override { return spClient.skipToPrev(); }
+  int selectDevice(const String &deviceID) override { return spClient.selectDevice(deviceID); }
+  int playPlaylist(const String &playlistId) override { return spClient.playPlaylist(playlistId); }
+};
+
+// M5Dialの入力・描画タスク・アルバムアート・サムネイル・設定の保存
+class DialHost : public PlayerHost
+{
+public:
+  boolean buttonReleased() override { return M5Dial.BtnA.wasReleased(); }
+  boolean buttonLongReleased() override { return M5Dial.BtnA.wasReleaseFor(1000); }
+  boolean tapped(int32_t &x, int32_t &y) override
+  {
+    auto touchDetail = M5Dial.Touch.getDetail();
+    if (touchDetail.state != m5::touch_state_t::touch_end)
+      return false;
+    x = touchDetail.x;
+    y = touchDetail.y;
+    return true;
   }
-  http.end();
-}
+  void beep(uint32_t millis) override { M5Dial.Speaker.tone(8000, millis); }
 
-// スクロールテキストの更新処理
-void updateScrollingText() {
-  static unsigned long lastUpdate = 0;
-  if (millis() - lastUpdate < scrollDelay) {
-    return;  // 更新間隔が短すぎる場合はスキップ
+  void lock() override { renderLoop.lock(); }
+  void unlock() override { renderLoop.unlock(); }
+  Compositor *activeScreen() override { return renderLoop.active(); }
+  void setActiveScreen(Compositor *screen) override { renderLoop.setActive(screen); }
+  void showLoading(const char *message) override
+  {
+    renderLoop.setActive(nullptr);
+    Display.clear();
+    drawText(message, screenWidth / 2, screenHeight / 2);
   }
-  lastUpdate = millis();
 
-  // 曲が変わったかチェック
-  if (previousTrackName != spClient.trackName) {
-    trackNameCursorX = 0;  // カーソル位置をリセット
-    isTrackScrolling = false;
-    previousTrackName = spClient.trackName;
-  }
+  void loadArt(const char *imageURL) override { downloadAndDisplayAlbumArt(imageURL); }
+  void playbackShown(uint8_t changes) override { scheduler.after(lastScreenSaveMillis, saveLastScreen); }
 
-  // アーティストが変わったかチェック
-  if (previousArtistName != spClient.artistName) {
-    artistNameCursorX = 0;  // カーソル位置をリセット
-    isArtistScrolling = false;
-    previousArtistName = spClient.artistName;
+  // プレイリストはバックグラウンドで読み込んだサムネイルを行の左に表示
+  void playlistsLoaded(int focus) override
+  {
+    thumbnailLoader.setSource(&spClient.playlists, PlaylistImageURL);
+    thumbnailLoader.setFocus(focus);
   }
-
-  bool needUpdate = false;  // スクロールが必要か判定
-
-  // Track nameのスクロール処理
-  int16_t trackWidth = trackNameSprite.textWidth(spClient.trackName);
-  if (trackWidth > 100) {  // スプライトの幅より大きい場合のみスクロール
-    needUpdate = true;
-
-    if (!isTrackScrolling && millis() - trackPauseTime > textPause) {
-      isTrackScrolling = true;
-    }
-    
-    if (isTrackScrolling) {
-      trackNameCursorX--;
-      if (trackNameCursorX < -trackWidth) {
-        trackNameCursorX = 100;  // スプライトの幅
-        isTrackScrolling = false;
-        trackPauseTime = millis();
-      }
-    }
+  void playlistFocused(int focus) override { thumbnailLoader.setFocus(focus); }
+  void playlistsClosed() override { thumbnailLoader.clear(); }
+  boolean playlistIconsChanged() override { return thumbnailLoader.takeUpdated(); }
+  boolean drawPlaylistIcon(int index, LovyanGFX *dst, int32_t x, int32_t y) override
+  {
+    return thumbnailLoader.draw(index, dst, x, y);
   }
-
-  // Artist nameのスクロール処理
-  int16_t artistWidth = artistNameSprite.textWidth(spClient.artistName);
-  if (artistWidth > 100) {  // スプライトの幅より大きい場合のみスクロール
-    needUpdate = true;
-    if (!isArtistScrolling && millis() - artistPauseTime > textPause) {
-      isArtistScrolling = true;
-    }
-    
-    if (isArtistScrolling) {
-      artistNameCursorX--;
-      if (artistNameCursorX < -artistWidth) {
-        artistNameCursorX = 100;  // スプライトの幅
-        isArtistScrolling = false;
-        artistPauseTime = millis();
-      }
-    }
+  // Preferencesに選択を保存
+  void playlistSelected(const String &playlistId) override
+  {
+    preferences.begin("DialPlay");
+    preferences.putString("selPlaylist", playlistId);
+    preferences.end();
   }
+};
 
-  if (needUpdate) {
-    redrawPlayScreen();
-  }
-}
+SpotifyService spotifyService;
+DialHost dialHost;
+PlayerScreens playerScreens(&playerView, &spotifyService, &dialHost, &dialMotion);
 
 // Setup M5Dial
 void setup()
 {
   auto cfg = M5.config();
-  M5Dial.begin(cfg, true, false);
+  M5Dial.begin(cfg, false, false);
   Serial.begin(115200);
-  delay(1000); 
   Serial.println("\nSetup initiated.");
 
+  // エンコーダ・ボタン・タッチの割り込みでloop()を起こす
+  power.begin(cpuLowMHz, cpuHighMHz);
+  dialEncoder.begin(onInputInterrupt);
+  attachInterrupt(buttonPin, onInputInterrupt, CHANGE);
+  attachInterrupt(touchInterruptPin, onInputInterrupt, CHANGE);
+  power.addWakePin(encoderPinA);
+  power.addWakePin(encoderPinB);
+  power.addWakePin(buttonPin);
+  power.addWakePin(touchInterruptPin);
+
+  // 保存済みのWiFiへの接続は画面の準備と並行して進める
+  Serial.println("Attempting to connect to saved WiFi...");
+  WiFi.mode(WIFI_STA);
+  wifiCachedJoin = wifiCache.load() && wifiCache.beginCached(rtcSeconds());
+  if (!wifiCachedJoin)
+  {
+    wifiCache.beginScan();
+  }
+
   Display.begin();
   M5Dial.update();
 
   // スプライトの初期化
-  albumArtSprite.setColorDepth(16);    
-  albumArtSprite.createSprite(50, 50);
+  albumArtDecodeSprite.setColorDepth(16);
+  albumArtDecodeSprite.createSprite(artSize, artSize);
   
-  // プレイリスト画像用スプライトの初期化
-  playlistImageSprite.setColorDepth(16);
-  playlistImageSprite.createSprite(50, 50);
-
-  trackNameSprite.setColorDepth(8);
-  trackNameSprite.setFont(&fonts::lgfxJapanGothic_20);
-  trackNameSprite.setTextWrap(false);
-  trackNameSprite.createSprite(110, 25);  // 適切なサイズに調整
-
-  artistNameSprite.setColorDepth(8);
-  artistNameSprite.setFont(&fonts::lgfxJapanGothic_20);
-  artistNameSprite.setTextWrap(false);
-  artistNameSprite.createSprite(110, 25);  // 適切なサイズに調整
+  // プレイリストのサムネイルローダーを開始
+  thumbnailLoader.begin(thumbnailSize, thumbnailWindow, thumbnailFetches);
 
-  oldPosition = M5Dial.Encoder.read();
+  playerView.begin(&Display, thumbnailSize);
 
   Display.setTextColor(baseColor);
   Display.setTextDatum(middle_center);
   Display.setFont(&fonts::lgfxJapanGothic_20);
   Display.setTextSize(1);
+  glyphCache.begin(&fonts::lgfxJapanGothic_20, glyphCacheGlyphs, glyphCacheSlotBytes);
+  renderLoop.begin(renderFramesPerSecond, renderTaskPriority, renderTaskCore);
+  if (renderProfiler.begin())
+  {
+    renderLoop.setProfiler(&renderProfiler);
+  }
+
+  // heap_caps_mallocで確保したバッファはmallocの集計に入らないので手動で計上する
+  memoryBudget.charge(MemoryImages, playerView.art()->bufferLength() + albumArtDecodeSprite.bufferLength());
+  memoryBudget.charge(MemoryUI, 2 * (playBandPixels + listBandPixels) * sizeof(uint16_t));
+  memoryBudget.charge(MemoryUI, glyphCacheGlyphs * glyphCacheSlotBytes);
+  memoryBudget.setBudget(MemoryParser, parserBudgetBytes);
+  memoryBudget.setBudget(MemoryClient, clientBudgetBytes);
+  memoryBudget.setBudget(MemoryImages, imagesBudgetBytes);
+  memoryBudget.setBudget(MemoryUI, uiBudgetBytes);
+  memoryBudget.setBudget(MemoryWeb, webBudgetBytes);
+  memoryBudget.setReserve(memoryReserveBytes);
+  memoryBudget.watchTask(xTaskGetCurrentTaskHandle(), "loop", stackMarginBytes);
+  memoryBudget.watchTask(renderLoop.taskHandle(), "render", stackMarginBytes);
+  for (int i = 0; i < thumbnailLoader.workerCount(); i++)
+  {
+    memoryBudget.watchTask(thumbnailLoader.worker(i), "thumbnail", stackMarginBytes);
+  }
+  memoryBudget.sample();
+
+  if (SerialConsole::enabled())
+  {
+    console.begin(&Serial);
+    console.add("metrics", "print /metrics", consoleMetrics);
+    console.add("stats", "loop, request, render and memory statistics", consoleStats);
+    console.add("trace", "print the trace ring", consoleTrace);
+    console.add("bench", "bench json|jpeg|push|sha256|tls|nvs|spotify|all [iterations] (push draws over the screen)",
+                consoleBench);
+    console.add("api", "api http://host:port|default: send Spotify requests to tools/replay.py", consoleApi);
+    Serial.println("Console ready, type help");
+  }
 
   // Reset if button is pressed when power-on
   if (M5Dial.BtnA.isPressed()) {
@@ -411,31 +381,91 @@ void setup()
     return;
   }
 
-  // Connect if WiFi saved
-  Serial.println("Attempting to connect to saved WiFi...");
-  WiFi.mode(WIFI_STA);
-  WiFi.begin();
-  int timeout = 0;
-  while (WiFi.status() != WL_CONNECTED)
+  // 前回の画面を先に表示し、接続・トークン更新・再生状態の取得が終わり次第更新する
+  bootFromLastScreen = lastScreen.load();
+  if (bootFromLastScreen)
   {
-    delay(500);
-    Serial.print(".");
-    timeout++;
-    if (timeout > 20) // Timeout. restart from scanWiFi
-    {
-      Serial.println("\nWiFi connection timeout. Starting AP mode.");
-      scanWiFi();
-      startWiFiAP();
-      showAPQRcode();
-      return;
-    }
+    showLastScreen();
   }
-  Serial.println("\nWiFi connected.");
+  scheduler.after(bootPollMillis, logBootTiming);
+  scheduler.after(loopStatsMillis, logLoopStats);
+  if (RequestTrace::enabled())
+  {
+    scheduler.after(traceStatsMillis, logRequestTrace);
+  }
+  if (RenderProfiler::enabled())
+  {
+    scheduler.after(renderStatsMillis, logRenderProfile);
+  }
+  scheduler.after(memoryStatsMillis, logMemory);
+  if (MetricsWriter::enabled())
+  {
+    webServer.on("/metrics", HTTP_GET, handleMetrics);
+  }
+
+  joinWiFi(startSpotify);
+}
+
+// Draw the saved play screen. Widgets are replaced by live values as they arrive
+void showLastScreen()
+{
+  const LastScreen::Record &record = lastScreen.record();
+  renderLoop.lock();
+  LGFX_Sprite *art = playerView.art();
+  memcpy(art->getBuffer(), record.art, min(sizeof(record.art), (size_t)art->bufferLength()));
+  playerView.artChanged();
+  playerView.setVolumeVisible(record.supportsVolume);
+  playerView.setVolume(record.volume);
+  playerView.setPlaying(record.isPlaying);
+  playerView.setTrack(record.trackName);
+  playerView.setArtist(record.artistName);
+  renderLoop.setActive(playerView.playScreen());
+  renderLoop.unlock();
+
+  // 最初の再生状態は、表示中の内容との差分で反映する
+  PlaybackSnapshot shown;
+  shown.clear();
+  PlaybackSnapshot::copyText(shown.trackName, sizeof(shown.trackName), record.trackName);
+  PlaybackSnapshot::copyText(shown.artistName, sizeof(shown.artistName), record.artistName);
+  PlaybackSnapshot::copyText(shown.imageURL, sizeof(shown.imageURL), record.imageURL);
+  shown.supportsVolume = record.supportsVolume;
+  shown.isPlaying = record.isPlaying;
+  shown.volume = record.volume;
+  playerScreens.restore(shown);
+
+  // 同じ画像なら再ダウンロードしない
+  currentImageURL = record.imageURL;
+}
+
+// Keep what the play screen shows for the next boot. Writes only if it changed
+void saveLastScreen()
+{
+  lastScreen.capture(playerScreens.shown(), playerView.art());
+  if (!lastScreen.save())
+  {
+    log_e("Failed to save last screen");
+  }
+}
+
+// Log when the first meaningful pixel reached the panel
+void logBootTiming()
+{
+  uint32_t firstPixel = renderLoop.firstPixelMillis();
+  if (!firstPixel)
+  {
+    scheduler.after(bootPollMillis, logBootTiming);
+    return;
+  }
+  log_i("Boot: first pixel at %u ms (%s)", firstPixel, bootFromLastScreen ? "last screen" : "live");
+}
 
+// Continue the boot sequence once WiFi is connected
+void startSpotify()
+{
   // Preferences
   preferences.begin("DialPlay");
   spClient.refreshToken = preferences.getString("refreshToken");
-  selectedPlaylistId = preferences.getString("selPlaylist"); // 選択されたプレイリストの読み込み
+  playerScreens.setSelectedPlaylist(preferences.getString("selPlaylist")); // 選択されたプレイリストの読み込み
   if (spClient.refreshToken.length())
   {
     Serial.println("Found refresh token. Attempting to refresh access token...");
@@ -444,13 +474,7 @@ void setup()
       Serial.println("Access token refreshed successfully.");
       preferences.putString("refreshToken", spClient.refreshToken);
       preferences.end();
-      delay(100);
-      needFullClear = true;
-      showPlayScreen();
-      if (spClient.trackName.isEmpty())
-      {
-        showDeviceScreen();
-      }
+      showFirstPlayScreen();
       return;
     }
     Serial.println("Failed to refresh access token.");
@@ -467,6 +491,7 @@ void setup()
   webServer.on("/", HTTP_OPTIONS, handleCodeReceiverOptions);
   webServer.on("/", HTTP_POST, handleCodeReceiver);
   webServer.begin();
+  webServerStarted = true;
 
   myIP = WiFi.localIP();
   Serial.print("IP Address: ");
@@ -475,7 +500,8 @@ void setup()
   if (!MDNS.begin("dialplayredirect")) {
     Serial.println("Error setting up MDNS responder!");
     showMessage("mDNS Error! Check WiFi AP Isolation settings.", true);
-    while(1) { delay(1000); } // Stop execution
+    screenState = StateError; // Stop here
+    return;
   }
   Serial.println("mDNS responder started: dialplayredirect.local");
   
@@ -483,304 +509,338 @@ void setup()
   showSpotifyAuthQRcode();
 }
 
-// Main loop M5Dial
-void loop()
+// Show the player after authorization, or the device list if nothing is playing
+void showFirstPlayScreen()
 {
-  M5Dial.update();
-  if (screenState <= StateAPFormQRcode)
+  screenState = StatePlayer;
+  playerScreens.begin();
+  if (!bootLiveMillis)
   {
-    dnsServer.processNextRequest();
+    bootLiveMillis = millis();
+    log_i("Boot: live state at %u ms", bootLiveMillis);
   }
-  if (screenState <= StateWaitAuth)
+  if (MetricsWriter::enabled() && !metricsServing)
   {
-    webServer.handleClient();
+    if (!webServerStarted)
+    {
+      webServer.begin();
+      webServerStarted = true;
+    }
+    metricsServing = true;
+    Serial.printf("Metrics: http://%s/metrics\n", WiFi.localIP().toString().c_str());
   }
-
-  switch (screenState)
+  if (!playerScreens.playing().trackName[0])
   {
-  case StatePlay:
+    playerScreens.showDevices();
+  }
+}
+
+// Log the longest loop() iteration of the last period
+void logLoopStats()
+{
+  log_i("Loop: max %u us", scheduler.maxLoopMicros());
+  scheduler.resetLoopStats();
+  scheduler.after(loopStatsMillis, logLoopStats);
+}
+
+void logRequestTrace()
+{
+  RequestTrace::print(Serial);
+  scheduler.after(traceStatsMillis, logRequestTrace);
+}
+
+// 前回の出力以降に描画したフレームの集計
+void logRenderProfile()
+{
+  renderLoop.lock();
+  renderProfiler.print(Serial);
+  renderProfiler.reset();
+  renderLoop.unlock();
+  scheduler.after(renderStatsMillis, logRenderProfile);
+}
+
+// 予算超過・連続領域不足・スタック残量を確認（警告は毎回、集計はmemory-budget環境のみ出力）
+void logMemory()
+{
+  memoryBudget.sample();
+  if (MemoryBudget::enabled())
   {
-    // Refresh token if needed
-    if (spClient.needsRefresh)
-    {
-      if (spClient.refreshAccessToken() == 200)
-      {
-        preferences.begin("DialPlay");
-        preferences.putString("refreshToken", spClient.refreshToken);
-        preferences.end();
-      }
-      if (spClient.accessToken.isEmpty())
-      {
-        showSpotifyAuthQRcode();
-      }
-      return;
-    }
+    memoryBudget.print(Serial);
+  }
+  scheduler.after(memoryStatsMillis, logMemory);
+}
 
-    if (M5Dial.BtnA.wasReleased())
+// Prometheus text format for a local collector. Streamed in small chunks
+void handleMetrics()
+{
+  MetricsWriter out(&webServer);
+  writeMetrics(out);
+}
+
+void writeMetrics(MetricsWriter &out)
+{
+  out.type("dialplay_uptime_seconds", "gauge", "Time since boot");
+  out.sample("dialplay_uptime_seconds", nullptr, millis() / 1000.0f);
+
+  out.requestHistograms();
+
+  out.type("dialplay_frame_seconds", "gauge", "Render task frame time");
+  out.sample("dialplay_frame_seconds", "stat=\"last\"", renderLoop.lastFrameMicros() / 1000000.0f);
+  out.sample("dialplay_frame_seconds", "stat=\"max\"", renderLoop.maxFrameMicros() / 1000000.0f);
+  out.type("dialplay_frames_total", "counter", "Frames rendered");
+  out.sample("dialplay_frames_total", nullptr, renderLoop.frameCount());
+  out.type("dialplay_frames_missed_total", "counter", "Frames longer than the frame period");
+  out.sample("dialplay_frames_missed_total", nullptr, renderLoop.missedFrames());
+
+  out.type("dialplay_loop_seconds", "gauge", "loop() iteration time without the idle wait");
+  out.sample("dialplay_loop_seconds", "stat=\"last\"", scheduler.lastLoopMicros() / 1000000.0f);
+  out.sample("dialplay_loop_seconds", "stat=\"max\"", scheduler.maxLoopMicros() / 1000000.0f);
+
+  out.type("dialplay_heap_free_bytes", "gauge", "Free heap");
+  out.sample("dialplay_heap_free_bytes", "region=\"internal\"", (uint32_t)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+  out.sample("dialplay_heap_free_bytes", "region=\"psram\"", (uint32_t)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+  out.type("dialplay_heap_largest_block_bytes", "gauge", "Largest free heap block");
+  out.sample("dialplay_heap_largest_block_bytes", "region=\"internal\"", (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+  out.sample("dialplay_heap_largest_block_bytes", "region=\"psram\"", (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+  out.type("dialplay_heap_minimum_free_bytes", "gauge", "Lowest free internal heap since boot");
+  out.sample("dialplay_heap_minimum_free_bytes", "region=\"internal\"", (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+  out.type("dialplay_heap_fragmentation_ratio", "gauge", "1 - largest free block / free internal heap, at the last memory sample");
+  out.sample("dialplay_heap_fragmentation_ratio", nullptr, memoryBudget.fragmentationPercent() / 100.0f);
+  if (MemoryBudget::enabled())
+  {
+    // サブシステムごとのヒープ使用量
+    out.type("dialplay_memory_bytes", "gauge", "Heap held per subsystem");
+    char memoryLabels[metricsLabelBytes];
+    for (int subsystem = 0; subsystem < MemorySubsystemCount; subsystem++)
     {
-      M5Dial.Speaker.tone(8000, 20);
-      // 変更：showDeviceScreen()からshowMenuScreen()に
-      showMenuScreen();
-      return;
+      const char *name = MemoryBudget::subsystemName(subsystem);
+      snprintf(memoryLabels, sizeof(memoryLabels), "subsystem=\"%s\",stat=\"current\"", name);
+      out.sample("dialplay_memory_bytes", memoryLabels, memoryBudget.current(subsystem));
+      snprintf(memoryLabels, sizeof(memoryLabels), "subsystem=\"%s\",stat=\"peak\"", name);
+      out.sample("dialplay_memory_bytes", memoryLabels, memoryBudget.peak(subsystem));
+      snprintf(memoryLabels, sizeof(memoryLabels), "subsystem=\"%s\",stat=\"budget\"", name);
+      out.sample("dialplay_memory_bytes", memoryLabels, memoryBudget.budget(subsystem));
     }
-    
-    // 長押しで即座にプレイリスト再生
-    if (M5Dial.BtnA.wasReleaseFor(1000) && !selectedPlaylistId.isEmpty())
+    out.type("dialplay_memory_failed_allocations_total", "counter", "Allocations that returned null");
+    for (int subsystem = 0; subsystem < MemorySubsystemCount; subsystem++)
     {
-      M5Dial.Speaker.tone(8000, 50);
-      spClient.playPlaylist(selectedPlaylistId);
-      delay(100);
-      needFullClear = true;
-      showPlayScreen();
-      return;
+      snprintf(memoryLabels, sizeof(memoryLabels), "subsystem=\"%s\"", MemoryBudget::subsystemName(subsystem));
+      out.sample("dialplay_memory_failed_allocations_total", memoryLabels, memoryBudget.failures(subsystem));
     }
-    
-    // Dial
-    if (spClient.supportsVolume)
-    {
-      long newPosition = M5Dial.Encoder.read();
-
-      // Position changed
-      if (newPosition != oldPosition)
-      {
-        tempVolume += newPosition - oldPosition;
-        if (tempVolume < 0)
-          tempVolume = 0;
-        else if (tempVolume > 100)
-          tempVolume = 100;
-        oldPosition = newPosition;
-        oldMillis = millis();
-        Display.fillArc(screenWidth / 2, screenHeight / 2, screenWidth / 2, screenWidth / 2 - 8, 270, (360 + 270), BLACK);
-        Display.fillArc(screenWidth / 2, screenHeight / 2, screenWidth / 2, screenWidth / 2 - 8, 270, (360 * ((float)tempVolume / 100.0f) + 270), baseColor);
-      }
+  }
 
-      // Position not changed. Wait 1 second and request volume change
-      else
-      {
-        if (millis() - oldMillis > 1000 && tempVolume != spClient.volume)
-        {
-          M5Dial.Speaker.tone(8000, 20);
-          spClient.changeVolume(tempVolume);
-          delay(100);
-          needFullClear = true;
-          showPlayScreen();
-          return;
-        }
-      }
-    }
+  // スタックの残りの最小値（バイト）
+  out.type("dialplay_task_stack_free_bytes", "gauge", "Stack high-water mark");
+  out.sample("dialplay_task_stack_free_bytes", "task=\"loop\"", (uint32_t)uxTaskGetStackHighWaterMark(nullptr));
+  out.sample("dialplay_task_stack_free_bytes", "task=\"render\"", (uint32_t)uxTaskGetStackHighWaterMark(renderLoop.taskHandle()));
+  char labels[metricsLabelBytes];
+  for (int i = 0; i < thumbnailLoader.workerCount(); i++)
+  {
+    snprintf(labels, sizeof(labels), "task=\"thumbnail%d\"", i);
+    out.sample("dialplay_task_stack_free_bytes", labels, (uint32_t)uxTaskGetStackHighWaterMark(thumbnailLoader.worker(i)));
+  }
 
-    // Auto redraw
-    if (refreshMillis != 0 && refreshMillis < millis())
-    {
-      refreshMillis = 0;
-      needFullClear = true;
-      showPlayScreen();
-      return;
-    }
+  out.type("dialplay_glyph_cache_lookups_total", "counter", "Glyph cache lookups");
+  out.sample("dialplay_glyph_cache_lookups_total", "result=\"hit\"", glyphCache.hits());
+  out.sample("dialplay_glyph_cache_lookups_total", "result=\"miss\"", glyphCache.misses());
+  out.type("dialplay_glyph_cache_evictions_total", "counter", "Glyphs evicted from the cache");
+  out.sample("dialplay_glyph_cache_evictions_total", nullptr, glyphCache.evictions());
+  out.type("dialplay_glyph_cache_hit_ratio", "gauge", "Glyph cache hits per lookup");
+  out.sample("dialplay_glyph_cache_hit_ratio", nullptr, glyphCache.hitRate());
+
+  out.type("dialplay_cpu_mhz", "gauge", "Current CPU clock");
+  out.sample("dialplay_cpu_mhz", nullptr, (uint32_t)getCpuFrequencyMhz());
+  out.type("dialplay_idle_seconds_total", "counter", "Time loop() spent waiting for events");
+  out.sample("dialplay_idle_seconds_total", nullptr, power.idleMillis() / 1000.0f);
+  out.type("dialplay_input_wakeups_total", "counter", "Input interrupts that woke loop()");
+  out.sample("dialplay_input_wakeups_total", nullptr, power.wakeCount());
+}
 
-    // Touch
-    auto touchDetail = M5Dial.Touch.getDetail();
-    if (touchDetail.state == m5::touch_state_t::touch_end)
-    {
-      // Play or Pause
-      //if (touchDetail.y > 75 && touchDetail.y < (75 + 60))
-      if (touchDetail.y > 65 && touchDetail.y < (65 + 60))
-      {
-        if (touchDetail.x > 95 && touchDetail.x < (screenWidth - 95))
-        {
-          if (spClient.isPlaying)
-          {
-            M5Dial.Speaker.tone(8000, 20);
-            spClient.pausePlayback();
-          }
-          else
-          {
-            M5Dial.Speaker.tone(8000, 20);
-            spClient.resumePlayback();
-          }
-          spClient.getPlaybackState();
-          redrawPlayScreen();
-        }
-        else if (touchDetail.x < 75)
-        {
-          M5Dial.Speaker.tone(8000, 20);
-          spClient.skipToPrev();
-          delay(100);
-          needFullClear = false;
-          showPlayScreen();
-        }
-        else if (touchDetail.x > (75 + 60))
-        {
-          M5Dial.Speaker.tone(8000, 20);
-          spClient.skipToNext();
-          delay(100);
-          needFullClear = false;
-          showPlayScreen();
-        }
-      }
-    }
-    updateScrollingText();  // スクロール更新
+void consoleMetrics(Print &out, const char *args)
+{
+  MetricsWriter metrics(&out);
+  writeMetrics(metrics);
+}
+
+void consoleStats(Print &out, const char *args)
+{
+  out.printf("uptime %u s, loop max %u us, frames %u (missed %u, max %u us)\n", millis() / 1000, scheduler.maxLoopMicros(),
+             renderLoop.frameCount(), renderLoop.missedFrames(), renderLoop.maxFrameMicros());
+  RequestTrace::print(out);
+  renderLoop.lock();
+  renderProfiler.print(out);
+  renderLoop.unlock();
+  memoryBudget.sample();
+  memoryBudget.print(out);
+}
+
+void consoleTrace(Print &out, const char *args)
+{
+  Trace::print(out);
+}
+
+// 同じ負荷で機種・ビルドを比較するためのベンチマーク
+void consoleBench(Print &out, const char *args)
+{
+  char name[16];
+  int iterations = 0;
+  if (sscanf(args, "%15s %d", name, &iterations) < 1)
+  {
+    out.println("usage: bench json|jpeg|push|sha256|tls|nvs|spotify|all [iterations]");
     return;
   }
-  
-  case StateMenu:
+  boolean all = strcmp(name, "all") == 0;
+  int count = iterations > 0 ? iterations : benchIterations;
+  boolean ran = false;
+
+  if (all || strcmp(name, "json") == 0)
   {
-    // ボタン押下で選択
-    if (M5Dial.BtnA.wasReleased())
-    {
-      M5Dial.Speaker.tone(8000, 20);
-      
-      switch (selectedMenuItem)
-      {
-        case MenuDevices:
-          showDeviceScreen();
-          break;
-          
-        case MenuPlaylists:
-          showPlaylistScreen();
-          break;
-          
-        case MenuBack:
-          needFullClear = true;  // 完全リフレッシュの確保
-          showPlayScreen();
-          break;
-      }
-      return;
-    }
-    
-    // ダイヤル回転でメニュー選択
-    long newPosition = M5Dial.Encoder.read();
-    if (newPosition != oldPosition && newPosition % 4 == 0)
-    {
-      selectedMenuItem += (newPosition - oldPosition) / 4;
-      if (selectedMenuItem < 0)
-        selectedMenuItem = 0;
-      if (selectedMenuItem >= MenuItemCount)
-        selectedMenuItem = MenuItemCount - 1;
-        
-      redrawMenuScreen(selectedMenuItem);
-      oldPosition = newPosition;
-    }
+    Benchmark::jsonScan(out, count);
+    ran = true;
+  }
+  if (all || strcmp(name, "jpeg") == 0)
+  {
+    Benchmark::jpegDecode(out, count);
+    ran = true;
+  }
+  if (all || strcmp(name, "push") == 0)
+  {
+    // 描画タスクを止めてパネルを直接使う。終わったら画面を描き直す
+    Compositor *active = renderLoop.active();
+    renderLoop.setActive(nullptr);
+    Benchmark::panelPush(out, &Display, count);
+    renderLoop.setActive(active);
+    ran = true;
+  }
+  if (all || strcmp(name, "sha256") == 0)
+  {
+    Benchmark::sha256(out, count);
+    ran = true;
+  }
+  if (all || strcmp(name, "tls") == 0)
+  {
+    Benchmark::tlsHandshake(out, benchHost, SpotifyPEM, iterations > 0 ? iterations : benchTlsIterations);
+    ran = true;
+  }
+  if (all || strcmp(name, "nvs") == 0)
+  {
+    Benchmark::nvsWrite(out, count);
+    ran = true;
+  }
+  if (all || strcmp(name, "spotify") == 0)
+  {
+    Benchmark::spotify(out, spClient, iterations > 0 ? iterations : benchSpotifyIterations);
+    ran = true;
+  }
+  if (!ran)
+    out.printf("unknown benchmark: %s\n", name);
+}
+
+// 記録した通信を再生するサーバー(tools/replay.py)にAPIとトークンの要求を向ける
+void consoleApi(Print &out, const char *args)
+{
+  while (*args == ' ')
+    args++;
+  if (strcmp(args, "default") == 0)
+  {
+    spClient.setBaseURLs(nullptr, nullptr);
+  }
+  else if (strncmp(args, "http://", 7) == 0 || strncmp(args, "https://", 8) == 0)
+  {
+    spClient.setBaseURLs(args, args);
+  }
+  else
+  {
+    out.println("usage: api http://host:port|default");
     return;
   }
-  
-  case StateDeviceList:
+  out.printf("api: %s\n", spClient.apiBase().c_str());
+}
+
+// Main loop M5Dial
+void loop()
+{
+  M5Dial.update();
+  scheduler.run();
+  handleScreen();
+  scheduler.finishLoop();
+  power.idle(idleTimeout(), idleMaySleep());
+}
+
+void IRAM_ATTR onInputInterrupt()
+{
+  power.wakeFromISR();
+}
+
+// Time until loop() has something to do without new input
+uint32_t idleTimeout()
+{
+  uint32_t now = millis();
+  uint32_t timeout = scheduler.untilNext(idleMaxMillis);
+  if (screenState <= StateWaitAuth)
+    timeout = min(timeout, (uint32_t)serverPollMillis);
+  else if (metricsServing)
+    timeout = min(timeout, (uint32_t)metricsPollMillis);
+  if (SerialConsole::enabled())
+    timeout = min(timeout, (uint32_t)consolePollMillis);
+  if (now - power.lastWakeMillis() < inputSettleMillis || M5Dial.BtnA.isPressed() || M5Dial.Touch.getCount())
+    timeout = min(timeout, (uint32_t)inputPollMillis);
+
+  if (screenState == StatePlayer)
   {
-    // Toggle screen
-    if (M5Dial.BtnA.wasReleased())
-    {
-      M5Dial.Speaker.tone(8000, 20);
-      
-      if (tempDeviceIndex == 0) {
-        // 「<< Back」が選択されている場合
-        showMenuScreen();
-        return;
-      }
-      
-      // 通常のデバイス選択処理
-      int actualDeviceIndex = tempDeviceIndex - 1; // Back optionの分を調整
-      if (actualDeviceIndex >= 0 && actualDeviceIndex < spClient.deviceIDs.size())
-      {
-        String selectedDeviceID = spClient.deviceIDs[actualDeviceIndex];
-        if (selectedDeviceID != spClient.deviceID)
-        {
-          spClient.selectDevice(selectedDeviceID);
-          delay(100);
-        }
-      }
-      needFullClear = true;
-      showPlayScreen();
-      return;
-    }
-    
-    // 長押しで戻る
-    // if (M5Dial.BtnA.wasReleaseFor(1000))
-    // {
-    //   M5Dial.Speaker.tone(8000, 50);
-    //   showMenuScreen();
-    //   return;
-    // }
-    
-    long newPosition = M5Dial.Encoder.read();
+    if (playerScreens.screen() == PlayerScreenPlay && spClient.needsRefresh)
+      return 0;
+    timeout = playerScreens.untilNext(timeout);
+  }
+  return timeout;
+}
 
-    // Select device
-    if (newPosition != oldPosition && newPosition % 4 == 0)
+// Light sleep stops the tone, the web server, the console and animation frames
+boolean idleMaySleep()
+{
+  return screenState > StateWaitAuth &&
+         !SerialConsole::enabled() &&
+         !renderLoop.animating() &&
+         !M5Dial.Speaker.isPlaying() &&
+         millis() - power.lastWakeMillis() >= inputSettleMillis;
+}
+
+// Serve the current screen: servers, input and timers
+void handleScreen()
+{
+  console.poll();
+  if (screenState <= StateAPFormQRcode)
   {
-    tempDeviceIndex += (newPosition - oldPosition) / 4;
-    if (tempDeviceIndex < 0)
-      tempDeviceIndex = 0;
-    // 変更: lineCountにバックオプションを含める
-    int lineCount = 1 + spClient.deviceIDs.size(); // +1 for Back option
-    if (tempDeviceIndex >= lineCount)
-      tempDeviceIndex = lineCount - 1;
-
-    redrawDeviceScreen(tempDeviceIndex);
-    oldPosition = newPosition;
+    dnsServer.processNextRequest();
   }
-  return;
+  if (screenState <= StateWaitAuth || metricsServing)
+  {
+    MemoryScope memory(MemoryWeb);
+    webServer.handleClient();
   }
-  
-  case StatePlaylistList:
+
+  if (screenState != StatePlayer)
+  {
+    return;
+  }
+
+  // Refresh token if needed
+  if (playerScreens.screen() == PlayerScreenPlay && !playerScreens.settling() && spClient.needsRefresh)
   {
-    // ボタン押下時の処理
-    if (M5Dial.BtnA.wasReleased())
+    if (spClient.refreshAccessToken() == 200)
     {
-      M5Dial.Speaker.tone(8000, 20);
-      
-      if (tempDeviceIndex == 0) {
-        // 「<< Back」が選択されている場合
-        showMenuScreen();
-        return;
-      }
-      
-      // 通常のプレイリスト選択処理
-      int actualPlaylistIndex = tempDeviceIndex - 1; // Back optionの分を調整
-      if (spClient.playlistIds.size() > 0 && 
-          actualPlaylistIndex >= 0 && 
-          actualPlaylistIndex < spClient.playlistIds.size())
-      {
-        // 選択したプレイリストを保存
-        selectedPlaylistId = spClient.playlistIds[actualPlaylistIndex];
-        
-        // Preferencesに選択を保存
-        preferences.begin("DialPlay");
-        preferences.putString("selPlaylist", selectedPlaylistId);
-        preferences.end();
-        
-        // 選択したプレイリストを再生
-        spClient.playPlaylist(selectedPlaylistId);
-        
-        // 再生画面に戻る
-        delay(100);
-        needFullClear = true;
-        showPlayScreen();
-      }
-      return;
+      preferences.begin("DialPlay");
+      preferences.putString("refreshToken", spClient.refreshToken);
+      preferences.end();
     }
-    
-    // 長押し処理は削除（「<< Back」オプションで代替）
-    
-    long newPosition = M5Dial.Encoder.read();
-    
-    // プレイリストをスクロール
-    if (newPosition != oldPosition && newPosition % 4 == 0)
+    if (spClient.accessToken.isEmpty())
     {
-      tempDeviceIndex += (newPosition - oldPosition) / 4;
-      if (tempDeviceIndex < 0)
-        tempDeviceIndex = 0;
-      // 変更: lineCountにバックオプションを含める
-      int lineCount = 1 + spClient.playlistIds.size(); // +1 for Back option
-      if (tempDeviceIndex >= lineCount)
-        tempDeviceIndex = lineCount - 1;
-        
-      redrawPlaylistScreen(tempDeviceIndex);
-      oldPosition = newPosition;
+      showSpotifyAuthQRcode();
     }
     return;
   }
 
-
-  }
+  playerScreens.handle();
 }
 
 // Reset WiFi and Authorization
@@ -789,25 +849,58 @@ void resetWiFiAndAuth()
   // Reset
   Serial.println("Resetting WiFi and Auth data.");
   WiFi.disconnect(false, true);
+  wifiCache.useDHCP();
   preferences.begin("DialPlay");
   preferences.remove("refreshToken");
   preferences.remove("selPlaylist"); // プレイリスト選択も削除
   preferences.end();
+  lastScreen.remove();
+  wifiCache.remove();
 
   scanWiFi();
-  startWiFiAP();
-  showAPQRcode();
 }
 
-// Scan WiFi access points
+// Scan WiFi access points. Continues with startWiFiAP() when the scan is done
 void scanWiFi()
 {
   showMessage("Scanning WiFi", false);
+  screenState = StateConnecting;
   Serial.println("Scanning for WiFi networks...");
   WiFi.mode(WIFI_STA);
   WiFi.disconnect();
-  delay(100);
-  int count = WiFi.scanNetworks();
+  wifiScanFailures = 0;
+  scheduler.after(wifiSettleMillis, startWiFiScan);
+}
+
+// Runs once the disconnect has settled
+void startWiFiScan()
+{
+  WiFi.scanNetworks(true);
+  scheduler.after(wifiSettleMillis, pollWiFiScan);
+}
+
+void pollWiFiScan()
+{
+  int count = WiFi.scanComplete();
+  if (count == WIFI_SCAN_RUNNING)
+  {
+    scheduler.after(wifiSettleMillis, pollWiFiScan);
+    return;
+  }
+  if (count == WIFI_SCAN_FAILED)
+  {
+    // The scan did not start or was aborted. Not the same as no networks
+    if (++wifiScanFailures <= wifiScanRetries)
+    {
+      Serial.printf("WiFi scan failed. Retrying (%d/%d).\n", wifiScanFailures, wifiScanRetries);
+      scheduler.after(wifiSettleMillis, startWiFiScan);
+      return;
+    }
+    Serial.println("WiFi scan failed.");
+    showMessage("WiFi scan failed", true);
+    scheduler.after(wifiScanErrorMillis, scanWiFi);
+    return;
+  }
   Serial.printf("%d networks found.\n", count);
   wifiVector.clear();
   for (int i = 0; i < count; i++)
@@ -817,6 +910,7 @@ void scanWiFi()
     Serial.println(ssid);
   }
   WiFi.scanDelete();
+  startWiFiAP();
 }
 
 // Start access point mode, web server, and DNS server
@@ -824,7 +918,11 @@ void startWiFiAP()
 {
   Serial.println("Starting Access Point mode...");
   WiFi.disconnect();
-  delay(100);
+  scheduler.after(wifiSettleMillis, openWiFiAP);
+}
+
+void openWiFiAP()
+{
   WiFi.softAP(AP_ssid.c_str(), AP_pass.c_str());
   WiFi.softAPConfig(myAPIP, myAPIP, subnet);
   myIP = WiFi.softAPIP();
@@ -840,19 +938,91 @@ void startWiFiAP()
   webServer.on("/", HTTP_OPTIONS, handleCodeReceiverOptions);
   webServer.on("/", HTTP_POST, handleCodeReceiver);
   webServer.begin();
+  webServerStarted = true;
 
   // Start DNS
   Serial.println("Starting DNS Server.");
   dnsServer.start(53, "*", myIP);
+  showAPQRcode();
+}
+
+// Wait for WiFi.begin() without blocking. Runs joined when connected,
+// falls back to the access point setup on timeout
+void joinWiFi(SchedulerStep joined)
+{
+  screenState = StateConnecting;
+  wifiJoinedStep = joined;
+  wifiJoinCount = 0;
+  pollWiFiJoin();
+}
+
+void pollWiFiJoin()
+{
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    Serial.printf("\nWiFi connected at %u ms%s.\n", millis(), wifiCachedJoin ? " (cached)" : "");
+    wifiCachedJoin = false;
+    wifiCache.store(rtcSeconds());
+    wifiJoinedStep();
+    return;
+  }
+  if (wifiCachedJoin)
+  {
+    // The access point moved or the lease is gone. Join again with scan and DHCP
+    if (++wifiJoinCount > wifiCachedJoinPolls)
+    {
+      Serial.println("\nCached WiFi join failed. Retrying with scan.");
+      wifiCachedJoin = false;
+      WiFi.disconnect();
+      scheduler.after(wifiSettleMillis, rejoinWiFi);
+      return;
+    }
+    scheduler.after(wifiCachedPollMillis, pollWiFiJoin);
+    return;
+  }
+  if (++wifiJoinCount > wifiJoinPolls) // Timeout. restart from scanWiFi
+  {
+    Serial.println("\nWiFi connection timeout. Starting AP mode.");
+    scanWiFi();
+    return;
+  }
+  Serial.print(".");
+  scheduler.after(wifiPollMillis, pollWiFiJoin);
+}
+
+void rejoinWiFi()
+{
+  wifiCache.beginScan();
+  wifiJoinCount = 0;
+  pollWiFiJoin();
+}
+
+// Seconds on the RTC, for the age of the cached DHCP lease. 0 if the RTC
+// is missing or lost its time (the clock was stopped, so the age is unknown)
+uint32_t rtcSeconds()
+{
+  if (!M5Dial.Rtc.isEnabled() || M5Dial.Rtc.getVoltLow())
+    return 0;
+  m5::rtc_datetime_t now = M5Dial.Rtc.getDateTime();
+  struct tm time = {};
+  time.tm_year = now.date.year - 1900;
+  time.tm_mon = now.date.month - 1;
+  time.tm_mday = now.date.date;
+  time.tm_hour = now.time.hours;
+  time.tm_min = now.time.minutes;
+  time.tm_sec = now.time.seconds;
+  time_t seconds = mktime(&time);
+  return seconds > 0 ? seconds : 0;
 }
 
 // Show QR code to transfer WiFi info
 void showAPQRcode()
 {
+  renderLoop.setActive(nullptr);
   String info = "WIFI:S:" + AP_ssid + ";T:WPA;P:" + AP_pass + ";;";
   Display.clear();
   Display.qrcode(info, (screenWidth - qrcodeWidth) / 2, (screenWidth - qrcodeWidth) / 2, qrcodeWidth);
-  Display.drawString("Scan WiFi", (screenWidth) / 2, (screenWidth - qrcodeWidth) / 2 + qrcodeWidth + 10);
+  drawText("Scan WiFi", (screenWidth) / 2, (screenWidth - qrcodeWidth) / 2 + qrcodeWidth + 10);
   screenState = StateAPQRcode;
   M5Dial.Speaker.tone(8000, 20);
 }
@@ -860,10 +1030,11 @@ void showAPQRcode()
 // Show QR code for form URL (not used when captive portal detected)
 void showAPFormQRcode()
 {
+  renderLoop.setActive(nullptr);
   String urlString = "http://" + String(myIP[0]) + "." + String(myIP[1]) + "." + String(myIP[2]) + "." + String(myIP[3]) + "/formwifi";
   Display.clear();
   Display.qrcode(urlString, (screenWidth - qrcodeWidth) / 2, (screenHeight - qrcodeWidth) / 2, qrcodeWidth);
-  Display.drawString("Scan IP", (screenWidth) / 2, (screenHeight - qrcodeWidth) / 2 + qrcodeWidth + 10);
+  drawText("Scan IP", (screenWidth) / 2, (screenHeight - qrcodeWidth) / 2 + qrcodeWidth + 10);
   screenState = StateAPFormQRcode;
   M5Dial.Speaker.tone(8000, 20);
 }
@@ -876,25 +1047,19 @@ void startWiFiST()
   Serial.println("Switching to Station mode...");
   dnsServer.stop();
   WiFi.disconnect();
-  delay(100);
+  scheduler.after(wifiSettleMillis, joinWiFiST);
+}
+
+void joinWiFiST()
+{
   WiFi.mode(WIFI_STA);
+  wifiCache.useDHCP();
   WiFi.begin(ST_ssid.c_str(), ST_pass.c_str());
-  int timeout = 0;
-  while (WiFi.status() != WL_CONNECTED)
-  {
-    delay(500);
-    Serial.print(".");
-    timeout++;
-    if (timeout > 20) // Timeout. restart from scanWiFi
-    {
-      Serial.println("\nWiFi connection timeout. Starting AP mode.");
-      scanWiFi();
-      startWiFiAP();
-      showAPQRcode();
-      return;
-    }
-  }
+  joinWiFi(onWiFiSTConnected);
+}
 
+void onWiFiSTConnected()
+{
   // Connected
   showMessage("WiFi ST Connected", false);
   Serial.println("\nWiFi ST Connected.");
@@ -916,10 +1081,11 @@ void startWiFiST()
 // Show QR code to redirect smartphone browser to Spotify authorization URL
 void showSpotifyAuthQRcode()
 {
+  renderLoop.setActive(nullptr);
   Display.clear();
   Display.qrcode(spotifyAuthURLString, (screenWidth - qrcodeWidth) / 2, (screenHeight - qrcodeWidth) / 2 - 10, qrcodeWidth);
-  Display.drawString("Spotify Auth", (screenWidth) / 2, (screenHeight - qrcodeWidth) / 2 + qrcodeWidth);
-  Display.drawString(myIP.toString(), screenWidth / 2, (screenHeight - qrcodeWidth) / 2 + qrcodeWidth + 20);
+  drawText("Spotify Auth", (screenWidth) / 2, (screenHeight - qrcodeWidth) / 2 + qrcodeWidth);
+  drawText(myIP.toString(), screenWidth / 2, (screenHeight - qrcodeWidth) / 2 + qrcodeWidth + 20);
   screenState = StateAuthQRcode;
   M5Dial.Speaker.tone(8000, 20);
   Serial.println("Displaying Spotify Auth QR Code.");
@@ -927,233 +1093,77 @@ void showSpotifyAuthQRcode()
   Serial.println(spotifyAuthURLString);
 }
 
-void downloadAndDisplayAlbumArt() {
-  Serial.println("--- Start downloadAndDisplayAlbumArt ---");
-  Serial.printf("Current URL: %s\n", currentImageURL.c_str());
-  Serial.printf("New URL from spClient: %s\n", spClient.imageURL.c_str());
-
-  if (currentImageURL == spClient.imageURL) {
-    Serial.println("Same image URL, skipping download.");
+void downloadAndDisplayAlbumArt(const char *imageURL) {
+  MemoryScope memory(MemoryImages);
+  if (currentImageURL == imageURL) {
+    trace_d(traceImage, "album art unchanged");
     return;
   }
 
-  if (spClient.imageURL.isEmpty()) {
-    Serial.println("Image URL is empty, clearing sprite.");
-    albumArtSprite.fillScreen(BLACK);
+  if (!imageURL[0]) {
+    trace_i(traceImage, "album art cleared");
+    renderLoop.lock();
+    playerView.art()->fillScreen(BLACK);
+    playerView.artChanged();
+    renderLoop.unlock();
     currentImageURL = "";
     return;
   }
 
-  currentImageURL = spClient.imageURL;
-  Serial.println("Starting HTTP request for new image...");
+  currentImageURL = imageURL;
+  trace_text(traceLevelInfo, traceImage, "album art %s", imageURL);
+  uint32_t start = micros();
 
+  PowerBoost boost;  // TLSとJPEGデコードの間だけクロックを上げる
   HTTPClient http;
   http.setTimeout(10000);  // タイムアウトを10秒に設定
-  http.begin(spClient.imageURL);
+  http.begin(imageURL);
   
   // User-Agentヘッダーを追加
   http.addHeader("User-Agent", "ESP32/M5Dial");
   
   int httpCode = http.GET();
-  Serial.printf("HTTP response code: %d\n", httpCode);
-
   if (httpCode == HTTP_CODE_OK) {
     WiFiClient *stream = http.getStreamPtr();
     size_t size = http.getSize();
-    Serial.printf("Image size: %d bytes\n", size);
+    trace_i(traceImage, "album art GET %d, %u bytes", httpCode, size);
     
     if (size > 0) {
-      Serial.println("Drawing image to sprite...");
-      albumArtSprite.fillScreen(BLACK);  // スプライトをクリア
+      albumArtDecodeSprite.fillScreen(BLACK);  // スプライトをクリア
 
       // 画像データをメモリにバッファ
-      uint8_t *buffer = (uint8_t *)malloc(size);
+      uint8_t *buffer = memoryBudget.admit(MemoryImages, size) ? (uint8_t *)malloc(size) : nullptr;
       if (buffer) {
         size_t bytesRead = stream->readBytes(buffer, size);
-        Serial.printf("Bytes read to buffer: %d\n", bytesRead);
         
         // バッファからスプライトに描画
-        bool success = albumArtSprite.drawJpg(buffer, bytesRead);
-        Serial.printf("Draw result: %s\n", success ? "success" : "failed");
+        bool success = albumArtDecodeSprite.drawJpg(buffer, bytesRead);
+        trace_i(traceImage, "album art read %u bytes, decode %d", bytesRead, success);
         free(buffer);
+
+        // デコード済みの画像を表示用スプライトへコピー
+        renderLoop.lock();
+        memcpy(playerView.art()->getBuffer(), albumArtDecodeSprite.getBuffer(), playerView.art()->bufferLength());
+        playerView.artChanged();
+        renderLoop.unlock();
       } else {
-        Serial.println("Failed to allocate buffer for image.");
+        trace_e(traceImage, "album art: no memory for %u bytes", size);
       }
     } else {
-      Serial.println("Image size is 0.");
+      trace_w(traceImage, "album art: empty response");
     }
   } else {
-    Serial.printf("HTTP GET failed, error: %s\n", http.errorToString(httpCode).c_str());
+    trace_e(traceImage, "album art GET failed: %d", httpCode);
   }
   http.end();
-  Serial.println("--- End downloadAndDisplayAlbumArt ---");
-}
-
-// Get status and show player screen
-void showPlayScreen()
-{
-  if (needFullClear) {
-      Display.clear();
-      needFullClear = false;
-  }
-
-  int result = spClient.getPlaybackState();
-  screenState = StatePlay;
-  tempVolume = spClient.volume;
-
-  // スクロール位置をリセット
-  trackNameCursorX = 0;
-  artistNameCursorX = 0;
-  isTrackScrolling = false;
-  isArtistScrolling = false;
-
-  if (spClient.duration_ms > 0)
-  {
-    refreshMillis = millis() + (spClient.duration_ms - spClient.progress_ms) + 100;
-  }
-  else
-  {
-    refreshMillis = 0;
-  }
-
-  downloadAndDisplayAlbumArt();  // アルバムアートをダウンロード
-  previousTrackName = spClient.trackName;
-  previousArtistName = spClient.artistName;
-
-  redrawPlayScreen();
-}
-
-// Redraw player screen components
-void redrawPlayScreen()
-{
-
-  static bool lastPlayState = !spClient.isPlaying;  // 前回の再生状態
-  static int lastVolume = -1;  // 前回のボリューム
-
-  // 再生状態やボリュームが変化した場合は全画面クリア
-  if (lastPlayState != spClient.isPlaying || lastVolume != spClient.volume)
-  {
-    Display.clear();
-    lastPlayState = spClient.isPlaying;
-    lastVolume = spClient.volume;
-  }
-  else
-  {
-    // スクロールテキストの領域のみクリア
-    Display.fillRect(90, 150, 150, 50, BLACK);
-  }
-  Display.setColor(baseColor);
-
-  // Volume
-  if (spClient.supportsVolume)
-    Display.fillArc(screenWidth / 2, screenHeight / 2, screenHeight / 2, screenHeight / 2 - 8, 270, (360 * ((float)spClient.volume / 100.0f) + 270));
-
-  // Pause / Play
-  if (spClient.isPlaying)
-  {
-    Display.fillRect(104, 65, 10, 60);
-    Display.fillRect(127, 65, 10, 60);
-  }
-  else
-  {
-    Display.fillTriangle(98, 65, 158, 95, 98, 125);
-  }
-
-  // Skip
-  Display.fillTriangle(166, 70, 206, 95, 166, 120);
-  Display.fillRect(198, 70, 8, 50);
-
-  Display.fillTriangle(34, 95, 74, 70, 74, 120);
-  Display.fillRect(34, 70, 8, 50);
-
-  // Album art
-  albumArtSprite.pushSprite(&Display, 30, 150);  // 左端に表示
-
-  // Track name スプライトの更新と描画
-  trackNameSprite.clear();
-  trackNameSprite.setCursor(trackNameCursorX, 0);
-  trackNameSprite.print(spClient.trackName);
-  trackNameSprite.pushSprite(&Display, 90, 150);
-
-  // Artist name スプライトの更新と描画
-  artistNameSprite.clear();
-  artistNameSprite.setCursor(artistNameCursorX, 0);
-  artistNameSprite.print(spClient.artistName);
-  artistNameSprite.pushSprite(&Display, 90, 180);
-}
-
-// Show device list screen
-void showDeviceScreen()
-{
-  screenState = StateDeviceList;
-  spClient.getDeviceList();
-
-  tempDeviceIndex = 0;
-
-  for (int i = 0; i < spClient.deviceIDs.size(); i++)
-  {
-    if (spClient.deviceIDs[i] == spClient.deviceID)
-    {
-      tempDeviceIndex = i + 1; // +1 for Back option
-      break;
-    }
-  }
-
-  redrawDeviceScreen(tempDeviceIndex);
-}
-
-// Redraw device screen for selected line
-void redrawDeviceScreen(int selectedLine)
-{
-  Display.clear();
-  // int lineCount = spClient.deviceIDs.size();
-  // if (selectedLine < 0 || selectedLine >= lineCount)
-  //   return;
-
-  // Display.fillRect(0, screenHeight / 2 - 12, screenWidth, 24, baseColor);
-
-  int lineCount = 1 + spClient.deviceIDs.size(); // +1 for Back option
-  
-  if (selectedLine < 0) selectedLine = 0;
-  if (selectedLine >= lineCount) selectedLine = lineCount - 1;
-
-  Display.fillRect(0, screenHeight / 2 - 12, screenWidth, 24, baseColor);
-
-  
-  for (int i = 0; i < lineCount; i++)
-  {
-    int y = (i - selectedLine) * 30 + screenHeight / 2;
-    if (y > 0 && y < screenHeight)
-    {
-      String displayText;
-      
-      if (i == 0) {
-        displayText = "<< Back"; // 戻るオプション
-      } else {
-        // i-1で実際のデバイスインデックスを取得
-        displayText = spClient.deviceNames[i-1];
-      }
-      
-      if (i == selectedLine)
-      {
-        Display.setTextColor(BLACK);
-        Display.drawString(displayText, screenWidth / 2, y);
-        Display.setTextColor(baseColor);
-      }
-      else
-      {
-        Display.drawString(displayText, screenWidth / 2, y);
-      }
-    }
-  }
-  
-  // 戻るボタンの表示
-  //Display.drawString("Back (long press button)", screenWidth / 2, screenHeight - 20);
+  trace_i(traceImage, "album art done in %u us", micros() - start);
 }
 
 // Send WiFi setting form
 void handleFormWiFi(void)
 {
+  if (!setupRouteOpen())
+    return;
   Serial.println("Serving WiFi form.");
   String optionList = "";
   for (size_t i = 0; i < wifiVector.size(); i++)
@@ -1172,6 +1182,8 @@ void handleFormWiFi(void)
 // Receive POST content to /formwifi
 void handlePostWiFi(void)
 {
+  if (!setupRouteOpen())
+    return;
   ST_ssid = webServer.arg("SSID");
   ST_pass = webServer.arg("PASS");
   Serial.printf("Received WiFi credentials for SSID: %s\n", ST_ssid.c_str());
@@ -1222,18 +1234,24 @@ const char intermediate_html[] PROGMEM = R"rawliteral(
 )rawliteral";
 
 void handleIntermediate(void) {
+  if (!setupRouteOpen())
+    return;
   Serial.println("Serving intermediate page.");
   webServer.send_P(200, "text/html", intermediate_html);
 }
 
 // Handler for GET requests to the root URL
 void handleRootGet(void) {
+  if (!setupRouteOpen())
+    return;
   Serial.println("Received GET request for root. Sending OK.");
   webServer.send(200, "text/plain", "M5Dial server is running. Ready to receive auth code.");
 }
 
 // Handles CORS preflight requests
 void handleCodeReceiverOptions(void) {
+  if (!setupRouteOpen())
+    return;
   Serial.println("Received OPTIONS request for code receiver.");
   webServer.sendHeader("Access-Control-Allow-Origin", "*");
   webServer.sendHeader("Access-Control-Max-Age", "10000");
@@ -1245,6 +1263,8 @@ void handleCodeReceiverOptions(void) {
 // Receive code from GitHub Pages
 void handleCodeReceiver(void)
 {
+  if (!setupRouteOpen())
+    return;
   Serial.println("Received POST request for code receiver.");
   webServer.sendHeader("Access-Control-Allow-Origin", "*");
   String code = webServer.arg("plain");
@@ -1260,17 +1280,11 @@ void handleCodeReceiver(void)
       preferences.putString("refreshToken", spClient.refreshToken);
       preferences.end();
 
-      needFullClear = true;
-      showPlayScreen();
-      if (spClient.trackName.isEmpty())
-      {
-        showDeviceScreen();
-      }
+      showFirstPlayScreen();
     } else {
       Serial.println("Error: Failed to obtain access token from Spotify.");
       showMessage("Auth Error", true);
-      delay(3000);
-      showSpotifyAuthQRcode();
+      scheduler.after(authErrorMillis, showSpotifyAuthQRcode);
     }
   } else {
     Serial.println("Error: POST request did not contain a code.");
@@ -1293,15 +1307,28 @@ void handleNotFound(void)
   webServer.send(404, "text/plain", "Not Found.");
 }
 
+// WiFi設定・認証のルートはセットアップ中だけ受け付ける
+// （再生中も/metricsのためにWebサーバーを回すが、LANから設定や認証を書き換えさせない）
+boolean setupRouteOpen(void)
+{
+  if (screenState <= StateWaitAuth)
+  {
+    return true;
+  }
+  webServer.send(404, "text/plain", "Not Found.");
+  return false;
+}
+
 // Show text on screen
 void showMessage(String message, bool isError)
 {
+  renderLoop.setActive(nullptr);
   Display.clear();
-  if (isError) {
-    Display.setTextColor(RED);
-  } else {
-    Display.setTextColor(baseColor);
-  }
-  Display.drawString(message, screenWidth / 2, screenHeight / 2);
-  Display.setTextColor(baseColor); // Reset color
+  drawText(message, screenWidth / 2, screenHeight / 2, isError ? RED : baseColor);
+}
+
+// Draw centered text through the glyph cache
+void drawText(const String &text, int32_t x, int32_t y, uint16_t color)
+{
+  glyphCache.drawString(&Display, text, x, y, middle_center, color);
 }
@@ -0,0 +1,344 @@
+#include "PayloadGenerator.h"
+
+// Pieces of text as they appear in JSON and as the parser should return them
+struct TextPiece
+{
+    const char *json;
+    const char *decoded;
+};
+
+static const TextPiece textPieces[] = {
+    {"Morning ", "Morning "},
+    {"Focus", "Focus"},
+    {"!", "!"},
+    {" mix ", " mix "},
+    {"深夜のドライブ", "深夜のドライブ"},
+    {"とても長いプレイリストの名前", "とても長いプレイリストの名前"},
+    {"한국어 노래 ", "한국어 노래 "},
+    {"Ünïcødé ", "Ünïcødé "},
+    {"🎵🎶", "🎵🎶"},
+    {"\\\"quoted\\\"", "\"quoted\""},
+    {"back\\\\slash", "back\\slash"},
+    {"\\\\", "\\"},
+    {"AC\\/DC", "AC/DC"},
+    {"caf\\u00e9 ", "café "},
+    {"\\u3042\\u3044\\u3046", "あいう"},
+    {"\\ud83c\\udfa7", "🎧"},
+    {"Tab\\tEnd", "Tab\tEnd"},
+    {"{Live}", "{Live}"},
+    {"[2024]", "[2024]"},
+    {"Vol: 2, ", "Vol: 2, "},
+    {"}]},{\\\"", "}]},{\""},
+};
+
+#define textPieceCount (sizeof(textPieces) / sizeof(textPieces[0]))
+
+// Indented like the API, or compact
+class JsonWriter
+{
+public:
+    JsonWriter(std::string &out, boolean compact) : _out(out), _compact(compact) {}
+
+    void open(char bracket)
+    {
+        _out += bracket;
+        _depth++;
+        _first = true;
+    }
+
+    void close(char bracket)
+    {
+        _depth--;
+        if (!_first)
+            newline();
+        _out += bracket;
+        _first = false;
+    }
+
+    void key(const char *name)
+    {
+        element();
+        _out += '"';
+        _out += name;
+        _out += _compact ? "\":" : "\" : ";
+        _valueFollows = true;
+    }
+
+    // A value: raw JSON (null, a number, "an already escaped string")
+    void raw(const std::string &json)
+    {
+        element();
+        _out += json;
+    }
+
+    void string(const std::string &json) { raw("\"" + json + "\""); }
+
+private:
+    void element()
+    {
+        if (_valueFollows)
+        {
+            _valueFollows = false;
+            return;
+        }
+        if (!_first)
+            _out += ',';
+        newline();
+        _first = false;
+    }
+
+    void newline()
+    {
+        if (_compact)
+            return;
+        _out += '\n';
+        _out.append(_depth * 2, ' ');
+    }
+
+    std::string &_out;
+    boolean _compact;
+    int _depth = 0;
+    boolean _first = true;
+    boolean _valueFollows = false;
+};
+
+PayloadGenerator::PayloadGenerator(uint32_t seed) : _random(seed)
+{
+}
+
+void PayloadGenerator::playlists(int count, int nesting, boolean compact, std::string &body, std::vector<ExpectedPlaylist> &expected)
+{
+    body.clear();
+    expected.clear();
+    JsonWriter json(body, compact);
+    json.open('{');
+    json.key("href");
+    json.string("https://api.spotify.com/v1/users/scaleuser/playlists?offset=0&limit=50");
+    json.key("items");
+    json.open('[');
+    for (int i = 0; i < count; i++)
+    {
+        ExpectedPlaylist playlist;
+        playlist.id = base62(22);
+        playlist.tracks = random(10000);
+        std::string nameJson, descriptionJson, ownerJson, unused;
+        text(generatorNameBytes, i == 0, nameJson, playlist.name);
+        text(generatorDescriptionBytes, i == 0, descriptionJson, unused);
+        text(generatorDeviceNameBytes, i == 0, ownerJson, unused);
+        std::string ownerId = base62(12);
+
+        json.open('{');
+        json.key("collaborative");
+        json.raw(random(2) ? "true" : "false");
+        json.key("description");
+        json.string(descriptionJson);
+        json.key("external_urls");
+        json.open('{');
+        json.key("spotify");
+        json.string("https:\\/\\/open.spotify.com\\/playlist\\/" + playlist.id);
+        json.close('}');
+        json.key("href");
+        json.string("https://api.spotify.com/v1/playlists/" + playlist.id);
+        json.key("id");
+        json.string(playlist.id);
+
+        json.key("images");
+        switch (random(4))
+        {
+        case 0:
+            json.raw("null");
+            break;
+        case 1:
+            json.open('[');
+            json.close(']');
+            break;
+        default:
+        {
+            static const int sizes[] = {640, 300, 60};
+            json.open('[');
+            for (int size : sizes)
+            {
+                playlist.imageURL = "https://mosaic.scdn.co/" + std::to_string(size) + "/ab67616d0000" + hex(28);
+                json.open('{');
+                json.key("height");
+                json.raw(std::to_string(size));
+                json.key("url");
+                json.string(playlist.imageURL);
+                json.key("width");
+                json.raw(std::to_string(size));
+                json.close('}');
+            }
+            json.close(']');
+            break;
+        }
+        }
+
+        json.key("name");
+        json.string(nameJson);
+        json.key("owner");
+        json.open('{');
+        json.key("display_name");
+        json.string(ownerJson);
+        json.key("external_urls");
+        json.open('{');
+        json.key("spotify");
+        json.string("https://open.spotify.com/user/" + ownerId);
+        json.close('}');
+        for (int level = 0; level < nesting; level++)
+        {
+            json.key("details");
+            json.open('{');
+            json.key("id");
+            json.string(base62(22));
+            json.key("name");
+            json.string(ownerJson);
+        }
+        for (int level = 0; level < nesting; level++)
+            json.close('}');
+        json.key("href");
+        json.string("https://api.spotify.com/v1/users/" + ownerId);
+        json.key("id");
+        json.string(ownerId);
+        json.key("type");
+        json.string("user");
+        json.key("uri");
+        json.string("spotify:user:" + ownerId);
+        json.close('}');
+
+        json.key("primary_color");
+        json.raw("null");
+        json.key("public");
+        json.raw(random(2) ? "true" : "false");
+        json.key("snapshot_id");
+        json.string(base62(32));
+        json.key("tracks");
+        json.open('{');
+        json.key("href");
+        json.string("https://api.spotify.com/v1/playlists/" + playlist.id + "/tracks");
+        json.key("total");
+        json.raw(std::to_string(playlist.tracks));
+        json.close('}');
+        json.key("type");
+        json.string("playlist");
+        json.key("uri");
+        json.string("spotify:playlist:" + playlist.id);
+        json.close('}');
+        expected.push_back(playlist);
+    }
+    json.close(']');
+    json.key("limit");
+    json.raw("50");
+    json.key("next");
+    json.raw("null");
+    json.key("offset");
+    json.raw("0");
+    json.key("previous");
+    json.raw("null");
+    json.key("total");
+    json.raw(std::to_string(count));
+    json.close('}');
+}
+
+void PayloadGenerator::devices(int count, boolean compact, std::string &body, std::vector<ExpectedDevice> &expected)
+{
+    static const char *types[] = {"Computer", "Smartphone", "Speaker", "TV"};
+    body.clear();
+    expected.clear();
+    JsonWriter json(body, compact);
+    json.open('{');
+    json.key("devices");
+    json.open('[');
+    for (int i = 0; i < count; i++)
+    {
+        ExpectedDevice device;
+        device.id = hex(40);
+        std::string nameJson;
+        text(generatorDeviceNameBytes, i == 0, nameJson, device.name);
+        boolean supportsVolume = random(4) != 0;
+
+        json.open('{');
+        json.key("id");
+        json.string(device.id);
+        json.key("is_active");
+        json.raw(i == 0 ? "true" : "false");
+        json.key("is_private_session");
+        json.raw("false");
+        json.key("is_restricted");
+        json.raw("false");
+        json.key("name");
+        json.string(nameJson);
+        json.key("supports_volume");
+        json.raw(supportsVolume ? "true" : "false");
+        json.key("type");
+        json.string(types[random(4)]);
+        json.key("volume_percent");
+        json.raw(supportsVolume ? std::to_string(random(101)) : "null");
+        json.close('}');
+        expected.push_back(device);
+    }
+    json.close(']');
+    json.close('}');
+}
+
+void PayloadGenerator::chunk(const std::string &body, size_t chunkBytes, std::string &chunked)
+{
+    chunked.clear();
+    size_t position = 0;
+    while (position < body.size())
+    {
+        size_t size = min(chunkBytes ? chunkBytes : 1 + random(generatorMaxChunk), body.size() - position);
+        char header[32];
+        // Random sizes also try upper case digits and chunk extensions
+        if (!chunkBytes && random(4) == 0)
+            snprintf(header, sizeof(header), "%zX;scale=%u\r\n", size, (unsigned)random(100));
+        else
+            snprintf(header, sizeof(header), "%zx\r\n", size);
+        chunked += header;
+        chunked.append(body, position, size);
+        chunked += "\r\n";
+        position += size;
+    }
+    chunked += "0\r\n\r\n";
+}
+
+// Random text of at most maxBytes as JSON, so also once decoded, at least
+// one piece. The longest text is exactly maxBytes of unescaped pieces: no
+// other text is longer, escaped or decoded
+void PayloadGenerator::text(size_t maxBytes, boolean longest, std::string &json, std::string &decoded)
+{
+    json.clear();
+    decoded.clear();
+    size_t target = longest ? maxBytes : 1 + random(maxBytes);
+    while (json.size() < target)
+    {
+        const TextPiece &piece = textPieces[random(textPieceCount)];
+        if (longest && strcmp(piece.json, piece.decoded) != 0)
+            continue;
+        if (!json.empty() && json.size() + strlen(piece.json) > target)
+        {
+            if (longest)
+                continue;
+            break;
+        }
+        json += piece.json;
+        decoded += piece.decoded;
+    }
+}
+
+std::string PayloadGenerator::base62(int length)
+{
+    static const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    std::string text;
+    for (int i = 0; i < length; i++)
+        text += digits[random(62)];
+    return text;
+}
+
+std::string PayloadGenerator::hex(int length)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string text;
+    for (int i = 0; i < length; i++)
+        text += digits[random(16)];
+    return text;
+}
@@ -0,0 +1,62 @@
+#ifndef PAYLOADGENERATOR_H_INCLUDE
+#define PAYLOADGENERATOR_H_INCLUDE
+
+#include <Arduino.h>
+#include <random>
+
+/*
+PayloadGenerator writes synthetic /me/playlists and /me/player/devices
+bodies in the shape of the Spotify API, together with the values the
+parsers should find in them. Names mix ASCII, long CJK and Hangul runs,
+emoji, JSON escapes (\", \\, \/, \t, \uXXXX with surrogate pairs) and
+characters that look like structure ({ } [ ] : ,). Descriptions and
+owner names get the same treatment, so the values nobody scans are
+stressed too. Images are null, empty or a mosaic of three sizes, and
+owners can carry extra nested objects. The first entry always has values
+of the full length, so every size meets the worst case once. Bodies are
+pretty printed like the API or compact, and can be framed as
+Transfer-Encoding: chunked. The same seed gives the same payloads.
+*/
+
+// Text lengths in JSON bytes, which bound the decoded length too
+#define generatorNameBytes 150      // 50 of them fit playlistArenaBytes with the image URL
+#define generatorDeviceNameBytes 60 // deviceCapacity of them fit deviceArenaBytes with the ID
+#define generatorDescriptionBytes 200
+#define generatorMaxChunk 1024      // random chunk sizes are 1 to this
+
+struct ExpectedPlaylist
+{
+  std::string id;
+  std::string name;
+  std::string imageURL;  // the last (smallest) image, empty without images
+  int tracks;
+};
+
+struct ExpectedDevice
+{
+  std::string id;
+  std::string name;
+};
+
+class PayloadGenerator
+{
+public:
+  PayloadGenerator(uint32_t seed);
+
+  // nesting adds that many levels of objects below each owner
+  void playlists(int count, int nesting, boolean compact, std::string &body, std::vector<ExpectedPlaylist> &expected);
+  void devices(int count, boolean compact, std::string &body, std::vector<ExpectedDevice> &expected);
+
+  // Frame body in chunks of chunkBytes, or of random sizes for 0
+  void chunk(const std::string &body, size_t chunkBytes, std::string &chunked);
+
+private:
+  void text(size_t maxBytes, boolean longest, std::string &json, std::string &decoded);
+  std::string base62(int length);
+  std::string hex(int length);
+  uint32_t random(uint32_t limit) { return _random() % limit; }
+
+  std::mt19937 _random;
+};
+
+#endif
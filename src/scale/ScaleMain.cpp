@@ -0,0 +1,53 @@
+#include <Arduino.h>
+#include "ScaleSuite.h"
+
+/*
+Scale suite of the playlist and device parsers (see ScaleSuite.h).
+  program [--seed N] [--max ENTRIES] [--csv FILE]
+Exits with 1 when a parse is wrong or the peak heap grows with the size.
+*/
+
+static const int playlistSizes[] = {1, 10, 50, 100, 500, 1000, 2000, 5000, 10000};
+static const int deviceSizes[] = {1, 16, 100, 1000, 10000};
+
+static int usage()
+{
+    fprintf(stderr, "usage: program [--seed N] [--max ENTRIES] [--csv FILE]\n");
+    return 2;
+}
+
+// The sizes up to max
+static int sizesUpTo(const int *sizes, int count, int max)
+{
+    int kept = 0;
+    while (kept < count && sizes[kept] <= max)
+        kept++;
+    return kept;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seed = 1;
+    int maxEntries = INT32_MAX;
+    const char *csvPath = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc)
+            maxEntries = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+            csvPath = argv[++i];
+        else
+            return usage();
+    }
+
+    FilePrint out(stdout);
+    ScaleSuite suite(out, seed);
+    if (!suite.begin(csvPath))
+        return 2;
+    suite.playlists(playlistSizes, sizesUpTo(playlistSizes, sizeof(playlistSizes) / sizeof(playlistSizes[0]), maxEntries));
+    suite.devices(deviceSizes, sizesUpTo(deviceSizes, sizeof(deviceSizes) / sizeof(deviceSizes[0]), maxEntries));
+    out.printf("%u failures\n", suite.failures());
+    return suite.failures() ? 1 : 0;
+}
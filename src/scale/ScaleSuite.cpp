@@ -0,0 +1,309 @@
+#include <stdarg.h>
+#include <cstddef>
+#include <new>
+#include "ScaleSuite.h"
+#include "JsonStreamScanner.h"
+#include "MemoryStream.h"
+#include "SpotifyLists.h"
+
+// Every operator new of the program goes through here: a size header in
+// front of each block keeps the bytes in use and their peak. The header is
+// reached through std::launder, so GCC does not read it as an index before
+// the caller's array (-Warray-bounds)
+static size_t heapBytesInUse = 0;
+static size_t heapBytesPeak = 0;
+
+struct alignas(std::max_align_t) HeapHeader
+{
+    size_t size;
+};
+
+void *operator new(size_t size)
+{
+    HeapHeader *header = static_cast<HeapHeader *>(malloc(sizeof(HeapHeader) + size));
+    if (!header)
+        throw std::bad_alloc();
+    header->size = size;
+    heapBytesInUse += size;
+    heapBytesPeak = max(heapBytesPeak, heapBytesInUse);
+    return header + 1;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *data) noexcept
+{
+    if (!data)
+        return;
+    HeapHeader *header = std::launder(static_cast<HeapHeader *>(data) - 1);
+    heapBytesInUse -= header->size;
+    free(header);
+}
+
+void operator delete[](void *data) noexcept
+{
+    operator delete(data);
+}
+
+void operator delete(void *data, size_t size) noexcept
+{
+    operator delete(data);
+}
+
+void operator delete[](void *data, size_t size) noexcept
+{
+    operator delete(data);
+}
+
+size_t ScaleSuite::heapInUse()
+{
+    return heapBytesInUse;
+}
+
+size_t ScaleSuite::heapPeak()
+{
+    return heapBytesPeak;
+}
+
+void ScaleSuite::resetHeapPeak()
+{
+    heapBytesPeak = heapBytesInUse;
+}
+
+static const int variantCount = 7;
+
+ScaleSuite::ScaleSuite(Print &out, uint32_t seed)
+    : _out(out),
+      _generator(seed),
+      _playlists(playlistIdLength, PlaylistFieldCount),
+      _devices(0, DeviceFieldCount)
+{
+}
+
+ScaleSuite::~ScaleSuite()
+{
+    if (_csv)
+        fclose(_csv);
+}
+
+// Stores sized like SPClient's. csvPath, if not null, receives one line per run
+boolean ScaleSuite::begin(const char *csvPath)
+{
+    if (!_playlists.begin(playlistCapacity, playlistArenaBytes) || !_devices.begin(deviceCapacity, deviceArenaBytes))
+        return false;
+    if (csvPath)
+    {
+        _csv = fopen(csvPath, "w");
+        if (!_csv)
+        {
+            log_e("ScaleSuite: cannot write %s", csvPath);
+            return false;
+        }
+        fprintf(_csv, "list,entries,bytes,variant,micros,peak_bytes,ok\n");
+    }
+    _out.printf("%-9s %8s %10s  %-14s %9s %8s %7s %7s  %s\n", "list", "entries", "bytes", "variant", "ms", "us/entry",
+                "MB/s", "peak B", "result");
+    return true;
+}
+
+static const ScaleSuite::Variant *variants()
+{
+    static const ScaleSuite::Variant list[variantCount] = {
+        {"plain", false, 0, false, 0},
+        {"chunk 4096", true, 4096, false, 0},
+        {"chunk 256", true, 256, false, 0},
+        {"chunk 7", true, 7, false, 0},
+        {"chunk random", true, 0, false, 0},
+        {"compact", true, 0, true, 0},
+        {"nested 8", true, 0, false, 8},
+    };
+    return list;
+}
+
+void ScaleSuite::playlists(const int *sizes, int sizeCount)
+{
+    std::vector<Result> results(sizeCount * variantCount);
+    std::string body;
+    std::vector<ExpectedPlaylist> expected;
+    for (int i = 0; i < sizeCount; i++)
+    {
+        for (int v = 0; v < variantCount; v++)
+        {
+            const Variant &variant = variants()[v];
+            _generator.playlists(sizes[i], variant.nesting, variant.compact, body, expected);
+            Result result = runPlaylists(variant, body, expected);
+            report("playlists", sizes[i], body.size(), variant, result);
+            results[i * variantCount + v] = result;
+        }
+    }
+    summarize("playlists", sizes, sizeCount, results.data());
+}
+
+void ScaleSuite::devices(const int *sizes, int sizeCount)
+{
+    std::vector<Result> results(sizeCount * variantCount);
+    std::string body;
+    std::vector<ExpectedDevice> expected;
+    for (int i = 0; i < sizeCount; i++)
+    {
+        for (int v = 0; v < variantCount; v++)
+        {
+            const Variant &variant = variants()[v];
+            _generator.devices(sizes[i], variant.compact, body, expected);
+            Result result = runDevices(variant, body, expected);
+            report("devices", sizes[i], body.size(), variant, result);
+            results[i * variantCount + v] = result;
+        }
+    }
+    summarize("devices", sizes, sizeCount, results.data());
+}
+
+ScaleSuite::Result ScaleSuite::runPlaylists(const Variant &variant, const std::string &body, const std::vector<ExpectedPlaylist> &expected)
+{
+    std::string chunked;
+    if (variant.chunked)
+        _generator.chunk(body, variant.chunkBytes, chunked);
+    const std::string &data = variant.chunked ? chunked : body;
+    MemoryStream stream((const uint8_t *)data.data(), data.size());
+
+    Result result;
+    _playlists.reset();
+    size_t baseline = heapInUse();
+    resetHeapPeak();
+    uint32_t start = micros();
+    int count;
+    {
+        JsonStreamScanner scanner(&stream, variant.chunked);
+        count = parsePlaylists(scanner, _playlists);
+    }
+    result.micros = micros() - start;
+    result.peakBytes = heapPeak() - baseline;
+
+    result.ok = true;
+    size_t stored = min(expected.size(), (size_t)playlistCapacity);
+    if (count != (int)expected.size())
+        result.ok = fail("%s: %d playlists counted, expected %zu", variant.name, count, expected.size());
+    else if (_playlists.size() != (int)stored)
+        result.ok = fail("%s: %d playlists stored, expected %zu", variant.name, _playlists.size(), stored);
+    for (size_t i = 0; result.ok && i < stored; i++)
+    {
+        const ExpectedPlaylist &playlist = expected[i];
+        if (_playlists.id((int)i) != playlist.id.c_str())
+            result.ok = fail("%s: playlist %zu id %s, expected %s", variant.name, i, _playlists.id((int)i).c_str(),
+                             playlist.id.c_str());
+        else if (playlist.name != _playlists.text((int)i, PlaylistName))
+            result.ok = fail("%s: playlist %zu name \"%s\", expected \"%s\"", variant.name, i,
+                             _playlists.text((int)i, PlaylistName), playlist.name.c_str());
+        else if (playlist.imageURL != _playlists.text((int)i, PlaylistImageURL))
+            result.ok = fail("%s: playlist %zu image \"%s\", expected \"%s\"", variant.name, i,
+                             _playlists.text((int)i, PlaylistImageURL), playlist.imageURL.c_str());
+        else if (_playlists.value((int)i) != playlist.tracks)
+            result.ok = fail("%s: playlist %zu has %d tracks, expected %d", variant.name, i, _playlists.value((int)i),
+                             playlist.tracks);
+    }
+    return result;
+}
+
+ScaleSuite::Result ScaleSuite::runDevices(const Variant &variant, const std::string &body, const std::vector<ExpectedDevice> &expected)
+{
+    std::string chunked;
+    if (variant.chunked)
+        _generator.chunk(body, variant.chunkBytes, chunked);
+    const std::string &data = variant.chunked ? chunked : body;
+    MemoryStream stream((const uint8_t *)data.data(), data.size());
+
+    Result result;
+    _devices.reset();
+    size_t baseline = heapInUse();
+    resetHeapPeak();
+    uint32_t start = micros();
+    int count;
+    {
+        JsonStreamScanner scanner(&stream, variant.chunked);
+        count = parseDeviceList(scanner, _devices);
+    }
+    result.micros = micros() - start;
+    result.peakBytes = heapPeak() - baseline;
+
+    result.ok = true;
+    size_t stored = min(expected.size(), (size_t)deviceCapacity);
+    if (count != (int)expected.size())
+        result.ok = fail("%s: %d devices counted, expected %zu", variant.name, count, expected.size());
+    else if (_devices.size() != (int)stored)
+        result.ok = fail("%s: %d devices stored, expected %zu", variant.name, _devices.size(), stored);
+    for (size_t i = 0; result.ok && i < stored; i++)
+    {
+        const ExpectedDevice &device = expected[i];
+        if (device.id != _devices.text((int)i, DeviceID))
+            result.ok = fail("%s: device %zu id %s, expected %s", variant.name, i, _devices.text((int)i, DeviceID),
+                             device.id.c_str());
+        else if (device.name != _devices.text((int)i, DeviceName))
+            result.ok = fail("%s: device %zu name \"%s\", expected \"%s\"", variant.name, i,
+                             _devices.text((int)i, DeviceName), device.name.c_str());
+    }
+    return result;
+}
+
+void ScaleSuite::report(const char *list, int size, size_t bytes, const Variant &variant, const Result &result)
+{
+    double micros = max(result.micros, (uint32_t)1);
+    _out.printf("%-9s %8d %10zu  %-14s %9.2f %8.2f %7.1f %7zu  %s\n", list, size, bytes, variant.name,
+                result.micros / 1000.0, micros / size, bytes / micros, result.peakBytes, result.ok ? "ok" : "FAILED");
+    if (_csv)
+    {
+        fprintf(_csv, "%s,%d,%zu,%s,%u,%zu,%d\n", list, size, bytes, variant.name, result.micros, result.peakBytes,
+                result.ok ? 1 : 0);
+    }
+}
+
+// Per variant: time per entry and peak heap at the reference size against the largest
+void ScaleSuite::summarize(const char *list, const int *sizes, int sizeCount, const Result *results)
+{
+    int reference = -1;
+    for (int i = 0; i < sizeCount && reference < 0; i++)
+    {
+        if (sizes[i] >= scaleReferenceSize)
+            reference = i;
+    }
+    int largest = sizeCount - 1;
+    if (reference < 0 || reference == largest)
+    {
+        _out.printf("%s: no sizes above %d entries to compare\n", list, scaleReferenceSize);
+        return;
+    }
+
+    _out.printf("%s scaling, %d to %d entries:\n", list, sizes[reference], sizes[largest]);
+    for (int v = 0; v < variantCount; v++)
+    {
+        const Result &from = results[reference * variantCount + v];
+        const Result &to = results[largest * variantCount + v];
+        double fromPerEntry = (double)max(from.micros, (uint32_t)1) / sizes[reference];
+        double toPerEntry = (double)to.micros / sizes[largest];
+        double timeRatio = toPerEntry / fromPerEntry;
+        size_t peak = 0;
+        for (int i = reference; i <= largest; i++)
+            peak = max(peak, results[i * variantCount + v].peakBytes);
+        boolean flat = peak <= from.peakBytes * scalePeakSlack;
+
+        _out.printf("  %-14s %6.2f -> %6.2f us/entry (x%.2f, %s), peak heap %zu -> %zu B (%s)\n", variants()[v].name,
+                    fromPerEntry, toPerEntry, timeRatio, timeRatio <= scaleLinearSlack ? "linear" : "NOT LINEAR",
+                    from.peakBytes, peak, flat ? "flat" : "GROWING");
+        if (!flat)
+            fail("%s %s: peak heap grows from %zu to %zu bytes", list, variants()[v].name, from.peakBytes, peak);
+    }
+}
+
+boolean ScaleSuite::fail(const char *format, ...)
+{
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    fprintf(stderr, "%s\n", message);
+    _failures++;
+    return false;
+}
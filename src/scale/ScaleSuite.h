@@ -0,0 +1,86 @@
+#ifndef SCALESUITE_H_INCLUDE
+#define SCALESUITE_H_INCLUDE
+
+#include <Arduino.h>
+#include "EntryStore.h"
+#include "PayloadGenerator.h"
+
+/*
+ScaleSuite runs generated payloads (see PayloadGenerator.h) through
+JsonStreamScanner and the list parsers of SpotifyLists.h, from a few
+entries to libraries of thousands, plain and chunked at several chunk
+sizes, pretty printed, compact and with deeply nested owners. For every
+run it reports the parse time, the peak heap in use while parsing and
+whether the parse is correct: every entry of the response counted, and
+the store, sized like the firmware's, holding exactly the generated IDs,
+names, image URLs and track counts of the entries that fit.
+
+Expected scaling: the scanner reads the body once, byte by byte, and
+keeps only the current path and the values of one entry, so parse time
+grows linearly with the response (constant time per entry) and the
+peak heap stays flat, bounded by the longest value rather than by the
+number of entries. Below scaleReferenceSize the peak still creeps up as
+rarer combinations of long values turn up; from there on it must stay
+within scalePeakSlack. The run fails on a wrong parse or a growing
+heap; time per entry is only reported, since host load makes it noisy.
+Measured on an x86-64 desktop host, -O2, seeds 1 to 3:
+  playlists, 1 to 10000 (13.5 MB): 15 us each plain, 20 us chunked,
+    30 us in 7 byte chunks, 38 us nested 8 deep; x0.95 to x1.14 per
+    entry from 1000 to 10000; peak heap 0.6 KB at 1, about 1 KB from
+    1000 on
+  devices, 1 to 10000 (2.9 MB): 3.5 to 7 us each; peak heap 123 B at
+    1, 200 to 240 B from 1000 on
+*/
+
+#define scaleReferenceSize 1000 // entries; the heap and time of larger runs are compared with it
+#define scalePeakSlack 1.5      // the peak heap may grow this much beyond the reference
+#define scaleLinearSlack 2.0    // us per entry beyond this many times the reference reads as not linear
+
+class ScaleSuite
+{
+public:
+  struct Variant
+  {
+    const char *name;
+    boolean chunked;
+    size_t chunkBytes;  // 0: random sizes
+    boolean compact;
+    int nesting;
+  };
+
+  struct Result
+  {
+    uint32_t micros;
+    size_t peakBytes;
+    boolean ok;
+  };
+
+  ScaleSuite(Print &out, uint32_t seed);
+  boolean begin(const char *csvPath);
+  ~ScaleSuite();
+
+  void playlists(const int *sizes, int sizeCount);
+  void devices(const int *sizes, int sizeCount);
+  uint32_t failures() { return _failures; }
+
+  // Heap in use through operator new, for the peak of one parse
+  static size_t heapInUse();
+  static size_t heapPeak();
+  static void resetHeapPeak();
+
+private:
+  Result runPlaylists(const Variant &variant, const std::string &body, const std::vector<ExpectedPlaylist> &expected);
+  Result runDevices(const Variant &variant, const std::string &body, const std::vector<ExpectedDevice> &expected);
+  void report(const char *list, int size, size_t bytes, const Variant &variant, const Result &result);
+  void summarize(const char *list, const int *sizes, int sizeCount, const Result *results);
+  boolean fail(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+  Print &_out;
+  PayloadGenerator _generator;
+  EntryStore _playlists;
+  EntryStore _devices;
+  FILE *_csv = nullptr;
+  uint32_t _failures = 0;
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "MockSpotify.h"
+
+#define mockDeviceIdPrefix "mockdevice"
+#define mockPlaylistIdPrefix "mockplaylist"
+
+MockSpotify::MockSpotify() : _devices(0, DeviceFieldCount), _playlists(playlistIdLength, PlaylistFieldCount)
+{
+    _devices.begin(deviceCapacity, deviceArenaBytes);
+    _playlists.begin(playlistCapacity, playlistArenaBytes);
+    publish();
+}
+
+// The first track added is the current one
+void MockSpotify::addTrack(const String &name, const String &artist, uint32_t artColor)
+{
+    _tracks.push_back({name, artist, artColor});
+    publish();
+}
+
+// The first device added is the active one. Its value is 1 if it supports volume
+void MockSpotify::addDevice(const String &name, boolean supportsVolume)
+{
+    int index = _devices.add();
+    if (index < 0)
+        return;
+    _devices.setText(index, DeviceID, mockDeviceIdPrefix + String(index));
+    _devices.setText(index, DeviceName, name);
+    _devices.setValue(index, supportsVolume);
+    if (_device < 0)
+        _device = index;
+    publish();
+}
+
+// IDs are generated: "mockplaylist" and the index, zero padded to a Spotify ID
+void MockSpotify::addPlaylist(const String &name, int trackCount)
+{
+    char id[playlistIdLength + 1];
+    snprintf(id, sizeof(id), mockPlaylistIdPrefix "%0*d", (int)(playlistIdLength - strlen(mockPlaylistIdPrefix)),
+             _playlists.size());
+    int index = _playlists.add(id);
+    if (index < 0)
+        return;
+    _playlists.setText(index, PlaylistName, name);
+    _playlists.setValue(index, trackCount);
+}
+
+void MockSpotify::setPlaying(boolean playing)
+{
+    _playing = playing;
+    publish();
+}
+
+int MockSpotify::changeVolume(int newVolume)
+{
+    if (_device < 0 || !_devices.value(_device))
+        return 403;
+    _volume = constrain(newVolume, 0, 100);
+    publish();
+    return 204;
+}
+
+int MockSpotify::resumePlayback()
+{
+    setPlaying(true);
+    return 204;
+}
+
+int MockSpotify::pausePlayback()
+{
+    setPlaying(false);
+    return 204;
+}
+
+int MockSpotify::skipToNext()
+{
+    if (_tracks.empty())
+        return 404;
+    _track = (_track + 1) % _tracks.size();
+    publish();
+    return 204;
+}
+
+int MockSpotify::skipToPrev()
+{
+    if (_tracks.empty())
+        return 404;
+    _track = (_track + _tracks.size() - 1) % _tracks.size();
+    publish();
+    return 204;
+}
+
+int MockSpotify::selectDevice(const String &deviceID)
+{
+    for (int i = 0; i < _devices.size(); i++)
+    {
+        if (deviceID == _devices.text(i, DeviceID))
+        {
+            _device = i;
+            publish();
+            return 204;
+        }
+    }
+    return 404;
+}
+
+// Starts the queue from its first track
+int MockSpotify::playPlaylist(const String &playlistId)
+{
+    if (_playlists.find(playlistId) < 0)
+        return 404;
+    _track = 0;
+    _playing = true;
+    publish();
+    return 204;
+}
+
+// The art color of a mock image URL
+boolean MockSpotify::artColor(const char *imageURL, uint32_t &color)
+{
+    unsigned int value;
+    if (sscanf(imageURL, "mock:%6x", &value) != 1)
+        return false;
+    color = value;
+    return true;
+}
+
+// The state as getPlaybackState() would publish it
+void MockSpotify::publish()
+{
+    PlaybackSnapshot snapshot;
+    snapshot.clear();
+    if (_device >= 0)
+    {
+        PlaybackSnapshot::copyText(snapshot.deviceID, sizeof(snapshot.deviceID), _devices.text(_device, DeviceID));
+        snapshot.supportsVolume = _devices.value(_device);
+    }
+    if (!_tracks.empty())
+    {
+        const Track &track = _tracks[_track];
+        PlaybackSnapshot::copyText(snapshot.trackName, sizeof(snapshot.trackName), track.name.c_str());
+        PlaybackSnapshot::copyText(snapshot.artistName, sizeof(snapshot.artistName), track.artist.c_str());
+        snprintf(snapshot.imageURL, sizeof(snapshot.imageURL), "mock:%06x", track.artColor & 0xFFFFFF);
+    }
+    snapshot.isPlaying = _playing;
+    snapshot.volume = _volume;
+    _playback.publish(snapshot);
+}
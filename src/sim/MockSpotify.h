@@ -0,0 +1,65 @@
+#ifndef MOCKSPOTIFY_H_INCLUDE
+#define MOCKSPOTIFY_H_INCLUDE
+
+#include <Arduino.h>
+#include "PlayerScreens.h"
+
+/*
+MockSpotify stands in for SPClient in the simulator, as the
+PlayerService of PlayerScreens. It keeps a track queue and the device and
+playlist stores in SPClient's layout, answers the player commands by
+changing that state and publishes the result into a PlaybackChannel at
+once, so the fetches have nothing left to do. No network is involved.
+Album art is a solid color, carried in the image URL as "mock:rrggbb".
+*/
+
+class MockSpotify : public PlayerService
+{
+public:
+  MockSpotify();
+
+  const PlaybackChannel &playback() override { return _playback; }
+  const EntryStore &devices() override { return _devices; }
+  const EntryStore &playlists() override { return _playlists; }
+
+  // Filled by the script
+  void addTrack(const String &name, const String &artist, uint32_t artColor);
+  void addDevice(const String &name, boolean supportsVolume);
+  void addPlaylist(const String &name, int trackCount);
+  void setPlaying(boolean playing);
+
+  // SPClient's fetches and commands
+  int getPlaybackState() override { return 200; }
+  int getDeviceList() override { return 200; }
+  int getUserPlaylists() override { return 200; }
+  int changeVolume(int newVolume) override;
+  int resumePlayback() override;
+  int pausePlayback() override;
+  int skipToNext() override;
+  int skipToPrev() override;
+  int selectDevice(const String &deviceID) override;
+  int playPlaylist(const String &playlistId) override;
+
+  static boolean artColor(const char *imageURL, uint32_t &color);
+
+private:
+  struct Track
+  {
+    String name;
+    String artist;
+    uint32_t artColor;
+  };
+
+  void publish();
+
+  EntryStore _devices;
+  EntryStore _playlists;
+  PlaybackChannel _playback;
+  std::vector<Track> _tracks;
+  int _track = 0;
+  int _device = -1;
+  int _volume = 50;
+  boolean _playing = false;
+};
+
+#endif
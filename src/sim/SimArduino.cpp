@@ -0,0 +1,204 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <chrono>
+#include <random>
+
+static uint32_t simMillis = 0;
+static boolean simVirtualMicros = false;
+static uint32_t simMicros = 0;
+static std::mt19937 simRandom(1);
+
+uint32_t millis()
+{
+    return simMillis;
+}
+
+// Move the virtual clock. Only the simulator calls this
+void setMillis(uint32_t now)
+{
+    simMillis = now;
+}
+
+uint32_t micros()
+{
+    if (simVirtualMicros)
+        return simMicros;
+    static auto start = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// From now on micros() is virtual too. For tests of timing dependent input
+void setMicros(uint32_t now)
+{
+    simVirtualMicros = true;
+    simMicros = now;
+}
+
+// Back to the host clock, e.g. to time rendering after scripted input
+void releaseMicros()
+{
+    simVirtualMicros = false;
+}
+
+#define simPinCount 64
+
+struct SimPin
+{
+    int level;
+    void (*handler)(void *);
+    void *arg;
+};
+
+static SimPin simPins[simPinCount];
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+    return pin < simPinCount ? simPins[pin].level : 0;
+}
+
+// The handler runs on every level change, as with CHANGE
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode)
+{
+    if (pin < simPinCount)
+    {
+        simPins[pin].handler = handler;
+        simPins[pin].arg = arg;
+    }
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    if (simVirtualMicros)
+        simMicros += us;
+}
+
+void simSetPin(uint8_t pin, int level)
+{
+    if (pin >= simPinCount || simPins[pin].level == level)
+        return;
+    simPins[pin].level = level;
+    if (simPins[pin].handler)
+        simPins[pin].handler(simPins[pin].arg);
+}
+
+// Seeded, so runs repeat exactly
+long random(long limit)
+{
+    return limit > 0 ? (long)(simRandom() % (uint32_t)limit) : 0;
+}
+
+size_t simStrlcat(char *target, const char *source, size_t size)
+{
+    size_t length = strnlen(target, size);
+    size_t sourceLength = strlen(source);
+    if (length < size)
+    {
+        size_t copy = min(sourceLength, size - length - 1);
+        memcpy(target + length, source, copy);
+        target[length + copy] = 0;
+    }
+    return length + sourceLength;
+}
+
+size_t Print::write(const uint8_t *data, size_t size)
+{
+    size_t written = 0;
+    while (size--)
+        written += write(*data++);
+    return written;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0)
+        return 0;
+    if ((size_t)length < sizeof(buffer))
+        return write((const uint8_t *)buffer, length);
+
+    std::vector<char> large(length + 1);
+    va_start(args, format);
+    vsnprintf(large.data(), large.size(), format, args);
+    va_end(args);
+    return write((const uint8_t *)large.data(), length);
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+    int c;
+    while (count < length && (c = read()) >= 0)
+        buffer[count++] = c;
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
+{
+    size_t count = 0;
+    int c;
+    while (count < length && (c = read()) >= 0 && c != terminator)
+        buffer[count++] = c;
+    return count;
+}
+
+String Stream::readStringUntil(char terminator)
+{
+    std::string text;
+    int c;
+    while ((c = read()) >= 0 && c != terminator)
+        text += (char)c;
+    return String(text.c_str());
+}
+
+// Skip to the first digit or minus sign, like the Arduino core
+int Stream::peekNextDigit(boolean decimal)
+{
+    int c;
+    while ((c = peek()) >= 0)
+    {
+        if (c == '-' || (c >= '0' && c <= '9') || (decimal && c == '.'))
+            return c;
+        read();
+    }
+    return c;
+}
+
+long Stream::parseInt()
+{
+    long value = 0;
+    boolean negative = false;
+    int c = peekNextDigit(false);
+    if (c < 0)
+        return 0;
+    do
+    {
+        if (c == '-')
+            negative = true;
+        else
+            value = value * 10 + c - '0';
+        read();
+        c = peek();
+    } while (c >= '0' && c <= '9');
+    return negative ? -value : value;
+}
+
+float Stream::parseFloat()
+{
+    std::string number;
+    int c = peekNextDigit(true);
+    while (c == '-' || c == '.' || (c >= '0' && c <= '9'))
+    {
+        number += (char)c;
+        read();
+        c = peek();
+    }
+    return number.empty() ? 0 : strtof(number.c_str(), nullptr);
+}
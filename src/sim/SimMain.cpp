@@ -0,0 +1,55 @@
+#include <Arduino.h>
+#include "Simulator.h"
+
+/*
+Host simulator of the player screens (see Simulator.h).
+  program [--out DIR] [--golden DIR] [--update] [--tolerance PIXELS] SCRIPT...
+Exits with 1 when a script fails, so it can run as an automated test.
+*/
+
+static int usage()
+{
+    fprintf(stderr, "usage: program [--out DIR] [--golden DIR] [--update] [--tolerance PIXELS] SCRIPT...\n");
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    const char *outputDir = nullptr;
+    const char *goldenDir = nullptr;
+    boolean update = false;
+    uint32_t tolerance = 0;
+    std::vector<const char *> scripts;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outputDir = argv[++i];
+        else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+            goldenDir = argv[++i];
+        else if (strcmp(argv[i], "--update") == 0)
+            update = true;
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+            tolerance = strtoul(argv[++i], nullptr, 10);
+        else if (argv[i][0] == '-')
+            return usage();
+        else
+            scripts.push_back(argv[i]);
+    }
+    if (scripts.empty() || (update && !goldenDir))
+        return usage();
+
+    Simulator simulator;
+    if (!simulator.begin(outputDir, goldenDir, update, tolerance))
+        return 1;
+    boolean passed = true;
+    for (const char *script : scripts)
+    {
+        boolean ok = simulator.run(script);
+        printf("%s: %s\n", script, ok ? "ok" : "FAILED");
+        passed = passed && ok;
+    }
+
+    FilePrint out(stdout);
+    simulator.printReport(out);
+    return passed ? 0 : 1;
+}
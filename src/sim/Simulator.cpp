@@ -0,0 +1,424 @@
+#include <stdarg.h>
+#include "Simulator.h"
+
+// The firmware's values (main.cpp)
+#define simColor 0xFB40
+#define simGlyphs 256
+#define simGlyphBytes 72
+#define simEncoderPinA 41
+#define simEncoderPinB 40
+#define simFrameMillis (1000 / simFramesPerSecond)
+#define simLineBytes 1024
+
+static const char *screenNames[] = {"play", "menu", "devices", "playlists"};
+
+// Gray code order of the encoder states for one direction
+static const uint8_t dialClockwise[4] = {0, 2, 3, 1};
+
+Simulator::Simulator()
+    : _view(&_glyphs, simColor),
+      _encoder(simEncoderPinA, simEncoderPinB),
+      _motion(&_encoder),
+      _screens(&_view, &_spotify, this, &_motion)
+{
+}
+
+Simulator::~Simulator()
+{
+    if (_frames)
+        fclose(_frames);
+}
+
+// Set up the panel and the screens. outputDir receives frames.csv and the
+// snapped PNGs; with updateGolden the snaps replace the golden PNGs instead
+// of being compared. tolerance is the number of pixels that may differ
+boolean Simulator::begin(const char *outputDir, const char *goldenDir, boolean updateGolden, uint32_t tolerance)
+{
+    _outputDir = outputDir;
+    _goldenDir = goldenDir;
+    _updateGolden = updateGolden;
+    _tolerance = tolerance;
+
+    _panel.setColorDepth(16);
+    _golden.setColorDepth(16);
+    if (!_panel.createSprite(viewWidth, viewHeight) || !_golden.createSprite(viewWidth, viewHeight))
+    {
+        log_e("Simulator: failed to allocate the panel");
+        return false;
+    }
+    if (!_glyphs.begin(&fonts::lgfxJapanGothic_20, simGlyphs, simGlyphBytes) || !_view.begin(&_panel, 0))
+        return false;
+    _profiling = _profiler.begin();
+
+    if (_outputDir)
+    {
+        String path = String(_outputDir) + "/frames.csv";
+        _frames = fopen(path.c_str(), "w");
+        if (!_frames)
+        {
+            log_e("Simulator: cannot write %s", path.c_str());
+            return false;
+        }
+        fprintf(_frames, "frame,millis,screen,pixels,micros\n");
+    }
+
+    _encoder.begin(nullptr);
+    _screens.begin();
+    return true;
+}
+
+boolean Simulator::run(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        log_e("Simulator: cannot open %s", path);
+        _failures++;
+        return false;
+    }
+
+    _script = path;
+    _line = 0;
+    uint32_t failures = _failures;
+    boolean ok = true;
+    char line[simLineBytes];
+    while (ok && fgets(line, sizeof(line), file))
+    {
+        _line++;
+        std::vector<String> words;
+        String word;
+        boolean quoted = false;
+        boolean inWord = false;
+        for (const char *c = line; *c && *c != '\n' && *c != '\r'; c++)
+        {
+            if (*c == '"')
+            {
+                quoted = !quoted;
+                inWord = true;
+            }
+            else if (!quoted && *c == '#')
+            {
+                break;
+            }
+            else if (!quoted && (*c == ' ' || *c == '\t'))
+            {
+                if (inWord)
+                    words.push_back(word);
+                word = "";
+                inWord = false;
+            }
+            else
+            {
+                word += *c;
+                inWord = true;
+            }
+        }
+        if (inWord)
+            words.push_back(word);
+        if (!words.empty())
+            ok = command(words);
+    }
+    fclose(file);
+    return ok && _failures == failures;
+}
+
+// One script command. Returns false on script errors; failed checks only count
+boolean Simulator::command(std::vector<String> &words)
+{
+    const String &name = words[0];
+    size_t arguments = words.size() - 1;
+
+    if (name == "track" && arguments == 3)
+    {
+        _spotify.addTrack(words[1], words[2], strtoul(words[3].c_str(), nullptr, 16));
+    }
+    else if (name == "device" && (arguments == 1 || (arguments == 2 && words[2] == "novolume")))
+    {
+        _spotify.addDevice(words[1], arguments == 1);
+    }
+    else if (name == "playlist" && arguments == 2)
+    {
+        _spotify.addPlaylist(words[1], words[2].toInt());
+    }
+    else if (name == "playing" && arguments == 1)
+    {
+        _spotify.setPlaying(words[1].toInt() != 0);
+    }
+    else if (name == "refresh" && arguments == 0)
+    {
+        settle();
+        if (_screens.screen() == PlayerScreenPlay)
+            _screens.showPlay(false);
+    }
+    else if (name == "dial" && (arguments == 1 || arguments == 2))
+    {
+        dial(words[1].toInt(), arguments == 2 ? words[2].toInt() : simDetentMillis);
+    }
+    else if (name == "button" && arguments == 0)
+    {
+        pressButton();
+    }
+    else if (name == "touch" && arguments == 2)
+    {
+        touch(words[1].toInt(), words[2].toInt());
+    }
+    else if (name == "wait" && arguments == 1)
+    {
+        wait(words[1].toInt());
+    }
+    else if (name == "snap" && arguments == 1)
+    {
+        snapshot(words[1]);
+    }
+    else if (name == "pixels" && arguments == 1)
+    {
+        uint64_t limit = words[1].toInt();
+        if (_checkPixels > limit)
+            fail("%llu pixels pushed, expected at most %llu", (unsigned long long)_checkPixels, (unsigned long long)limit);
+        _checkPixels = 0;
+    }
+    else if (name == "screen" && arguments == 1)
+    {
+        settle();
+        if (words[1] != screenNames[_screens.screen()])
+            fail("screen is %s, expected %s", screenNames[_screens.screen()], words[1].c_str());
+    }
+    else
+    {
+        fail("unknown command or wrong arguments: %s", name.c_str());
+        return false;
+    }
+    return true;
+}
+
+boolean Simulator::fail(const char *format, ...)
+{
+    char message[simLineBytes];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    fprintf(stderr, "%s:%d: %s\n", _script, _line, message);
+    _failures++;
+    return false;
+}
+
+// Quadrature edges on the virtual pins run DialEncoder's interrupt, with
+// a virtual micros() spacing the counts; millis() does not move meanwhile
+void Simulator::dial(int detents, uint32_t detentMillis)
+{
+    settle();
+    int counts = detents * dialCountsPerDetent;
+    int direction = counts > 0 ? 1 : -1;
+    uint32_t interval = detentMillis * 1000 / dialCountsPerDetent;
+    // A new gesture: the previous one ended long ago
+    _dialMicros = max(_dialMicros + 1000000, millis() * 1000);
+    for (int i = 0; i != counts; i += direction)
+    {
+        int index = 0;
+        while (dialClockwise[index] != _dialState)
+            index++;
+        _dialState = dialClockwise[(index + direction + 4) % 4];
+        _dialMicros += interval;
+        setMicros(_dialMicros);
+        simSetPin(simEncoderPinA, _dialState & 1);
+        simSetPin(simEncoderPinB, (_dialState >> 1) & 1);
+    }
+    releaseMicros();
+    _screens.handle();
+}
+
+void Simulator::pressButton()
+{
+    settle();
+    _buttonReleased = true;
+    _screens.handle();
+    _buttonReleased = false;
+}
+
+// Taps outside the play screen's controls do nothing, as on the device
+void Simulator::touch(int32_t x, int32_t y)
+{
+    settle();
+    _tapped = true;
+    _tapX = x;
+    _tapY = y;
+    _screens.handle();
+    _tapped = false;
+}
+
+boolean Simulator::tapped(int32_t &x, int32_t &y)
+{
+    if (!_tapped)
+        return false;
+    _tapped = false;
+    x = _tapX;
+    y = _tapY;
+    return true;
+}
+
+// Frame by frame: due timers first, then the frame if the render task would be awake
+void Simulator::wait(uint32_t millis)
+{
+    uint32_t end = _now + millis;
+    while (_nextFrame <= end)
+    {
+        _now = _nextFrame;
+        setMillis(_now);
+        _nextFrame += simFrameMillis;
+
+        _screens.handle();
+
+        if (_animating || _woken)
+        {
+            _woken = false;
+            frame();
+        }
+    }
+    _now = end;
+    setMillis(_now);
+}
+
+// Input waits while a command settles, like handleScreen() does
+void Simulator::settle()
+{
+    while (_screens.settling())
+        wait(simFrameMillis);
+}
+
+// One pass of RenderLoop::renderLoop()
+void Simulator::frame()
+{
+    uint32_t start = micros();
+    if (_active)
+    {
+        uint32_t tickStart = micros();
+        _active->tick(millis());
+        uint32_t tickMicros = micros() - tickStart;
+        if (_active->isDirty())
+        {
+            _profiler.beginFrame(_active);
+            _profiler.ticked(tickMicros);
+            uint32_t pixels = _active->render();
+            uint32_t elapsed = micros() - start;
+            _profiler.endFrame(elapsed, pixels, false);
+
+            _frameCount++;
+            _totalPixels += pixels;
+            _checkPixels += pixels;
+            _totalMicros += elapsed;
+            _maxMicros = max(_maxMicros, elapsed);
+            if (_frames)
+            {
+                fprintf(_frames, "%u,%u,%s,%u,%u\n", _frameCount, _now,
+                        _active == _view.playScreen() ? "play" : "list", pixels, elapsed);
+            }
+        }
+    }
+    _animating = _active && (_active->animating() || _active->isDirty());
+}
+
+void Simulator::setActiveScreen(Compositor *screen)
+{
+    _active = screen;
+    if (screen)
+    {
+        screen->invalidateAll();
+        screen->setProfiler(_profiling ? &_profiler : nullptr);
+    }
+    _woken = true;
+}
+
+// The panel outside the render task, like main.cpp draws it
+void Simulator::showLoading(const char *message)
+{
+    setActiveScreen(nullptr);
+    _panel.fillScreen(0);
+    _glyphs.drawString(&_panel, message, viewWidth / 2, viewHeight / 2, middle_center, simColor);
+}
+
+void Simulator::loadArt(const char *imageURL)
+{
+    uint32_t color;
+    _view.art()->fillScreen(MockSpotify::artColor(imageURL, color) ? color : 0);
+    _view.artChanged();
+}
+
+// Write the panel as PNG, then compare it with the golden PNG or replace that
+boolean Simulator::snapshot(const String &name)
+{
+    settle();
+    _snapshots++;
+    size_t size = 0;
+    void *png = _panel.createPng(&size);
+    if (!png)
+        return fail("snap %s: PNG encoding failed", name.c_str());
+
+    String file = name + ".png";
+    boolean ok = true;
+    if (_outputDir)
+        ok = writeFile(String(_outputDir) + "/" + file, png, size);
+    if (!_goldenDir)
+    {
+        free(png);
+        return ok;
+    }
+    String goldenPath = String(_goldenDir) + "/" + file;
+    if (_updateGolden)
+    {
+        ok = writeFile(goldenPath, png, size) && ok;
+        free(png);
+        return ok;
+    }
+    free(png);
+
+    // Goldens come from a build against M5GFX and are reviewed by hand: a
+    // frame without one is reported, not failed
+    FILE *golden = fopen(goldenPath.c_str(), "rb");
+    if (!golden)
+    {
+        fprintf(stderr, "%s:%d: snap %s: skipped, no golden frame %s (create it with --update and review it)\n",
+                _script, _line, name.c_str(), goldenPath.c_str());
+        _unchecked++;
+        return ok;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), golden)) > 0)
+        data.insert(data.end(), buffer, buffer + read);
+    fclose(golden);
+
+    _golden.fillScreen(0);
+    if (!_golden.drawPng(data.data(), data.size()))
+        return fail("snap %s: cannot decode %s", name.c_str(), goldenPath.c_str());
+
+    const uint16_t *actual = (const uint16_t *)_panel.getBuffer();
+    const uint16_t *expected = (const uint16_t *)_golden.getBuffer();
+    uint32_t differing = 0;
+    for (int i = 0; i < viewWidth * viewHeight; i++)
+        differing += actual[i] != expected[i];
+    if (differing > _tolerance)
+        return fail("snap %s: %u pixels differ from %s", name.c_str(), differing, goldenPath.c_str());
+    return ok;
+}
+
+boolean Simulator::writeFile(const String &path, const void *data, size_t size)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    boolean ok = file && fwrite(data, 1, size, file) == size;
+    if (file)
+        fclose(file);
+    if (!ok)
+        return fail("cannot write %s", path.c_str());
+    return true;
+}
+
+// Totals over all scripts, then the per-widget profile
+void Simulator::printReport(Print &out)
+{
+    out.printf("%u frames, %llu pixels pushed, host render avg %u us, max %u us\n", _frameCount,
+               (unsigned long long)_totalPixels, _frameCount ? (uint32_t)(_totalMicros / _frameCount) : 0, _maxMicros);
+    out.printf("%u snapshots, %u without a golden frame, %u failures\n", _snapshots, _unchecked, _failures);
+    _profiler.print(out);
+}
@@ -0,0 +1,131 @@
+#ifndef SIMULATOR_H_INCLUDE
+#define SIMULATOR_H_INCLUDE
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include "GlyphCache.h"
+#include "PlayerView.h"
+#include "PlayerScreens.h"
+#include "DialEncoder.h"
+#include "RenderProfiler.h"
+#include "MockSpotify.h"
+
+/*
+Simulator runs the player screens on the host. PlayerView renders into an
+off-screen viewWidth x viewHeight sprite that stands in for the panel, and
+a virtual clock (millis()) advances in render task frames. The screen
+logic is the firmware's own PlayerScreens, with MockSpotify as its
+service and the simulator as its host: scripted button and touch input
+is handed to PlayerScreens::handle(), and the dial turns a real
+DialEncoder through virtual pins, so DialMotion and its curves run too.
+Frames are rendered like RenderLoop does: ticked every frame while
+something animates, otherwise only after a change. Each rendered frame is
+timed on the host, counted in pixels pushed and recorded in a
+RenderProfiler. snap writes the panel as PNG and compares it with a golden
+PNG of the same name. A snap without a golden PNG is skipped with a
+notice and counted in the report; the screen and pixel checks still run.
+
+Script, one command per line, # starts a comment, "quotes" group words:
+  track "name" "artist" rrggbb   add a track to the queue (art color)
+  device "name" [novolume]       add a device
+  playlist "name" tracks         add a playlist
+  playing 0|1                    change the playback state on the server side
+  refresh                        fetch the playback state, like the auto refresh
+  dial detents [ms]              turn the dial (negative: left), ms per detent (default 250)
+  button                         press and release the button
+  touch x y                      tap the panel
+  wait ms                        advance the clock
+  snap name                      compare the panel with golden/name.png
+  pixels max                     pixels pushed since the last check must not exceed max
+  screen play|menu|devices|playlists  expect this screen
+*/
+
+#define simFramesPerSecond 30
+#define simDetentMillis 250  // slow enough for gain 1 on every curve
+
+class Simulator : public PlayerHost
+{
+public:
+  Simulator();
+  ~Simulator();
+  boolean begin(const char *outputDir, const char *goldenDir, boolean updateGolden, uint32_t tolerance);
+
+  // Run a script. Returns false if a check failed or the script has an error
+  boolean run(const char *path);
+  void printReport(Print &out);
+  uint32_t failures() { return _failures; }
+
+  // PlayerHost
+  boolean buttonReleased() override { return _buttonReleased; }
+  boolean buttonLongReleased() override { return false; }
+  boolean tapped(int32_t &x, int32_t &y) override;
+  void unlock() override { _woken = true; }
+  Compositor *activeScreen() override { return _active; }
+  void setActiveScreen(Compositor *screen) override;
+  void showLoading(const char *message) override;
+  void loadArt(const char *imageURL) override;
+
+private:
+  boolean command(std::vector<String> &words);
+  boolean fail(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+  // Input, handed to PlayerScreens once the last command settled
+  void dial(int detents, uint32_t detentMillis);
+  void pressButton();
+  void touch(int32_t x, int32_t y);
+
+  // Time: advance the clock frame by frame, running due timers and rendering
+  void wait(uint32_t millis);
+  void settle();
+  void frame();
+
+  // Checks
+  boolean snapshot(const String &name);
+  boolean writeFile(const String &path, const void *data, size_t size);
+
+  LGFX_Sprite _panel;
+  LGFX_Sprite _golden;
+  GlyphCache _glyphs;
+  PlayerView _view;
+  RenderProfiler _profiler;
+  boolean _profiling = false;
+  MockSpotify _spotify;
+  DialEncoder _encoder;
+  DialMotion _motion;
+  PlayerScreens _screens;
+
+  // Input for the next handle()
+  boolean _buttonReleased = false;
+  boolean _tapped = false;
+  int32_t _tapX = 0;
+  int32_t _tapY = 0;
+  uint8_t _dialState = 0;     // A in bit 0, B in bit 1
+  uint32_t _dialMicros = 0;   // virtual time of the last count
+
+  // Frame clock, like RenderLoop
+  Compositor *_active = nullptr;
+  uint32_t _now = 0;
+  uint32_t _nextFrame = 0;
+  boolean _animating = false;
+  boolean _woken = false;
+
+  // Statistics
+  FILE *_frames = nullptr;
+  uint32_t _frameCount = 0;
+  uint64_t _totalPixels = 0;
+  uint64_t _totalMicros = 0;
+  uint32_t _maxMicros = 0;
+  uint64_t _checkPixels = 0;
+
+  const char *_outputDir = nullptr;
+  const char *_goldenDir = nullptr;
+  boolean _updateGolden = false;
+  uint32_t _tolerance = 0;
+  uint32_t _failures = 0;
+  uint32_t _snapshots = 0;
+  uint32_t _unchecked = 0;  // snapshots without a golden frame
+  const char *_script = "";
+  int _line = 0;
+};
+
+#endif
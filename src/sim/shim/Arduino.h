@@ -0,0 +1,194 @@
+#ifndef SIM_ARDUINO_H_INCLUDE
+#define SIM_ARDUINO_H_INCLUDE
+
+/*
+The part of the Arduino API that the shared UI modules and the JSON
+parsers use, for the host simulator, the scale suite and the host
+tests. millis() is the simulator's virtual clock, so animations are
+deterministic; micros() is the host clock, used for timing, but
+setMicros() moves it to a virtual one until releaseMicros(). GPIO pins
+are virtual: simSetPin() changes a level and runs the pin's interrupt
+handler, so the encoder decoding runs as on the device. Streams hold
+their data in memory: reads never wait for more.
+heap_caps_malloc() is plain malloc and there is no PSRAM.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::max;
+using std::min;
+
+template <class T>
+T constrain(T value, T low, T high)
+{
+  return value < low ? low : (value > high ? high : value);
+}
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+
+#define log_e(format, ...) fprintf(stderr, "[E] " format "\n", ##__VA_ARGS__)
+#define log_w(format, ...) fprintf(stderr, "[W] " format "\n", ##__VA_ARGS__)
+#define log_i(format, ...) ((void)0)
+#define log_d(format, ...) ((void)0)
+#define log_v(format, ...) ((void)0)
+
+uint32_t millis();
+uint32_t micros();
+void setMillis(uint32_t now);
+void setMicros(uint32_t now);
+void releaseMicros();
+
+#define IRAM_ATTR
+#define INPUT_PULLUP 0x05
+#define CHANGE 0x03
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode);
+void delayMicroseconds(uint32_t us);
+void simSetPin(uint8_t pin, int level);
+long random(long limit);
+
+inline boolean isAlphaNumeric(int c) { return isalnum(c); }
+inline boolean isHexadecimalDigit(int c) { return isxdigit(c); }
+
+// glibc before 2.38 has no strlcat
+size_t simStrlcat(char *target, const char *source, size_t size);
+#define strlcat simStrlcat
+
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+inline void *heap_caps_malloc(size_t size, uint32_t caps) { return malloc(size); }
+
+class String
+{
+public:
+  String(const char *text = "") : _text(text ? text : "") {}
+  explicit String(char c) : _text(1, c) {}
+  explicit String(int value) : _text(std::to_string(value)) {}
+  explicit String(unsigned int value) : _text(std::to_string(value)) {}
+  explicit String(long value) : _text(std::to_string(value)) {}
+  explicit String(unsigned long value) : _text(std::to_string(value)) {}
+
+  const char *c_str() const { return _text.c_str(); }
+  unsigned int length() const { return _text.length(); }
+  boolean isEmpty() const { return _text.empty(); }
+  char operator[](unsigned int index) const { return index < _text.length() ? _text[index] : 0; }
+
+  String &operator+=(const String &other)
+  {
+    _text += other._text;
+    return *this;
+  }
+  String &operator+=(const char *other)
+  {
+    _text += other;
+    return *this;
+  }
+  String &operator+=(char c)
+  {
+    _text += c;
+    return *this;
+  }
+
+  bool operator==(const String &other) const { return _text == other._text; }
+  bool operator==(const char *other) const { return _text == other; }
+  bool operator!=(const String &other) const { return _text != other._text; }
+  bool operator!=(const char *other) const { return _text != other; }
+
+  int indexOf(char c, unsigned int from = 0) const { return find(_text.find(c, from)); }
+  int indexOf(const String &text, unsigned int from = 0) const { return find(_text.find(text._text, from)); }
+  int lastIndexOf(const String &text) const { return find(_text.rfind(text._text)); }
+  void trim()
+  {
+    size_t start = _text.find_first_not_of(" \t\r\n");
+    size_t end = _text.find_last_not_of(" \t\r\n");
+    _text = (start == std::string::npos) ? "" : _text.substr(start, end - start + 1);
+  }
+
+  long toInt() const { return atol(_text.c_str()); }
+  boolean startsWith(const String &prefix) const { return _text.compare(0, prefix.length(), prefix._text) == 0; }
+  String substring(unsigned int from, unsigned int to = UINT32_MAX) const
+  {
+    from = min(from, length());
+    to = max(from, min(to, length()));
+    return String(_text.substr(from, to - from).c_str());
+  }
+
+private:
+  static int find(size_t index) { return index == std::string::npos ? -1 : (int)index; }
+
+  std::string _text;
+};
+
+inline String operator+(const String &left, const String &right)
+{
+  String result = left;
+  result += right;
+  return result;
+}
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *data, size_t size);
+  size_t print(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+  size_t print(const String &text) { return print(text.c_str()); }
+  size_t println(const char *text = "") { return print(text) + print("\n"); }
+  size_t println(const String &text) { return println(text.c_str()); }
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// Print to a stdio stream
+class FilePrint : public Print
+{
+public:
+  FilePrint(FILE *file) : _file(file) {}
+  size_t write(uint8_t c) override { return fputc(c, _file) == EOF ? 0 : 1; }
+  size_t write(const uint8_t *data, size_t size) override { return fwrite(data, 1, size, _file); }
+
+private:
+  FILE *_file;
+};
+
+// Arduino Stream semantics, except that a read finding no data returns at once
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  unsigned long getTimeout() { return _timeout; }
+
+  virtual size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+  size_t readBytesUntil(char terminator, char *buffer, size_t length);
+  String readStringUntil(char terminator);
+  long parseInt();
+  float parseFloat();
+
+protected:
+  int peekNextDigit(boolean decimal);
+
+  unsigned long _timeout = 1000;
+};
+
+#endif
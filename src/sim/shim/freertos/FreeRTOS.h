@@ -0,0 +1,21 @@
+#ifndef SIM_FREERTOS_H_INCLUDE
+#define SIM_FREERTOS_H_INCLUDE
+
+/*
+The simulator runs the UI in one thread: locks always succeed at once and
+critical sections do nothing.
+*/
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+#define portMAX_DELAY 0xFFFFFFFF
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL_SAFE(mux) ((void)(mux))
+#define portEXIT_CRITICAL_SAFE(mux) ((void)(mux))
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef SIM_SEMPHR_H_INCLUDE
+#define SIM_SEMPHR_H_INCLUDE
+
+#include "FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return (SemaphoreHandle_t)1; }
+inline int xSemaphoreTakeRecursive(SemaphoreHandle_t lock, TickType_t wait) { return 1; }
+inline int xSemaphoreGiveRecursive(SemaphoreHandle_t lock) { return 1; }
+
+#endif
@@ -0,0 +1,129 @@
+#include <unity.h>
+#include "DialEncoder.h"
+
+// DialMotion on the host: quadrature edges on virtual pins (sim/shim) drive
+// the real DialEncoder interrupt, with a virtual micros() for the timing
+
+#define testPinA 41
+#define testPinB 40
+
+static DialEncoder encoder(testPinA, testPinB);
+static DialMotion motion(&encoder);
+static uint8_t state = 0;  // A in bit 0, B in bit 1
+static uint32_t now = 0;
+
+// Gray code order of the states for one direction
+static const uint8_t clockwise[4] = {0, 2, 3, 1};
+
+// Turn by counts (negative for counterclockwise), one count every interval
+static void turn(int counts, uint32_t intervalMicros)
+{
+    int direction = counts > 0 ? 1 : -1;
+    for (int i = 0; i != counts; i += direction)
+    {
+        int index = 0;
+        while (clockwise[index] != state)
+            index++;
+        state = clockwise[(index + direction + 4) % 4];
+        now += intervalMicros;
+        setMicros(now);
+        simSetPin(testPinA, state & 1);
+        simSetPin(testPinB, (state >> 1) & 1);
+    }
+}
+
+// A new gesture on a new curve, nothing pending
+static void start(const DialCurve &curve)
+{
+    now += 1000000;
+    setMicros(now);
+    motion.setCurve(curve);
+}
+
+static const DialCurve linear = {dialCountsPerDetent, 0.0f, 0.0f, 1.0f};
+static const DialCurve accelerated = {dialCountsPerDetent, 2.0f, 20.0f, 4.0f};
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_one_step_per_detent()
+{
+    start(linear);
+    turn(3 * dialCountsPerDetent, 100000);
+    TEST_ASSERT_EQUAL(3, motion.take());
+    turn(-dialCountsPerDetent, 100000);
+    TEST_ASSERT_EQUAL(-1, motion.take());
+    TEST_ASSERT_EQUAL(0, motion.take());
+}
+
+// Counts short of a step are kept for the next take()
+void test_partial_detent_carries_over()
+{
+    start(linear);
+    turn(dialCountsPerDetent - 1, 100000);
+    TEST_ASSERT_EQUAL(0, motion.take());
+    turn(1, 100000);
+    TEST_ASSERT_EQUAL(1, motion.take());
+}
+
+// Both directions within one take() net out, no whole step is lost
+void test_mixed_directions_in_one_take()
+{
+    start(linear);
+    turn(3 * dialCountsPerDetent, 100000);
+    turn(-dialCountsPerDetent, 100000);
+    TEST_ASSERT_EQUAL(2, motion.take());
+
+    turn(-2 * dialCountsPerDetent, 100000);
+    turn(5 * dialCountsPerDetent, 100000);
+    turn(-dialCountsPerDetent, 100000);
+    TEST_ASSERT_EQUAL(2, motion.take());
+}
+
+// A fast spin gains steps; reversing drops only the fraction the gain added
+void test_reversal_after_fast_spin_keeps_whole_steps()
+{
+    start(accelerated);
+    turn(8 * dialCountsPerDetent, 2000);
+    turn(-dialCountsPerDetent, 100000);
+    int steps = motion.take();
+    TEST_ASSERT_TRUE(steps > 8 - 1);
+    TEST_ASSERT_TRUE(steps <= (int)(8 * accelerated.maxGain) - 1);
+}
+
+// Slow rotation is never multiplied
+void test_slow_rotation_has_no_gain()
+{
+    start(accelerated);
+    turn(6 * dialCountsPerDetent, 200000);
+    TEST_ASSERT_EQUAL(6, motion.take());
+}
+
+// Counts beyond the event ring still arrive as steps
+void test_ring_overflow_keeps_counts()
+{
+    start(linear);
+    int counts = 3 * dialEncoderEvents;
+    turn(counts, 100000);
+    TEST_ASSERT_TRUE(encoder.overflowCounts() > 0);
+    TEST_ASSERT_EQUAL(counts / dialCountsPerDetent, motion.take());
+}
+
+int main(int argc, char **argv)
+{
+    setMicros(now);
+    encoder.begin(nullptr);
+    UNITY_BEGIN();
+    RUN_TEST(test_one_step_per_detent);
+    RUN_TEST(test_partial_detent_carries_over);
+    RUN_TEST(test_mixed_directions_in_one_take);
+    RUN_TEST(test_reversal_after_fast_spin_keeps_whole_steps);
+    RUN_TEST(test_slow_rotation_has_no_gain);
+    RUN_TEST(test_ring_overflow_keeps_counts);
+    return UNITY_END();
+}
@@ -0,0 +1,381 @@
+#!/usr/bin/env python3
+"""Record and replay the Spotify Web API traffic of the M5Dial client.
+
+record: a plain HTTP proxy for the device. Each request goes on to
+api.spotify.com or accounts.spotify.com (/api/token) over TLS, and the raw
+response, including headers and chunk framing, is appended to the file.
+Tokens are not recorded: token responses keep only a placeholder
+access_token and lose refresh_token, so a replay cannot overwrite the
+refresh token the device stores.
+
+serve: answers requests with the recorded responses, matched by method and
+path (cycling through the recordings of each), over an emulated link:
+--latency-ms before the first byte, --bandwidth-kbps throughout, and
+--chunk-size to re-chunk the bodies (0 keeps the recorded framing).
+
+Point the device at either one from the serial console (console build):
+    api http://<host>:<port>
+    bench spotify
+    api default
+
+File format: the line "SPREPLAY 1", then per exchange a JSON line
+{"method", "path", "status", "bytes", "millis"} followed by that many raw
+response bytes and a newline.
+"""
+
+import argparse
+import json
+import socket
+import socketserver
+import ssl
+import sys
+import threading
+import time
+
+MAGIC = b"SPREPLAY 1\n"
+API_HOST = "api.spotify.com"
+ACCOUNTS_HOST = "accounts.spotify.com"
+TOKEN_PATH = "/api/token"
+SEGMENT_BYTES = 1460  # one TCP segment per write when pacing
+MAX_HEAD_BYTES = 16384
+
+
+class Exchange:
+    def __init__(self, method, path, status, response, millis=0):
+        self.method = method
+        self.path = path
+        self.status = status
+        self.response = response
+        self.millis = millis
+
+
+def read_exchanges(filename):
+    exchanges = []
+    with open(filename, "rb") as f:
+        if f.readline() != MAGIC:
+            raise SystemExit(f"{filename}: not a replay file")
+        while True:
+            line = f.readline()
+            if not line:
+                break
+            meta = json.loads(line)
+            response = f.read(meta["bytes"])
+            if len(response) != meta["bytes"] or f.read(1) != b"\n":
+                raise SystemExit(f"{filename}: truncated exchange {meta['method']} {meta['path']}")
+            exchanges.append(Exchange(meta["method"], meta["path"], meta["status"], response, meta.get("millis", 0)))
+    return exchanges
+
+
+def write_exchange(f, exchange):
+    meta = {
+        "method": exchange.method,
+        "path": exchange.path,
+        "status": exchange.status,
+        "bytes": len(exchange.response),
+        "millis": exchange.millis,
+    }
+    f.write(json.dumps(meta, separators=(",", ":")).encode() + b"\n")
+    f.write(exchange.response + b"\n")
+    f.flush()
+
+
+def read_request(rfile):
+    """Request line, headers (lower-case names) and body, or None at end of connection."""
+    line = rfile.readline(MAX_HEAD_BYTES)
+    while line in (b"\r\n", b"\n"):
+        line = rfile.readline(MAX_HEAD_BYTES)
+    if not line:
+        return None
+    parts = line.decode("latin-1").split()
+    if len(parts) != 3:
+        return None
+    method, path, _ = parts
+    headers = []
+    while True:
+        line = rfile.readline(MAX_HEAD_BYTES)
+        if line in (b"\r\n", b"\n", b""):
+            break
+        name, _, value = line.decode("latin-1").partition(":")
+        headers.append((name.strip(), value.strip()))
+    length = int(header(headers, "content-length") or 0)
+    body = rfile.read(length) if length else b""
+    return method, path, headers, body
+
+
+def header(headers, name):
+    for key, value in headers:
+        if key.lower() == name:
+            return value
+    return None
+
+
+def split_response(response):
+    """Status line and headers as a list, and the raw body."""
+    head, _, body = response.partition(b"\r\n\r\n")
+    lines = head.decode("latin-1").split("\r\n")
+    headers = []
+    for line in lines[1:]:
+        name, _, value = line.partition(":")
+        headers.append((name.strip(), value.strip()))
+    return lines[0], headers, body
+
+
+def join_response(status_line, headers, body):
+    head = "\r\n".join([status_line] + [f"{name}: {value}" for name, value in headers])
+    return head.encode("latin-1") + b"\r\n\r\n" + body
+
+
+def dechunk(body):
+    data = bytearray()
+    offset = 0
+    while True:
+        end = body.index(b"\r\n", offset)
+        size = int(body[offset:end].split(b";")[0], 16)
+        offset = end + 2
+        if size == 0:
+            return bytes(data)
+        data += body[offset:offset + size]
+        offset += size + 2
+
+
+def chunk(data, size):
+    out = bytearray()
+    for offset in range(0, len(data), size):
+        piece = data[offset:offset + size]
+        out += b"%x\r\n" % len(piece) + piece + b"\r\n"
+    return bytes(out + b"0\r\n\r\n")
+
+
+def response_body(headers, body):
+    if (header(headers, "transfer-encoding") or "").lower() == "chunked":
+        return dechunk(body)
+    length = header(headers, "content-length")
+    return body[:int(length)] if length is not None else body
+
+
+def without(headers, *names):
+    return [(key, value) for key, value in headers if key.lower() not in names]
+
+
+def rechunk(response, size):
+    """The response with its body sent in chunks of size bytes"""
+    status_line, headers, body = split_response(response)
+    data = response_body(headers, body)
+    if not data:
+        return response
+    headers = without(headers, "content-length", "transfer-encoding")
+    headers.append(("Transfer-Encoding", "chunked"))
+    return join_response(status_line, headers, chunk(data, size))
+
+
+def redact_tokens(response):
+    """Token response without credentials, in the framing it came in"""
+    status_line, headers, body = split_response(response)
+    data = response_body(headers, body)
+    try:
+        token = json.loads(data)
+    except ValueError:
+        return response
+    if not isinstance(token, dict):
+        return response
+    token.pop("refresh_token", None)
+    if "access_token" in token:
+        token["access_token"] = "replay"
+    data = json.dumps(token, separators=(",", ":")).encode()
+    if (header(headers, "transfer-encoding") or "").lower() == "chunked":
+        return join_response(status_line, headers, chunk(data, len(data)))
+    headers = without(headers, "content-length")
+    headers.append(("Content-Length", str(len(data))))
+    return join_response(status_line, headers, data)
+
+
+def recv_all(sock):
+    data = bytearray()
+    while True:
+        piece = sock.recv(65536)
+        if not piece:
+            return bytes(data)
+        data += piece
+
+
+class RecordHandler(socketserver.StreamRequestHandler):
+    def handle(self):
+        while True:
+            request = read_request(self.rfile)
+            if request is None:
+                return
+            method, path, headers, body = request
+            host = ACCOUNTS_HOST if path.startswith(TOKEN_PATH) else API_HOST
+
+            # One upstream connection per request, read to the end
+            forwarded = without(headers, "host", "connection", "content-length")
+            forwarded += [("Host", host), ("Connection", "close"), ("Content-Length", str(len(body)))]
+            head = f"{method} {path} HTTP/1.1\r\n" + "".join(f"{k}: {v}\r\n" for k, v in forwarded) + "\r\n"
+            start = time.monotonic()
+            try:
+                with socket.create_connection((host, 443), timeout=30) as raw:
+                    with self.server.tls.wrap_socket(raw, server_hostname=host) as upstream:
+                        upstream.sendall(head.encode("latin-1") + body)
+                        response = recv_all(upstream)
+            except OSError as error:
+                print(f"{method} {path}: {error}", file=sys.stderr)
+                self.wfile.write(b"HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\nConnection: close\r\n\r\n")
+                return
+            millis = int((time.monotonic() - start) * 1000)
+
+            # The device gets the response as it came. The recording drops
+            # Connection, so it replays as keep-alive like the API does
+            status_line, response_headers, response_body_bytes = split_response(response)
+            self.wfile.write(response)
+            self.wfile.flush()
+            recorded = join_response(status_line, without(response_headers, "connection"), response_body_bytes)
+            if path.startswith(TOKEN_PATH):
+                recorded = redact_tokens(recorded)
+
+            parts = status_line.split()
+            status = int(parts[1]) if len(parts) > 1 and parts[1].isdigit() else 0
+            with self.server.lock:
+                write_exchange(self.server.file, Exchange(method, path, status, recorded, millis))
+            print(f"{method} {path}: {status}, {len(recorded)} bytes, {millis} ms")
+            if (header(response_headers, "connection") or "").lower() == "close":
+                return
+
+
+class ServeHandler(socketserver.StreamRequestHandler):
+    def handle(self):
+        while True:
+            request = read_request(self.rfile)
+            if request is None:
+                return
+            method, path, _, _ = request
+            exchange = self.server.next_exchange(method, path)
+            if exchange is None:
+                print(f"{method} {path}: not recorded")
+                self.send(b"HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n")
+                continue
+            response = exchange.response
+            if self.server.chunk_size:
+                response = rechunk(response, self.server.chunk_size)
+            start = time.monotonic()
+            self.send(response)
+            millis = int((time.monotonic() - start) * 1000)
+            print(f"{method} {path}: {exchange.status}, {len(response)} bytes, {millis} ms")
+
+    def send(self, data):
+        time.sleep(self.server.latency_ms / 1000)
+        rate = self.server.bandwidth_kbps * 125  # bytes per second
+        if not rate:
+            self.wfile.write(data)
+            self.wfile.flush()
+            return
+        start = time.monotonic()
+        sent = 0
+        for offset in range(0, len(data), SEGMENT_BYTES):
+            piece = data[offset:offset + SEGMENT_BYTES]
+            self.wfile.write(piece)
+            self.wfile.flush()
+            sent += len(piece)
+            delay = start + sent / rate - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+
+
+class ReplayServer(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+    def __init__(self, address, exchanges, args):
+        super().__init__(address, ServeHandler)
+        self.latency_ms = args.latency_ms
+        self.bandwidth_kbps = args.bandwidth_kbps
+        self.chunk_size = args.chunk_size
+        self.lock = threading.Lock()
+        self.exchanges = {}
+        self.next = {}
+        for exchange in exchanges:
+            self.exchanges.setdefault((exchange.method, exchange.path), []).append(exchange)
+
+    # Exact path first, then the same path recorded with another query
+    def next_exchange(self, method, path):
+        key = (method, path)
+        if key not in self.exchanges:
+            base = path.split("?")[0]
+            key = next((k for k in self.exchanges if k[0] == method and k[1].split("?")[0] == base), None)
+            if key is None:
+                return None
+        with self.lock:
+            index = self.next.get(key, 0)
+            self.next[key] = index + 1
+        recorded = self.exchanges[key]
+        return recorded[index % len(recorded)]
+
+
+class RecordServer(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+    def __init__(self, address, file):
+        super().__init__(address, RecordHandler)
+        self.file = file
+        self.lock = threading.Lock()
+        self.tls = ssl.create_default_context()
+
+
+def record(args):
+    with open(args.file, "ab") as f:
+        if f.tell() == 0:
+            f.write(MAGIC)
+        with RecordServer((args.bind, args.port), f) as server:
+            print(f"recording to {args.file}, device: api http://<this host>:{args.port}")
+            server.serve_forever()
+
+
+def serve(args):
+    exchanges = read_exchanges(args.file)
+    with ReplayServer((args.bind, args.port), exchanges, args) as server:
+        print(f"replaying {len(exchanges)} exchanges from {args.file} on port {args.port}, "
+              f"latency {args.latency_ms} ms, bandwidth {args.bandwidth_kbps or 'unlimited'} kbps, "
+              f"chunks {args.chunk_size or 'as recorded'}")
+        server.serve_forever()
+
+
+def show(args):
+    for exchange in read_exchanges(args.file):
+        status_line, headers, _ = split_response(exchange.response)
+        framing = "chunked" if (header(headers, "transfer-encoding") or "").lower() == "chunked" else "length"
+        print(f"{exchange.method} {exchange.path}: {exchange.status}, {len(exchange.response)} bytes, "
+              f"{framing}, {exchange.millis} ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    recording = commands.add_parser("record", help="proxy to Spotify and append the responses to FILE")
+    recording.add_argument("file")
+    recording.add_argument("--bind", default="0.0.0.0")
+    recording.add_argument("--port", type=int, default=8080)
+    recording.set_defaults(run=record)
+
+    serving = commands.add_parser("serve", help="answer with the responses recorded in FILE")
+    serving.add_argument("file")
+    serving.add_argument("--bind", default="0.0.0.0")
+    serving.add_argument("--port", type=int, default=8080)
+    serving.add_argument("--latency-ms", type=int, default=0, help="delay before each response")
+    serving.add_argument("--bandwidth-kbps", type=int, default=0, help="0 for unlimited")
+    serving.add_argument("--chunk-size", type=int, default=0, help="re-chunk bodies, 0 keeps the recorded framing")
+    serving.set_defaults(run=serve)
+
+    showing = commands.add_parser("show", help="list the exchanges in FILE")
+    showing.add_argument("file")
+    showing.set_defaults(run=show)
+
+    args = parser.parse_args()
+    try:
+        args.run(args)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()